@@ -0,0 +1,336 @@
+#include "bl_atlas.hpp"
+#include "bl_image.hpp"
+#include "stb/stb_image.h"
+
+namespace Boundless {
+namespace {
+// 以对齐格子为单位的矩形
+struct AtlasRect {
+    GLsizei x, y, w, h;
+};
+class MaxRectsBin {
+    std::vector<AtlasRect> free_rects;
+
+   public:
+    MaxRectsBin(GLsizei w, GLsizei h) : free_rects{{0, 0, w, h}} {}
+    // 最短边优先: 放入后剩余短边最小者最好, 其次比较剩余长边
+    bool Find(GLsizei w,
+              GLsizei h,
+              AtlasRect* best,
+              GLsizei* short_side,
+              GLsizei* long_side) const {
+        bool found = false;
+        for (const AtlasRect& f : free_rects) {
+            if (f.w < w || f.h < h)
+                continue;
+            GLsizei dw = f.w - w, dh = f.h - h;
+            GLsizei s = std::min(dw, dh), l = std::max(dw, dh);
+            if (!found || s < *short_side ||
+                (s == *short_side && l < *long_side)) {
+                *best = {f.x, f.y, w, h};
+                *short_side = s;
+                *long_side = l;
+                found = true;
+            }
+        }
+        return found;
+    }
+    void Place(const AtlasRect& r) {
+        std::vector<AtlasRect> next;
+        next.reserve(free_rects.size() + 4);
+        for (const AtlasRect& f : free_rects) {
+            if (r.x >= f.x + f.w || r.x + r.w <= f.x || r.y >= f.y + f.h ||
+                r.y + r.h <= f.y) {
+                next.push_back(f);
+                continue;
+            }
+            // 与放入的矩形相交: 拆分为最多4个极大空闲矩形
+            if (r.x > f.x)
+                next.push_back({f.x, f.y, r.x - f.x, f.h});
+            if (r.x + r.w < f.x + f.w)
+                next.push_back({r.x + r.w, f.y, f.x + f.w - r.x - r.w, f.h});
+            if (r.y > f.y)
+                next.push_back({f.x, f.y, f.w, r.y - f.y});
+            if (r.y + r.h < f.y + f.h)
+                next.push_back({f.x, r.y + r.h, f.w, f.y + f.h - r.y - r.h});
+        }
+        // 删除被其他空闲矩形包含的矩形
+        auto contains = [](const AtlasRect& a, const AtlasRect& b) {
+            return b.x >= a.x && b.y >= a.y && b.x + b.w <= a.x + a.w &&
+                   b.y + b.h <= a.y + a.h;
+        };
+        free_rects.clear();
+        for (size_t i = 0; i < next.size(); i++) {
+            bool redundant = false;
+            for (size_t j = 0; j < next.size() && !redundant; j++) {
+                if (i == j || !contains(next[j], next[i]))
+                    continue;
+                // 完全相同的矩形只保留下标最小的一个
+                redundant = !contains(next[i], next[j]) || j < i;
+            }
+            if (!redundant)
+                free_rects.push_back(next[i]);
+        }
+    }
+};
+void WriteAtlasOutput(const std::string& path, Byte* data, size_t size) {
+    std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        MemoryTracker::Free(data);
+        throw std::runtime_error("Cannot open file:" + path);
+    }
+    out.write((char*)data, size);
+    out.close();
+    MemoryTracker::Free(data);
+}
+}  // namespace
+
+TextureAtlas::TextureAtlas() : target(GL_NONE), page_count(0) {}
+const AtlasEntry* TextureAtlas::Find(const std::string& name) const {
+    auto it = entries.find(name);
+    return it == entries.end() ? nullptr : &it->second;
+}
+void TextureAtlas::RemapTexcoords(Byte* texcoords,
+                                  size_t count,
+                                  size_t stride,
+                                  const AtlasEntry& entry) {
+    for (size_t i = 0; i < count; i++) {
+        float* uv = (float*)(texcoords + i * stride);
+        uv[0] = uv[0] * entry.scale_offset[0] + entry.scale_offset[2];
+        uv[1] = uv[1] * entry.scale_offset[1] + entry.scale_offset[3];
+    }
+}
+void TextureAtlas::LoadAtlas(const Byte* data, TextureAtlas& atlas) {
+    if (*(uint64*)data != ATLAS_HEADER) {
+        throw std::runtime_error("Atlas head code error.");
+    }
+    size_t len;
+    Byte* dt = UncompressData(data + sizeof(uint64), &len);
+    const AtlasFile& head = *(const AtlasFile*)dt;
+    uint32 texture_count = head.target == GL_TEXTURE_2D_ARRAY ? 1 : head.page_count;
+    const AtlasFileEntry* file_entries =
+        (const AtlasFileEntry*)(dt + sizeof(AtlasFile) +
+                                sizeof(DataRange) * texture_count);
+    auto to_string = [dt](const DataRange& r) {
+        return std::string((const char*)dt + r.start, r.length);
+    };
+    atlas.target = head.target;
+    atlas.page_count = head.page_count;
+    atlas.textures.clear();
+    for (uint32 i = 0; i < texture_count; i++)
+        atlas.textures.push_back(to_string(head.textures[i]));
+    atlas.entries.clear();
+    atlas.entries.reserve(head.entry_count);
+    for (uint32 i = 0; i < head.entry_count; i++) {
+        const AtlasFileEntry& fe = file_entries[i];
+        AtlasEntry& e = atlas.entries[to_string(fe.name)];
+        e.layer = fe.layer;
+        e.width = fe.width;
+        e.height = fe.height;
+        std::copy(fe.scale_offset, fe.scale_offset + 4, e.scale_offset);
+    }
+    MemoryTracker::Free(dt);
+}
+void TextureAtlas::LoadAtlas(const std::string& path, TextureAtlas& atlas) {
+    std::ifstream fin(path, std::ios_base::in | std::ios_base::binary);
+    if (!fin.is_open()) {
+        throw std::runtime_error("Cannot open file:" + path);
+    }
+    fin.seekg(0, std::ios::end);
+    size_t length = fin.tellg();
+    fin.seekg(0, std::ios::beg);
+    Byte* data = (Byte*)MemoryTracker::Allocate(length, MemoryTag::Texture);
+    if (data == nullptr) {
+        throw std::bad_alloc();
+    }
+    fin.read((char*)data, length);
+    fin.close();
+    try {
+        LoadAtlas(data, atlas);
+    } catch (...) {
+        MemoryTracker::Free(data);
+        throw;
+    }
+    MemoryTracker::Free(data);
+}
+void TextureAtlas::GenAtlasFile(const std::vector<std::string>& paths,
+                                const std::string& save_path,
+                                const AtlasCookArg& arg) {
+    const int n = arg.channels;
+    if (n < 1 || n > 4) {
+        throw std::runtime_error("图像通道数错误");
+    }
+    const bool srgb = arg.texture.srgb && n >= 3;
+    const GLsizei levels = std::max<GLsizei>(arg.mip_levels, 1);
+    GLsizei align = 1 << (levels - 1);
+    if (arg.texture.compression != TextureCompression::NONE)
+        align *= 4;
+    const GLsizei padding = arg.padding > 0 ? arg.padding : 1 << (levels - 1);
+    const GLsizei page_cells = arg.page_size / align;
+    const GLsizei page_dim = page_cells * align;
+    if (page_cells < 1) {
+        throw std::runtime_error("图集页面小于对齐粒度");
+    }
+
+    std::vector<ImageF> images(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        int w, h, c;
+        Byte* pixels = (Byte*)stbi_load(paths[i].c_str(), &w, &h, &c, n);
+        if (pixels == nullptr) {
+            throw std::runtime_error("STB_IMAGE:无法加载图像:" + paths[i]);
+        }
+        images[i] = ImageFromBytes(pixels, w, h, n, srgb);
+        stbi_image_free(pixels);
+    }
+    std::vector<std::pair<GLsizei, GLsizei>> sizes(paths.size());
+    for (size_t i = 0; i < paths.size(); i++)
+        sizes[i] = {images[i].width, images[i].height};
+
+    // 大图像先放, 装箱效果更好
+    std::vector<uint32> order(paths.size());
+    for (uint32 i = 0; i < order.size(); i++)
+        order[i] = i;
+    auto cells = [&](GLsizei size) { return (size + 2 * padding + align - 1) / align; };
+    std::stable_sort(order.begin(), order.end(), [&](uint32 a, uint32 b) {
+        GLsizei ma = std::max(images[a].width, images[a].height);
+        GLsizei mb = std::max(images[b].width, images[b].height);
+        if (ma != mb)
+            return ma > mb;
+        return images[a].width * images[a].height >
+               images[b].width * images[b].height;
+    });
+    std::vector<MaxRectsBin> bins;
+    std::vector<AtlasRect> placed(paths.size());
+    std::vector<uint32> page_of(paths.size());
+    for (uint32 i : order) {
+        GLsizei cw = cells(images[i].width), ch = cells(images[i].height);
+        if (cw > page_cells || ch > page_cells) {
+            throw std::runtime_error("图像大于图集页面:" + paths[i]);
+        }
+        bool found = false;
+        GLsizei best_short = 0, best_long = 0;
+        for (uint32 p = 0; p < bins.size(); p++) {
+            AtlasRect r;
+            GLsizei s, l;
+            if (bins[p].Find(cw, ch, &r, &s, &l) &&
+                (!found || s < best_short || (s == best_short && l < best_long))) {
+                found = true;
+                best_short = s;
+                best_long = l;
+                placed[i] = r;
+                page_of[i] = p;
+            }
+        }
+        if (!found) {
+            bins.emplace_back(page_cells, page_cells);
+            bins.back().Find(cw, ch, &placed[i], &best_short, &best_long);
+            page_of[i] = static_cast<uint32>(bins.size() - 1);
+        }
+        bins[page_of[i]].Place(placed[i]);
+    }
+    const uint32 page_count = static_cast<uint32>(bins.size());
+
+    // 生成页面: 整个格子都以图像像素(边缘钳制)填充, 低层级mip不会混入其他图像
+    std::vector<std::vector<ImageF>> layers(page_count);
+    std::vector<ImageF> pages(page_count);
+    for (ImageF& page : pages) {
+        page.width = page.height = page_dim;
+        page.pixels.assign(static_cast<size_t>(page_dim) * page_dim * 4, 0.0f);
+    }
+#pragma omp parallel for schedule(dynamic, 8)
+    for (int64_t k = 0; k < static_cast<int64_t>(images.size()); k++) {
+        const ImageF& src = images[k];
+        const AtlasRect& r = placed[k];
+        ImageF& page = pages[page_of[k]];
+        GLsizei x0 = r.x * align, y0 = r.y * align;
+        for (GLsizei y = 0; y < r.h * align; y++) {
+            GLsizei sy = std::clamp<GLsizei>(y - padding, 0, src.height - 1);
+            float* dst = &page.pixels[(static_cast<size_t>(y0 + y) * page_dim + x0) * 4];
+            const float* row = &src.pixels[static_cast<size_t>(sy) * src.width * 4];
+            for (GLsizei x = 0; x < r.w * align; x++) {
+                GLsizei sx = std::clamp<GLsizei>(x - padding, 0, src.width - 1);
+                std::copy(row + sx * 4, row + sx * 4 + 4, dst + x * 4);
+            }
+        }
+    }
+    for (uint32 p = 0; p < page_count; p++) {
+        layers[p] = GenMipChain(std::move(pages[p]), arg.texture.mip_filter, levels);
+    }
+    images.clear();
+
+    // 输出纹理
+    std::vector<std::string> texture_paths;
+    if (arg.array) {
+        size_t size;
+        // 只有一页时也输出纹理数组, 与.atlas文件记录的target一致
+        Byte* data = Texture::GenTextureData(&size, layers, n, arg.texture,
+                                             TextureHDRFormat::NONE,
+                                             GL_TEXTURE_2D_ARRAY);
+        texture_paths.push_back(save_path + ".texture");
+        WriteAtlasOutput(texture_paths.back(), data, size);
+    } else {
+        for (uint32 p = 0; p < page_count; p++) {
+            std::vector<std::vector<ImageF>> single(1);
+            single[0] = std::move(layers[p]);
+            size_t size;
+            Byte* data = Texture::GenTextureData(&size, single, n, arg.texture,
+                                                 TextureHDRFormat::NONE,
+                                                 GL_TEXTURE_2D);
+            texture_paths.push_back(save_path + "." + std::to_string(p) + ".texture");
+            WriteAtlasOutput(texture_paths.back(), data, size);
+        }
+    }
+
+    // 输出重映射表
+    size_t string_size = 0;
+    for (const std::string& s : texture_paths)
+        string_size += s.size();
+    for (const std::string& s : paths)
+        string_size += s.size();
+    size_t head_size = sizeof(AtlasFile) + sizeof(DataRange) * texture_paths.size() +
+                       sizeof(AtlasFileEntry) * paths.size();
+    size_t size = head_size + string_size;
+    Byte* data = (Byte*)MemoryTracker::Allocate(size, MemoryTag::Texture);
+    if (data == nullptr) {
+        throw std::bad_alloc();
+    }
+    AtlasFile& head = *(AtlasFile*)data;
+    head.entry_count = static_cast<uint32>(paths.size());
+    head.page_count = page_count;
+    head.page_width = head.page_height = page_dim;
+    head.target = arg.array ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+    head.reserved = 0;
+    size_t cur = head_size;
+    auto put_string = [&](const std::string& s) {
+        std::memcpy(data + cur, s.data(), s.size());
+        DataRange r{cur, s.size()};
+        cur += s.size();
+        return r;
+    };
+    for (size_t i = 0; i < texture_paths.size(); i++)
+        head.textures[i] = put_string(texture_paths[i]);
+    AtlasFileEntry* file_entries =
+        (AtlasFileEntry*)(data + sizeof(AtlasFile) +
+                          sizeof(DataRange) * texture_paths.size());
+    const float inv = 1.0f / page_dim;
+    for (size_t i = 0; i < paths.size(); i++) {
+        AtlasFileEntry& e = file_entries[i];
+        e.name = put_string(paths[i]);
+        e.layer = page_of[i];
+        e.width = sizes[i].first;
+        e.height = sizes[i].second;
+        e.scale_offset[0] = e.width * inv;
+        e.scale_offset[1] = e.height * inv;
+        e.scale_offset[2] = (placed[i].x * align + padding) * inv;
+        e.scale_offset[3] = (placed[i].y * align + padding) * inv;
+    }
+    std::cout << "Atlas:\t" << save_path << '\n';
+    std::cout << "Images:\t" << paths.size() << '\n';
+    std::cout << "Pages:\t" << page_count << " (" << page_dim << "x" << page_dim
+              << ")\n";
+    Byte* compress = CompressData(data, &size, sizeof(uint64));
+    MemoryTracker::Free(data);
+    *(uint64*)compress = ATLAS_HEADER;
+    WriteAtlasOutput(save_path + ".atlas", compress, size);
+}
+}  // namespace Boundless
@@ -0,0 +1,79 @@
+#ifndef _BOUNDLESS_ATLAS_HPP_FILE_
+#define _BOUNDLESS_ATLAS_HPP_FILE_
+#include "bl_resource.hpp"
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 纹理图集/纹理数组打包(烘焙用)
+//
+// 以MaxRects(最短边优先)把大量小图像装箱到固定尺寸的页面, 不旋转图像.
+// 每个图像四周留出padding像素的边缘, 以复制边缘像素填充; 图像占用的格子
+// 对齐到2^(mip_levels-1)(块压缩时再乘4), 使每一级mip的盒式滤波与压缩块都不会
+// 跨越两个图像, 第k级仍保留padding/2^k个纹素的边缘供双线性采样.
+// KAISER滤波的核宽超出对齐格子, 会在图像边缘产生少量渗色, 图集建议使用BOX.
+// 页面作为GL_TEXTURE_2D_ARRAY的切片输出(array为真), 或每页一个GL_TEXTURE_2D.
+// 同时输出UV重映射表: uv' = uv * scale + offset, layer为数组切片/页面序号.
+// 重映射后的uv只能位于[0,1], 需要重复寻址的纹理不适合放入图集.
+//
+struct AtlasFileEntry {
+    DataRange name;           // 名称字符串(相对解压数据起始)
+    uint32 layer;             // 数组切片/页面序号
+    GLsizei width, height;    // 原图像尺寸
+    float scale_offset[4];    // scale.xy, offset.xy
+};
+struct AtlasFile {
+    uint32 entry_count, page_count;
+    GLsizei page_width, page_height;
+    GLenum target;            // GL_TEXTURE_2D_ARRAY或GL_TEXTURE_2D
+    uint32 reserved;
+    DataRange textures[];     // [page_count]纹理文件路径(数组时只有1个)
+    // 之后依次为AtlasFileEntry[entry_count], 字符串数据
+};
+const size_t ATLAS_HEADER = 0xF247260393FF0007;  // 图集重映射表文件头代码
+
+struct AtlasCookArg {
+    GLsizei page_size = 2048;  // 页面边长
+    GLsizei padding = 0;       // 图像四周的边缘像素, 0表示2^(mip_levels-1)
+    GLsizei mip_levels = 5;    // 图集的mipmap层数(决定对齐粒度)
+    int channels = 4;          // 输出通道数, 源图像会转换为该通道数
+    bool array = true;         // 输出为一个纹理数组, 否则每页一个2D纹理
+    TextureCookArg texture;    // 纹理格式参数, 其中mip_levels被忽略
+};
+struct AtlasEntry {
+    uint32 layer;
+    GLsizei width, height;
+    float scale_offset[4];
+};
+
+class TextureAtlas {
+    std::unordered_map<std::string, AtlasEntry> entries;
+    std::vector<std::string> textures;
+    GLenum target;
+    uint32 page_count;
+
+   public:
+    TextureAtlas();
+
+    // 查找图像(打包时的源路径), 不存在返回nullptr
+    const AtlasEntry* Find(const std::string& name) const;
+    // 纹理文件路径, 数组时只有一个
+    const std::vector<std::string>& GetTextures() const { return textures; }
+    GLenum GetTarget() const { return target; }
+    uint32 GetPageCount() const { return page_count; }
+    size_t GetEntryCount() const { return entries.size(); }
+
+    // 对交错存放的顶点数据原地重映射纹理坐标
+    // texcoords: 第一个顶点的uv(2个float), 相邻顶点间隔stride字节
+    static void RemapTexcoords(Byte* texcoords,
+                               size_t count,
+                               size_t stride,
+                               const AtlasEntry& entry);
+    static void LoadAtlas(const Byte* data, TextureAtlas& atlas);
+    static void LoadAtlas(const std::string& path, TextureAtlas& atlas);
+    // 打包图像并输出save_path.texture(或save_path.<页>.texture)与save_path.atlas
+    static void GenAtlasFile(const std::vector<std::string>& paths,
+                             const std::string& save_path,
+                             const AtlasCookArg& arg = {});
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_ATLAS_HPP_FILE_
@@ -0,0 +1,404 @@
+#include "bl_bcn.hpp"
+
+#include <cfloat>
+#include <cstring>
+
+namespace Boundless {
+namespace {
+// 4x4块, 每个像素RGBA, 取值[0,255]
+struct ColorBlock {
+    float c[16][4];
+};
+void FetchBlock(const Byte* pixels,
+                GLsizei width,
+                GLsizei height,
+                int channels,
+                GLsizei bx,
+                GLsizei by,
+                ColorBlock& block) {
+    for (int i = 0; i < 16; i++) {
+        GLsizei x = std::min(bx * 4 + (i & 3), width - 1);
+        GLsizei y = std::min(by * 4 + (i >> 2), height - 1);
+        const Byte* p = pixels + (static_cast<size_t>(y) * width + x) * channels;
+        block.c[i][0] = block.c[i][1] = block.c[i][2] = 0.0f;
+        block.c[i][3] = 255.0f;
+        for (int c = 0; c < channels; c++)
+            block.c[i][c] = p[c];
+    }
+}
+// 前comps个分量的均值与主轴(幂迭代)
+void PrincipalAxis(const ColorBlock& b, int comps, float mean[4], float axis[4]) {
+    for (int c = 0; c < comps; c++) {
+        mean[c] = 0.0f;
+        for (int i = 0; i < 16; i++)
+            mean[c] += b.c[i][c];
+        mean[c] /= 16.0f;
+    }
+    float cov[4][4] = {};
+    for (int i = 0; i < 16; i++) {
+        for (int r = 0; r < comps; r++) {
+            for (int c = 0; c < comps; c++) {
+                cov[r][c] += (b.c[i][r] - mean[r]) * (b.c[i][c] - mean[c]);
+            }
+        }
+    }
+    for (int c = 0; c < comps; c++)
+        axis[c] = 1.0f;
+    for (int iter = 0; iter < 8; iter++) {
+        float next[4] = {}, len = 0.0f;
+        for (int r = 0; r < comps; r++) {
+            for (int c = 0; c < comps; c++)
+                next[r] += cov[r][c] * axis[c];
+            len = std::max(len, std::abs(next[r]));
+        }
+        if (len <= 0.0f)
+            return;  // 纯色块, 保持原方向
+        for (int c = 0; c < comps; c++)
+            axis[c] = next[c] / len;
+    }
+}
+// 主轴上投影的两端
+void AxisEndpoints(const ColorBlock& b, int comps, float e0[4], float e1[4]) {
+    float mean[4], axis[4];
+    PrincipalAxis(b, comps, mean, axis);
+    float tmin = FLT_MAX, tmax = -FLT_MAX;
+    for (int i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < comps; c++)
+            t += (b.c[i][c] - mean[c]) * axis[c];
+        tmin = std::min(tmin, t);
+        tmax = std::max(tmax, t);
+    }
+    for (int c = 0; c < comps; c++) {
+        e0[c] = std::clamp(mean[c] + axis[c] * tmax, 0.0f, 255.0f);
+        e1[c] = std::clamp(mean[c] + axis[c] * tmin, 0.0f, 255.0f);
+    }
+}
+// 已知每个像素的插值权重w(像素 = (1-w)*e0 + w*e1), 最小二乘求端点
+bool LeastSquaresEndpoints(const ColorBlock& b,
+                           int comps,
+                           const float w[16],
+                           float e0[4],
+                           float e1[4]) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f, ax[4] = {}, bx[4] = {};
+    for (int i = 0; i < 16; i++) {
+        float a = 1.0f - w[i];
+        aa += a * a;
+        ab += a * w[i];
+        bb += w[i] * w[i];
+        for (int c = 0; c < comps; c++) {
+            ax[c] += a * b.c[i][c];
+            bx[c] += w[i] * b.c[i][c];
+        }
+    }
+    float det = aa * bb - ab * ab;
+    if (std::abs(det) < 1e-6f)
+        return false;
+    for (int c = 0; c < comps; c++) {
+        e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+        e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+///////////////////////////////////////////////
+// BC1
+//
+inline uint16 Pack565(const float c[3]) {
+    uint32 r = static_cast<uint32>(c[0] * 31.0f / 255.0f + 0.5f);
+    uint32 g = static_cast<uint32>(c[1] * 63.0f / 255.0f + 0.5f);
+    uint32 b = static_cast<uint32>(c[2] * 31.0f / 255.0f + 0.5f);
+    return static_cast<uint16>(r << 11 | g << 5 | b);
+}
+inline void Unpack565(uint16 v, float c[3]) {
+    uint32 r = v >> 11, g = (v >> 5) & 63, b = v & 31;
+    c[0] = static_cast<float>(r << 3 | r >> 2);
+    c[1] = static_cast<float>(g << 2 | g >> 4);
+    c[2] = static_cast<float>(b << 3 | b >> 2);
+}
+struct BC1Result {
+    uint16 c0, c1;
+    Byte index[16];
+    float error;
+};
+// 4色模式: 0->c0, 1->c1, 2->(2c0+c1)/3, 3->(c0+2c1)/3
+const float bc1_weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+BC1Result FitBC1(const ColorBlock& b, const float e0[3], const float e1[3]) {
+    BC1Result res;
+    res.c0 = Pack565(e0);
+    res.c1 = Pack565(e1);
+    if (res.c0 < res.c1)
+        std::swap(res.c0, res.c1);
+    float pal[4][3];
+    Unpack565(res.c0, pal[0]);
+    Unpack565(res.c1, pal[1]);
+    int count = res.c0 == res.c1 ? 1 : 4;
+    for (int c = 0; c < 3; c++) {
+        pal[2][c] = (2.0f * pal[0][c] + pal[1][c]) / 3.0f;
+        pal[3][c] = (pal[0][c] + 2.0f * pal[1][c]) / 3.0f;
+    }
+    res.error = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float best = FLT_MAX;
+        for (int k = 0; k < count; k++) {
+            float d = 0.0f;
+            for (int c = 0; c < 3; c++) {
+                float t = b.c[i][c] - pal[k][c];
+                d += t * t;
+            }
+            if (d < best) {
+                best = d;
+                res.index[i] = static_cast<Byte>(k);
+            }
+        }
+        res.error += best;
+    }
+    return res;
+}
+void EncodeBC1(const ColorBlock& b, Byte* out) {
+    float e0[4], e1[4];
+    AxisEndpoints(b, 3, e0, e1);
+    BC1Result best = FitBC1(b, e0, e1);
+    for (int iter = 0; iter < 2 && best.error > 0.0f; iter++) {
+        float w[16];
+        for (int i = 0; i < 16; i++)
+            w[i] = bc1_weights[best.index[i]];
+        float c0[4], c1[4];
+        Unpack565(best.c0, c0);
+        Unpack565(best.c1, c1);
+        if (best.c0 == best.c1 || !LeastSquaresEndpoints(b, 3, w, c0, c1))
+            break;
+        BC1Result next = FitBC1(b, c0, c1);
+        if (next.error >= best.error)
+            break;
+        best = next;
+    }
+    uint32 bits = 0;
+    for (int i = 0; i < 16; i++)
+        bits |= static_cast<uint32>(best.index[i]) << (i * 2);
+    std::memcpy(out, &best.c0, 2);
+    std::memcpy(out + 2, &best.c1, 2);
+    std::memcpy(out + 4, &bits, 4);
+}
+
+///////////////////////////////////////////////
+// BC4(BC3的alpha块, BC5的两个通道)
+//
+void EncodeBC4(const ColorBlock& b, int channel, Byte* out) {
+    float lo = 255.0f, hi = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        lo = std::min(lo, b.c[i][channel]);
+        hi = std::max(hi, b.c[i][channel]);
+    }
+    int a0 = static_cast<int>(hi + 0.5f), a1 = static_cast<int>(lo + 0.5f);
+    out[0] = static_cast<Byte>(a0);
+    out[1] = static_cast<Byte>(a1);
+    uint64 bits = 0;
+    if (a0 != a1) {
+        // 8值模式(a0 > a1): 代码2..7为((8-k)*a0 + (k-1)*a1)/7
+        float pal[8];
+        pal[0] = static_cast<float>(a0);
+        pal[1] = static_cast<float>(a1);
+        for (int k = 2; k < 8; k++)
+            pal[k] = ((8 - k) * a0 + (k - 1) * a1) / 7.0f;
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            float err = FLT_MAX;
+            for (int k = 0; k < 8; k++) {
+                float d = std::abs(b.c[i][channel] - pal[k]);
+                if (d < err) {
+                    err = d;
+                    best = k;
+                }
+            }
+            bits |= static_cast<uint64>(best) << (i * 3);
+        }
+    }
+    for (int k = 0; k < 6; k++)
+        out[2 + k] = static_cast<Byte>(bits >> (k * 8));
+}
+
+///////////////////////////////////////////////
+// BC7 模式6
+//
+const int bc7_weights[16] = {0,  4,  9,  13, 17, 21, 26, 30,
+                             34, 38, 43, 47, 51, 55, 60, 64};
+struct BC7Result {
+    int q[2][4];  // 7位端点
+    int p[2];     // P位
+    Byte index[16];
+    float error;
+};
+// 端点量化为7位+P位(P位由4个通道共享)
+void QuantizeBC7Endpoint(const float e[4], int q[4], int& p) {
+    float best = FLT_MAX;
+    for (int pb = 0; pb < 2; pb++) {
+        int t[4];
+        float err = 0.0f;
+        for (int c = 0; c < 4; c++) {
+            t[c] = std::clamp(static_cast<int>((e[c] - pb) / 2.0f + 0.5f), 0, 127);
+            float d = e[c] - (t[c] * 2 + pb);
+            err += d * d;
+        }
+        if (err < best) {
+            best = err;
+            p = pb;
+            std::copy(t, t + 4, q);
+        }
+    }
+}
+BC7Result FitBC7(const ColorBlock& b, const float e0[4], const float e1[4]) {
+    BC7Result res;
+    QuantizeBC7Endpoint(e0, res.q[0], res.p[0]);
+    QuantizeBC7Endpoint(e1, res.q[1], res.p[1]);
+    int pal[16][4];
+    for (int c = 0; c < 4; c++) {
+        int v0 = res.q[0][c] * 2 + res.p[0], v1 = res.q[1][c] * 2 + res.p[1];
+        for (int k = 0; k < 16; k++)
+            pal[k][c] = ((64 - bc7_weights[k]) * v0 + bc7_weights[k] * v1 + 32) >> 6;
+    }
+    res.error = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float best = FLT_MAX;
+        for (int k = 0; k < 16; k++) {
+            float d = 0.0f;
+            for (int c = 0; c < 4; c++) {
+                float t = b.c[i][c] - pal[k][c];
+                d += t * t;
+            }
+            if (d < best) {
+                best = d;
+                res.index[i] = static_cast<Byte>(k);
+            }
+        }
+        res.error += best;
+    }
+    return res;
+}
+class BitWriter {
+    Byte* out;
+    uint32 pos;
+
+   public:
+    explicit BitWriter(Byte* dst) : out(dst), pos(0) {}
+    void write(uint32 v, uint32 bits) {
+        for (uint32 i = 0; i < bits; i++, pos++) {
+            if ((v >> i) & 1)
+                out[pos >> 3] |= static_cast<Byte>(1 << (pos & 7));
+        }
+    }
+};
+void EncodeBC7(const ColorBlock& b, Byte* out) {
+    float e0[4], e1[4];
+    AxisEndpoints(b, 4, e0, e1);
+    BC7Result best = FitBC7(b, e0, e1);
+    for (int iter = 0; iter < 2 && best.error > 0.0f; iter++) {
+        float w[16];
+        for (int i = 0; i < 16; i++)
+            w[i] = bc7_weights[best.index[i]] / 64.0f;
+        if (!LeastSquaresEndpoints(b, 4, w, e0, e1))
+            break;
+        BC7Result next = FitBC7(b, e0, e1);
+        if (next.error >= best.error)
+            break;
+        best = next;
+    }
+    // 第0个像素的索引最高位隐含为0
+    if (best.index[0] >= 8) {
+        std::swap(best.q[0], best.q[1]);
+        std::swap(best.p[0], best.p[1]);
+        for (int i = 0; i < 16; i++)
+            best.index[i] = static_cast<Byte>(15 - best.index[i]);
+    }
+    std::memset(out, 0, 16);
+    BitWriter bw(out);
+    bw.write(1 << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        bw.write(best.q[0][c], 7);
+        bw.write(best.q[1][c], 7);
+    }
+    bw.write(best.p[0], 1);
+    bw.write(best.p[1], 1);
+    bw.write(best.index[0], 3);
+    for (int i = 1; i < 16; i++)
+        bw.write(best.index[i], 4);
+}
+}  // namespace
+
+size_t BCnBlockSize(TextureCompression compression) {
+    switch (compression) {
+        case TextureCompression::BC1:
+        case TextureCompression::BC4:
+            return 8;
+        case TextureCompression::BC3:
+        case TextureCompression::BC5:
+        case TextureCompression::BC7:
+            return 16;
+        default:
+            throw std::logic_error("BCnBlockSize: not a block format.");
+    }
+}
+GLenum BCnInternalFormat(TextureCompression compression, bool srgb) {
+    switch (compression) {
+        case TextureCompression::BC1:
+            return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+                        : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TextureCompression::BC3:
+            return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+                        : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case TextureCompression::BC4:
+            return GL_COMPRESSED_RED_RGTC1;
+        case TextureCompression::BC5:
+            return GL_COMPRESSED_RG_RGTC2;
+        case TextureCompression::BC7:
+            return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+                        : GL_COMPRESSED_RGBA_BPTC_UNORM;
+        default:
+            throw std::logic_error("BCnInternalFormat: not a block format.");
+    }
+}
+size_t BCnEncodedSize(TextureCompression compression,
+                      GLsizei width,
+                      GLsizei height) {
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) *
+           BCnBlockSize(compression);
+}
+void EncodeBCn(const Byte* pixels,
+               GLsizei width,
+               GLsizei height,
+               int channels,
+               TextureCompression compression,
+               Byte* dst) {
+    const GLsizei blocks_x = (width + 3) / 4, blocks_y = (height + 3) / 4;
+    const size_t block_size = BCnBlockSize(compression);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (GLsizei by = 0; by < blocks_y; by++) {
+        ColorBlock block;
+        for (GLsizei bx = 0; bx < blocks_x; bx++) {
+            FetchBlock(pixels, width, height, channels, bx, by, block);
+            Byte* out = dst + (static_cast<size_t>(by) * blocks_x + bx) * block_size;
+            switch (compression) {
+                case TextureCompression::BC1:
+                    EncodeBC1(block, out);
+                    break;
+                case TextureCompression::BC3:
+                    EncodeBC4(block, 3, out);
+                    EncodeBC1(block, out + 8);
+                    break;
+                case TextureCompression::BC4:
+                    EncodeBC4(block, 0, out);
+                    break;
+                case TextureCompression::BC5:
+                    EncodeBC4(block, 0, out);
+                    EncodeBC4(block, 1, out + 8);
+                    break;
+                case TextureCompression::BC7:
+                    EncodeBC7(block, out);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+}  // namespace Boundless
@@ -0,0 +1,30 @@
+#ifndef _BOUNDLESS_BCN_HPP_FILE_
+#define _BOUNDLESS_BCN_HPP_FILE_
+#include "bl_resource.hpp"
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// BCn块压缩编码(纹理烘焙用)
+//
+// BC1/BC3颜色: 主成分方向求端点, 再以最小二乘迭代修正
+// BC4/BC5: 8值插值模式, 端点取通道的最小/最大值
+// BC7: 仅使用模式6(单子集, RGBA 7.7.7.7 + P位, 4位索引)
+// 以4x4块为单位编码, 边缘不足4像素时重复边缘像素; 按块行并行(OpenMP)
+//
+// 非AUTO的压缩格式单个块的字节数
+size_t BCnBlockSize(TextureCompression compression);
+// 对应的OpenGL内部格式
+GLenum BCnInternalFormat(TextureCompression compression, bool srgb);
+// 压缩后的数据长度
+size_t BCnEncodedSize(TextureCompression compression,
+                      GLsizei width,
+                      GLsizei height);
+// 编码一层8位图像(channels通道, 缺少的通道补为(0,0,0,255))
+void EncodeBCn(const Byte* pixels,
+               GLsizei width,
+               GLsizei height,
+               int channels,
+               TextureCompression compression,
+               Byte* dst);
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_BCN_HPP_FILE_
@@ -0,0 +1,125 @@
+#include "bl_bcn_compute.hpp"
+#include "bl_bcn.hpp"
+
+namespace Boundless {
+Program BCnComputeEncoder::shader;
+
+void BCnComputeEncoder::InitShader() {
+    shader.Init({{bcn_compute_shader_path, GL_COMPUTE_SHADER}});
+}
+void BCnComputeEncoder::Compress(Texture& tex, TextureCompression compression) {
+    GLint mode;
+    switch (compression) {
+        case TextureCompression::BC1:
+            mode = 0;
+            break;
+        case TextureCompression::BC3:
+            mode = 1;
+            break;
+        case TextureCompression::BC5:
+            mode = 2;
+            break;
+        default:
+            throw std::logic_error("BCnComputeEncoder: 只支持BC1/BC3/BC5.");
+    }
+    if (tex.target != GL_TEXTURE_2D) {
+        throw std::runtime_error("BCnComputeEncoder: 只支持GL_TEXTURE_2D.");
+    }
+    GLint levels = 0, internal_format = 0;
+    glGetTextureParameteriv(tex.texture_id, GL_TEXTURE_IMMUTABLE_LEVELS,
+                            &levels);
+    if (levels < 1) {
+        // 可变存储的纹理可能不完整, texelFetch()会返回(0,0,0,1)
+        throw std::runtime_error("BCnComputeEncoder: 源纹理必须是不可变存储.");
+    }
+    glGetTextureLevelParameteriv(tex.texture_id, 0, GL_TEXTURE_INTERNAL_FORMAT,
+                                 &internal_format);
+    const bool srgb =
+        internal_format == GL_SRGB8_ALPHA8 || internal_format == GL_SRGB8;
+    const bool wide = compression != TextureCompression::BC1;  // 128位块
+    const GLenum staging_format = wide ? GL_RGBA32UI : GL_RG32UI;
+
+    GLuint dst, staging;
+    glCreateTextures(GL_TEXTURE_2D, 1, &dst);
+    const GLenum dst_format = BCnInternalFormat(compression, srgb && mode != 2);
+    MemoryTracker::TextureStorage2D(MemoryTag::Texture, dst, levels, dst_format,
+                                    tex.width, tex.height);
+    const GLenum params[] = {GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER,
+                             GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T};
+    for (GLenum param : params) {
+        GLint value;
+        glGetTextureParameteriv(tex.texture_id, param, &value);
+        glTextureParameteri(dst, param, value);
+    }
+    GLint swizzle[4];
+    glGetTextureParameteriv(tex.texture_id, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    glTextureParameteriv(dst, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    // 暂存纹理按第0层的块数分配, 各层级复用其左上角
+    glCreateTextures(GL_TEXTURE_2D, 1, &staging);
+    MemoryTracker::TextureStorage2D(MemoryTag::Texture, staging, 1,
+                                    staging_format, (tex.width + 3) / 4,
+                                    (tex.height + 3) / 4);
+
+    // 尺寸不是4的倍数的层级(包括最后几个小于4的层级)不能用glCopyImageSubData
+    // 写入不完整的边缘块, 改为经缓冲区在GPU上转存后以
+    // glCompressedTextureSubImage2D上传
+    const GLsizei block_bytes = wide ? 16 : 8;
+    const GLsizei max_bytes =
+        (tex.width + 3) / 4 * ((tex.height + 3) / 4) * block_bytes;
+    GLuint transfer = 0;
+
+    const GLuint program = shader.GetID();
+    glProgramUniform1i(program, bcn_compute_mode_uniform, mode);
+    glProgramUniform1i(program, bcn_compute_srgb_uniform,
+                       srgb ? GL_TRUE : GL_FALSE);
+    glUseProgram(program);
+    glBindTextureUnit(0, tex.texture_id);
+    glBindImageTexture(wide ? 1 : 0, staging, 0, GL_FALSE, 0, GL_WRITE_ONLY,
+                       staging_format);
+    for (GLint i = 0; i < levels; i++) {
+        GLsizei level_width = std::max(1, tex.width >> i);
+        GLsizei level_height = std::max(1, tex.height >> i);
+        GLsizei blocks_x = (level_width + 3) / 4;
+        GLsizei blocks_y = (level_height + 3) / 4;
+        glProgramUniform1i(program, bcn_compute_level_uniform, i);
+        glDispatchCompute((blocks_x + bcn_compute_group_size - 1) /
+                              bcn_compute_group_size,
+                          (blocks_y + bcn_compute_group_size - 1) /
+                              bcn_compute_group_size,
+                          1);
+        // glCopyImageSubData不在任何具体的屏障位之内
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+        if (level_width % 4 == 0 && level_height % 4 == 0) {
+            // 源为非压缩格式时, 复制区域以源纹元(即块)为单位
+            glCopyImageSubData(staging, GL_TEXTURE_2D, 0, 0, 0, 0, dst,
+                               GL_TEXTURE_2D, i, 0, 0, 0, blocks_x, blocks_y,
+                               1);
+            continue;
+        }
+        if (transfer == 0) {
+            glCreateBuffers(1, &transfer);
+            MemoryTracker::BufferStorage(MemoryTag::Texture, transfer,
+                                         max_bytes, nullptr, 0);
+        }
+        GLsizei bytes = blocks_x * blocks_y * block_bytes;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, transfer);
+        glGetTextureSubImage(staging, 0, 0, 0, 0, blocks_x, blocks_y, 1,
+                             wide ? GL_RGBA_INTEGER : GL_RG_INTEGER,
+                             GL_UNSIGNED_INT, bytes, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glMemoryBarrier(GL_PIXEL_BUFFER_BARRIER_BIT);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, transfer);
+        glCompressedTextureSubImage2D(
+            dst, i, 0, 0, level_width, level_height, dst_format, bytes, nullptr);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    glBindImageTexture(wide ? 1 : 0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY,
+                       staging_format);
+    glBindTextureUnit(0, 0);
+    glUseProgram(0);
+    MemoryTracker::DeleteBuffers(1, &transfer);
+    MemoryTracker::DeleteTextures(1, &staging);
+    MemoryTracker::DeleteTextures(1, &tex.texture_id);
+    tex.texture_id = dst;
+}
+}  // namespace Boundless
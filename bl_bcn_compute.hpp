@@ -0,0 +1,35 @@
+#ifndef _BOUNDLESS_BCN_COMPUTE_HPP_FILE_
+#define _BOUNDLESS_BCN_COMPUTE_HPP_FILE_
+#include "bl_render.hpp"
+#include "bl_resource.hpp"
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 运行时BCn块压缩(计算着色器)
+//
+// 用于运行时生成的纹理(impostor图集, 光照贴图, 地形混合结果等).
+// 每个线程编码一个4x4块, 写入每纹元对应一个块的整数暂存纹理
+// (BC1: GL_RG32UI, BC3/BC5: GL_RGBA32UI), 再由glCopyImageSubData逐层级复制到
+// 块压缩纹理中, 数据不经过CPU.
+// BC1/BC3颜色取包围盒对角线为端点, 质量低于离线的EncodeBCn(), 换取速度.
+// 源纹理为sRGB格式时输出对应的sRGB压缩格式.
+// 使用前调用InitShader(), 只能在渲染线程使用.
+//
+const GLuint bcn_compute_mode_uniform = 0;
+const GLuint bcn_compute_level_uniform = 1;
+const GLuint bcn_compute_srgb_uniform = 2;
+const GLuint bcn_compute_group_size = 8;  // 与着色器的local_size一致
+const char* const bcn_compute_shader_path =
+    ".\\shader\\bcn_compress_compute.glsl";
+
+class BCnComputeEncoder {
+   public:
+    static Program shader;
+
+    static void InitShader();
+    // 把tex(不可变存储的GL_TEXTURE_2D)的所有mipmap层级压缩为BC1/BC3/BC5,
+    // 以新的压缩纹理替换tex中的纹理对象, 采样参数保持不变
+    static void Compress(Texture& tex, TextureCompression compression);
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_BCN_COMPUTE_HPP_FILE_
@@ -0,0 +1,233 @@
+#ifdef BL_MAKE_BENCHMARK_PROGRAM
+#include <barrier>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "bl_data_struct.hpp"
+#include "bl_thread.hpp"
+
+using namespace Boundless;
+namespace {
+struct bench_object {
+    float data[12];
+};
+const size_t batch = 256;      // 每轮连续分配的对象数
+const size_t rounds = 20000;   // 每个线程的轮数
+const size_t cross_batch = 4096;
+const size_t cross_rounds = 500;
+
+struct pool_allocator {
+    concurrent_object_pool<bench_object> pool;
+    bench_object* allocate() { return pool.allocate(); }
+    void deallocate(bench_object* p) { pool.deallocate_raw(p); }
+};
+struct malloc_allocator {
+    bench_object* allocate() {
+        return (bench_object*)malloc(sizeof(bench_object));
+    }
+    void deallocate(bench_object* p) { free(p); }
+};
+
+// 每个线程反复分配一批再全部释放, 返回每次分配+释放的平均纳秒数
+template <typename allocator>
+double churn(allocator& alloc, unsigned threads) {
+    std::vector<std::thread> workers;
+    timer t;
+    t.begin();
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back([&alloc]() {
+            std::vector<bench_object*> objects(batch);
+            for (size_t r = 0; r < rounds; r++) {
+                for (size_t k = 0; k < batch; k++) {
+                    objects[k] = alloc.allocate();
+                    objects[k]->data[0] = static_cast<float>(k);
+                }
+                for (size_t k = 0; k < batch; k++) {
+                    alloc.deallocate(objects[k]);
+                }
+            }
+        });
+    }
+    for (std::thread& w : workers)
+        w.join();
+    t.end();
+    return static_cast<double>(t.nanoseconds()) / (rounds * batch);
+}
+// 每个线程释放前一个线程分配的对象
+template <typename allocator>
+double cross_thread(allocator& alloc, unsigned threads) {
+    std::vector<std::vector<bench_object*>> slots(
+        threads, std::vector<bench_object*>(cross_batch));
+    std::barrier sync(threads);
+    std::vector<std::thread> workers;
+    timer t;
+    t.begin();
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back([&, i]() {
+            for (size_t r = 0; r < cross_rounds; r++) {
+                for (size_t k = 0; k < cross_batch; k++)
+                    slots[i][k] = alloc.allocate();
+                sync.arrive_and_wait();
+                for (bench_object* p : slots[(i + 1) % threads])
+                    alloc.deallocate(p);
+                sync.arrive_and_wait();
+            }
+        });
+    }
+    for (std::thread& w : workers)
+        w.join();
+    t.end();
+    return static_cast<double>(t.nanoseconds()) / (cross_rounds * cross_batch);
+}
+
+// 模拟资源路径集合: 目录层级与命名方式接近引擎的资源目录
+std::vector<std::string> make_asset_paths(size_t count, uint32_t seed) {
+    static const char* dirs[] = {".\\shader\\", ".\\assets\\mesh\\",
+                                 ".\\assets\\texture\\",
+                                 ".\\assets\\level\\"};
+    static const char* exts[] = {".glsl", ".mesh", ".texture", ".bvh"};
+    std::mt19937 rng(seed);
+    std::vector<std::string> paths;
+    paths.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t kind = rng() % 4;
+        paths.push_back(std::string(dirs[kind]) + "group" +
+                        std::to_string(rng() % 64) + "\\asset_" +
+                        std::to_string(i) + exts[kind]);
+    }
+    return paths;
+}
+struct string_hash {
+    typedef void is_transparent;
+    size_t operator()(std::string_view s) const noexcept {
+        return std::hash<std::string_view>()(s);
+    }
+};
+struct map_result {
+    double insert, hit, miss;
+};
+// 插入全部路径, 再以string_view查找存在/不存在的路径, 返回各操作的平均纳秒数
+template <typename map_type>
+map_result bench_paths(const std::vector<std::string>& paths,
+                       const std::vector<std::string>& misses) {
+    const size_t repeat = 20;
+    map_result res{};
+    timer t;
+    size_t sink = 0;
+    for (size_t r = 0; r < repeat; r++) {
+        map_type m;
+        t.begin();
+        for (uint32_t i = 0; i < paths.size(); i++)
+            m.try_emplace(paths[i], i);
+        t.end();
+        res.insert += t.nanoseconds();
+        t.begin();
+        for (const std::string& p : paths)
+            sink += m.find(std::string_view(p))->second;
+        t.end();
+        res.hit += t.nanoseconds();
+        t.begin();
+        for (const std::string& p : misses)
+            sink += m.find(std::string_view(p)) == m.end();
+        t.end();
+        res.miss += t.nanoseconds();
+    }
+    if (sink == 0)
+        std::printf(" ");
+    res.insert /= repeat * paths.size();
+    res.hit /= repeat * paths.size();
+    res.miss /= repeat * misses.size();
+    return res;
+}
+// 以GL对象名(小整数)为键的查找
+template <typename map_type>
+map_result bench_names(size_t count) {
+    const size_t repeat = 20;
+    map_result res{};
+    timer t;
+    size_t sink = 0;
+    for (size_t r = 0; r < repeat; r++) {
+        map_type m;
+        t.begin();
+        for (uint32_t i = 1; i <= count; i++)
+            m.try_emplace(i, i);
+        t.end();
+        res.insert += t.nanoseconds();
+        t.begin();
+        for (uint32_t i = 1; i <= count; i++)
+            sink += m.find(i)->second;
+        t.end();
+        res.hit += t.nanoseconds();
+        t.begin();
+        for (uint32_t i = 1; i <= count; i++)
+            sink += m.find(i + static_cast<uint32_t>(count)) == m.end();
+        t.end();
+        res.miss += t.nanoseconds();
+    }
+    if (sink == 0)
+        std::printf(" ");
+    res.insert /= repeat * count;
+    res.hit /= repeat * count;
+    res.miss /= repeat * count;
+    return res;
+}
+void print_result(const char* name, size_t count, map_result r) {
+    std::printf("%-28s %8zu %12.2f %12.2f %12.2f\n", name, count, r.insert,
+                r.hit, r.miss);
+}
+void bench_hash_maps() {
+    std::printf("flat_hash_map vs std::unordered_map (ns/op)\n");
+    std::printf("%-28s %8s %12s %12s %12s\n", "map", "size", "insert", "hit",
+                "miss");
+    for (size_t count : {1000, 20000, 200000}) {
+        std::vector<std::string> paths = make_asset_paths(count, 1);
+        std::vector<std::string> misses = make_asset_paths(count, 2);
+        for (std::string& s : misses)
+            s += "~";  // 保证不存在
+        print_result("flat_hash_map<string>", count,
+                     bench_paths<flat_hash_map<std::string, uint32_t>>(paths,
+                                                                       misses));
+        print_result("unordered_map<string>", count,
+                     bench_paths<std::unordered_map<std::string, uint32_t,
+                                                    string_hash,
+                                                    std::equal_to<>>>(paths,
+                                                                      misses));
+        print_result("flat_hash_map<GLuint>", count,
+                     bench_names<flat_hash_map<uint32_t, uint32_t>>(count));
+        print_result("unordered_map<GLuint>", count,
+                     bench_names<std::unordered_map<uint32_t, uint32_t>>(count));
+    }
+}
+}  // namespace
+
+int main() {
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("concurrent_object_pool vs malloc, %zu字节对象\n",
+                sizeof(bench_object));
+    std::printf("%8s %16s %16s %16s %16s\n", "threads", "pool ns/op",
+                "malloc ns/op", "pool Mops/s", "malloc Mops/s");
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        pool_allocator pool;
+        malloc_allocator heap;
+        double p = churn(pool, threads);
+        double m = churn(heap, threads);
+        std::printf("%8u %16.2f %16.2f %16.1f %16.1f\n", threads, p * threads,
+                    m * threads, 1e3 / p, 1e3 / m);
+    }
+    std::printf("跨线程释放:\n");
+    for (unsigned threads = 2; threads <= max_threads; threads *= 2) {
+        pool_allocator pool;
+        malloc_allocator heap;
+        double p = cross_thread(pool, threads);
+        double m = cross_thread(heap, threads);
+        std::printf("%8u %16.2f %16.2f %16.1f %16.1f\n", threads, p * threads,
+                    m * threads, 1e3 / p, 1e3 / m);
+    }
+    bench_hash_maps();
+    return 0;
+}
+#endif  // BL_MAKE_BENCHMARK_PROGRAM
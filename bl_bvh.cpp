@@ -0,0 +1,630 @@
+#include "bl_bvh.hpp"
+
+#include <limits>
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+#define BL_BVH_USE_SSE
+#endif
+
+namespace Boundless {
+static const float bvh_inf = std::numeric_limits<float>::infinity();
+
+void BoundingBox::reset() {
+    bmin = Vector3f(bvh_inf, bvh_inf, bvh_inf);
+    bmax = Vector3f(-bvh_inf, -bvh_inf, -bvh_inf);
+}
+void BoundingBox::expand(const Vector3f& p) {
+    bmin = bmin.cwiseMin(p);
+    bmax = bmax.cwiseMax(p);
+}
+void BoundingBox::expand(const BoundingBox& b) {
+    bmin = bmin.cwiseMin(b.bmin);
+    bmax = bmax.cwiseMax(b.bmax);
+}
+float BoundingBox::area() const {
+    Vector3f d = bmax - bmin;
+    if (d.x() < 0.0f || d.y() < 0.0f || d.z() < 0.0f)
+        return 0.0f;
+    return 2.0f * (d.x() * d.y() + d.y() * d.z() + d.z() * d.x());
+}
+bool BoundingBox::intersect(const Ray& ray, float* tnear) const {
+    float t0 = ray.tmin, t1 = ray.tmax;
+    for (int i = 0; i < 3; i++) {
+        float inv = 1.0f / ray.direction[i];
+        float tn = (bmin[i] - ray.origin[i]) * inv;
+        float tf = (bmax[i] - ray.origin[i]) * inv;
+        if (inv < 0.0f)
+            std::swap(tn, tf);
+        t0 = tn > t0 ? tn : t0;
+        t1 = tf < t1 ? tf : t1;
+        if (t0 > t1)
+            return false;
+    }
+    *tnear = t0;
+    return true;
+}
+
+///////////////////////////////////////////////
+// BVH构建
+//
+namespace {
+struct BuildPrim {
+    BoundingBox box;
+    Vector3f centroid;
+    uint32 id;
+};
+struct BuildNode {
+    BoundingBox box;
+    uint32 left, right;  // 子节点(仅内部节点)
+    uint32 start, count;  // 图元范围(仅叶子, count > 0)
+};
+struct BuildContext {
+    std::vector<BuildPrim> prims;
+    std::vector<BuildNode> nodes;
+    const Byte* positions;
+    size_t stride;
+    const uint32* indices;
+};
+inline Vector3f ReadPosition(const BuildContext& ctx, uint32 vertex) {
+    float p[3];
+    std::memcpy(p, ctx.positions + ctx.stride * vertex, sizeof(p));
+    return Vector3f(p[0], p[1], p[2]);
+}
+uint32 BuildBinary(BuildContext& ctx, uint32 start, uint32 end) {
+    uint32 index = static_cast<uint32>(ctx.nodes.size());
+    ctx.nodes.push_back({});
+    BoundingBox box, cbox;
+    box.reset();
+    cbox.reset();
+    for (uint32 i = start; i < end; i++) {
+        box.expand(ctx.prims[i].box);
+        cbox.expand(ctx.prims[i].centroid);
+    }
+    ctx.nodes[index].box = box;
+    uint32 n = end - start;
+    auto make_leaf = [&]() {
+        ctx.nodes[index].start = start;
+        ctx.nodes[index].count = n;
+        return index;
+    };
+    if (n <= 4)
+        return make_leaf();
+
+    // SAH分箱: 在每个轴上将质心分入bvh_sah_bins个箱子, 扫描求最小代价划分
+    float best_cost = bvh_inf;
+    int best_axis = -1;
+    uint32 best_split = 0;
+    Vector3f extent = cbox.bmax - cbox.bmin;
+    for (int axis = 0; axis < 3; axis++) {
+        if (extent[axis] <= 0.0f)
+            continue;
+        BoundingBox bins[bvh_sah_bins];
+        uint32 counts[bvh_sah_bins] = {};
+        for (uint32 b = 0; b < bvh_sah_bins; b++)
+            bins[b].reset();
+        float scale = bvh_sah_bins / extent[axis];
+        for (uint32 i = start; i < end; i++) {
+            uint32 b = static_cast<uint32>(
+                (ctx.prims[i].centroid[axis] - cbox.bmin[axis]) * scale);
+            b = b < bvh_sah_bins ? b : bvh_sah_bins - 1;
+            bins[b].expand(ctx.prims[i].box);
+            counts[b]++;
+        }
+        float right_area[bvh_sah_bins];
+        uint32 right_count[bvh_sah_bins];
+        BoundingBox acc;
+        acc.reset();
+        uint32 cnt = 0;
+        for (uint32 b = bvh_sah_bins - 1; b > 0; b--) {
+            acc.expand(bins[b]);
+            cnt += counts[b];
+            right_area[b] = acc.area();
+            right_count[b] = cnt;
+        }
+        acc.reset();
+        cnt = 0;
+        for (uint32 b = 1; b < bvh_sah_bins; b++) {
+            acc.expand(bins[b - 1]);
+            cnt += counts[b - 1];
+            if (cnt == 0 || right_count[b] == 0)
+                continue;
+            float cost = acc.area() * cnt + right_area[b] * right_count[b];
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_split = b;
+            }
+        }
+    }
+    float parent_area = box.area();
+    float leaf_cost = bvh_intersect_cost * n;
+    if (best_axis >= 0 && parent_area > 0.0f) {
+        best_cost = bvh_traversal_cost +
+                    bvh_intersect_cost * best_cost / parent_area;
+    }
+    if (n <= bvh_max_leaf_triangles && (best_axis < 0 || best_cost >= leaf_cost))
+        return make_leaf();
+
+    uint32 mid;
+    if (best_axis >= 0) {
+        float scale = bvh_sah_bins / extent[best_axis];
+        float cmin = cbox.bmin[best_axis];
+        auto it = std::partition(
+            ctx.prims.begin() + start, ctx.prims.begin() + end,
+            [&](const BuildPrim& p) {
+                uint32 b = static_cast<uint32>(
+                    (p.centroid[best_axis] - cmin) * scale);
+                return (b < bvh_sah_bins ? b : bvh_sah_bins - 1) < best_split;
+            });
+        mid = static_cast<uint32>(it - ctx.prims.begin());
+    } else {
+        mid = start;
+    }
+    if (mid == start || mid == end) {
+        // 质心重合或划分失败, 按最长轴中位数切分
+        int axis = 0;
+        if (extent.y() > extent[axis])
+            axis = 1;
+        if (extent.z() > extent[axis])
+            axis = 2;
+        mid = start + n / 2;
+        std::nth_element(ctx.prims.begin() + start, ctx.prims.begin() + mid,
+                         ctx.prims.begin() + end,
+                         [axis](const BuildPrim& a, const BuildPrim& b) {
+                             return a.centroid[axis] < b.centroid[axis];
+                         });
+    }
+    uint32 left = BuildBinary(ctx, start, mid);
+    uint32 right = BuildBinary(ctx, mid, end);
+    ctx.nodes[index].left = left;
+    ctx.nodes[index].right = right;
+    ctx.nodes[index].count = 0;
+    return index;
+}
+void EmitPackets(const BuildContext& ctx,
+                 const BuildNode& leaf,
+                 std::vector<TrianglePacket4>& packets) {
+    for (uint32 i = 0; i < leaf.count; i += 4) {
+        TrianglePacket4 pk;
+        for (uint32 lane = 0; lane < 4; lane++) {
+            Vector3f v0(0.0f, 0.0f, 0.0f), e1(0.0f, 0.0f, 0.0f),
+                e2(0.0f, 0.0f, 0.0f);
+            uint32 id = UINT32_MAX;
+            if (i + lane < leaf.count) {
+                id = ctx.prims[leaf.start + i + lane].id;
+                const uint32* tri = ctx.indices + id * 3;
+                v0 = ReadPosition(ctx, tri[0]);
+                e1 = ReadPosition(ctx, tri[1]) - v0;
+                e2 = ReadPosition(ctx, tri[2]) - v0;
+            }
+            for (int k = 0; k < 3; k++) {
+                pk.v0[k][lane] = v0[k];
+                pk.e1[k][lane] = e1[k];
+                pk.e2[k][lane] = e2[k];
+            }
+            pk.id[lane] = id;
+        }
+        packets.push_back(pk);
+    }
+}
+// 将二叉树折叠为4叉树: 反复展开面积最大的内部子节点, 直到凑满4个子节点
+uint32 Collapse(const BuildContext& ctx,
+                uint32 binary,
+                std::vector<BVHNode4>& nodes,
+                std::vector<TrianglePacket4>& packets) {
+    uint32 children[4];
+    uint32 child_count = 0;
+    const BuildNode& root = ctx.nodes[binary];
+    if (root.count > 0) {
+        children[child_count++] = binary;
+    } else {
+        children[child_count++] = root.left;
+        children[child_count++] = root.right;
+    }
+    while (child_count < 4) {
+        int best = -1;
+        float best_area = -1.0f;
+        for (uint32 i = 0; i < child_count; i++) {
+            const BuildNode& c = ctx.nodes[children[i]];
+            if (c.count == 0 && c.box.area() > best_area) {
+                best_area = c.box.area();
+                best = static_cast<int>(i);
+            }
+        }
+        if (best < 0)
+            break;
+        const BuildNode& c = ctx.nodes[children[best]];
+        children[best] = c.left;
+        children[child_count++] = c.right;
+    }
+
+    uint32 index = static_cast<uint32>(nodes.size());
+    nodes.push_back({});
+    for (uint32 i = 0; i < 4; i++) {
+        BoundingBox box;
+        box.reset();
+        int32 child = -1;
+        uint32 count = 0;
+        if (i < child_count) {
+            const BuildNode& c = ctx.nodes[children[i]];
+            box = c.box;
+            if (c.count > 0) {
+                uint32 first = static_cast<uint32>(packets.size());
+                EmitPackets(ctx, c, packets);
+                child = ~static_cast<int32>(first);
+                count = static_cast<uint32>(packets.size()) - first;
+            } else {
+                child = static_cast<int32>(
+                    Collapse(ctx, children[i], nodes, packets));
+            }
+        }
+        BVHNode4& node = nodes[index];
+        for (int k = 0; k < 3; k++) {
+            node.bmin[k][i] = box.bmin[k];
+            node.bmax[k][i] = box.bmax[k];
+        }
+        node.child[i] = child;
+        node.count[i] = count;
+    }
+    return index;
+}
+}  // namespace
+
+MeshBVH::MeshBVH() : triangle_count(0) {
+    bounds.reset();
+}
+void MeshBVH::Build(const Byte* positions,
+                    size_t stride,
+                    const uint32* indices,
+                    size_t count) {
+    nodes.clear();
+    packets.clear();
+    bounds.reset();
+    triangle_count = static_cast<uint32>(count);
+    if (count == 0)
+        return;
+    BuildContext ctx;
+    ctx.positions = positions;
+    ctx.stride = stride;
+    ctx.indices = indices;
+    ctx.prims.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        BuildPrim& p = ctx.prims[i];
+        p.id = static_cast<uint32>(i);
+        p.box.reset();
+        for (int k = 0; k < 3; k++)
+            p.box.expand(ReadPosition(ctx, indices[i * 3 + k]));
+        p.centroid = (p.box.bmin + p.box.bmax) * 0.5f;
+        bounds.expand(p.box);
+    }
+    ctx.nodes.reserve(count * 2 / 4 + 1);
+    BuildBinary(ctx, 0, static_cast<uint32>(count));
+    nodes.reserve(ctx.nodes.size() / 3 + 1);
+    packets.reserve(count / 4 + ctx.nodes.size() / 2 + 1);
+    Collapse(ctx, 0, nodes, packets);
+}
+
+///////////////////////////////////////////////
+// BVH遍历
+//
+namespace {
+struct RayData {
+    float org[3], dir[3], inv[3];
+    int near_sel[3];  // 1: 该轴方向为负, 近平面取bmax
+};
+#ifdef BL_BVH_USE_SSE
+inline int IntersectNode4(const BVHNode4& node,
+                          const RayData& r,
+                          float tmin,
+                          float tmax,
+                          float tnear[4]) {
+    __m128 tn = _mm_set1_ps(tmin), tf = _mm_set1_ps(tmax);
+    for (int k = 0; k < 3; k++) {
+        __m128 o = _mm_set1_ps(r.org[k]), iv = _mm_set1_ps(r.inv[k]);
+        __m128 lo = _mm_load_ps(r.near_sel[k] ? node.bmax[k] : node.bmin[k]);
+        __m128 hi = _mm_load_ps(r.near_sel[k] ? node.bmin[k] : node.bmax[k]);
+        tn = _mm_max_ps(tn, _mm_mul_ps(_mm_sub_ps(lo, o), iv));
+        tf = _mm_min_ps(tf, _mm_mul_ps(_mm_sub_ps(hi, o), iv));
+    }
+    _mm_storeu_ps(tnear, tn);
+    return _mm_movemask_ps(_mm_cmple_ps(tn, tf));
+}
+inline bool IntersectPacket4(const TrianglePacket4& pk,
+                             const RayData& r,
+                             float tmin,
+                             RayHit& hit) {
+    const __m128 dx = _mm_set1_ps(r.dir[0]), dy = _mm_set1_ps(r.dir[1]),
+                 dz = _mm_set1_ps(r.dir[2]);
+    const __m128 e1x = _mm_load_ps(pk.e1[0]), e1y = _mm_load_ps(pk.e1[1]),
+                 e1z = _mm_load_ps(pk.e1[2]);
+    const __m128 e2x = _mm_load_ps(pk.e2[0]), e2y = _mm_load_ps(pk.e2[1]),
+                 e2z = _mm_load_ps(pk.e2[2]);
+    __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+    __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)),
+                            _mm_mul_ps(e1z, pz));
+    __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), det);
+    __m128 tx = _mm_sub_ps(_mm_set1_ps(r.org[0]), _mm_load_ps(pk.v0[0]));
+    __m128 ty = _mm_sub_ps(_mm_set1_ps(r.org[1]), _mm_load_ps(pk.v0[1]));
+    __m128 tz = _mm_sub_ps(_mm_set1_ps(r.org[2]), _mm_load_ps(pk.v0[2]));
+    __m128 u = _mm_mul_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)),
+                   _mm_mul_ps(tz, pz)),
+        inv);
+    __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+    __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+    __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+    __m128 v = _mm_mul_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)),
+                   _mm_mul_ps(dz, qz)),
+        inv);
+    __m128 t = _mm_mul_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)),
+                   _mm_mul_ps(e2z, qz)),
+        inv);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 absdet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+    __m128 mask = _mm_cmpgt_ps(absdet, _mm_set1_ps(1e-12f));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+    mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+    mask = _mm_and_ps(mask, _mm_cmpgt_ps(t, _mm_set1_ps(tmin)));
+    mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(hit.t)));
+    int bits = _mm_movemask_ps(mask);
+    if (!bits)
+        return false;
+    alignas(16) float ta[4], ua[4], va[4];
+    _mm_store_ps(ta, t);
+    _mm_store_ps(ua, u);
+    _mm_store_ps(va, v);
+    for (int lane = 0; lane < 4; lane++) {
+        if ((bits >> lane & 1) && ta[lane] < hit.t) {
+            hit.t = ta[lane];
+            hit.u = ua[lane];
+            hit.v = va[lane];
+            hit.triangle = pk.id[lane];
+        }
+    }
+    return true;
+}
+#else
+inline int IntersectNode4(const BVHNode4& node,
+                          const RayData& r,
+                          float tmin,
+                          float tmax,
+                          float tnear[4]) {
+    int bits = 0;
+    for (int lane = 0; lane < 4; lane++) {
+        float tn = tmin, tf = tmax;
+        for (int k = 0; k < 3; k++) {
+            float lo = r.near_sel[k] ? node.bmax[k][lane] : node.bmin[k][lane];
+            float hi = r.near_sel[k] ? node.bmin[k][lane] : node.bmax[k][lane];
+            float a = (lo - r.org[k]) * r.inv[k];
+            float b = (hi - r.org[k]) * r.inv[k];
+            tn = a > tn ? a : tn;
+            tf = b < tf ? b : tf;
+        }
+        tnear[lane] = tn;
+        bits |= (tn <= tf) << lane;
+    }
+    return bits;
+}
+inline bool IntersectPacket4(const TrianglePacket4& pk,
+                             const RayData& r,
+                             float tmin,
+                             RayHit& hit) {
+    bool res = false;
+    for (int lane = 0; lane < 4; lane++) {
+        Vector3f d(r.dir[0], r.dir[1], r.dir[2]);
+        Vector3f e1(pk.e1[0][lane], pk.e1[1][lane], pk.e1[2][lane]);
+        Vector3f e2(pk.e2[0][lane], pk.e2[1][lane], pk.e2[2][lane]);
+        Vector3f pv = d.cross(e2);
+        float det = e1.dot(pv);
+        if (std::abs(det) <= 1e-12f)
+            continue;
+        float inv = 1.0f / det;
+        Vector3f tv(r.org[0] - pk.v0[0][lane], r.org[1] - pk.v0[1][lane],
+                    r.org[2] - pk.v0[2][lane]);
+        float u = tv.dot(pv) * inv;
+        Vector3f qv = tv.cross(e1);
+        float v = d.dot(qv) * inv;
+        float t = e2.dot(qv) * inv;
+        if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t > tmin && t < hit.t) {
+            hit.t = t;
+            hit.u = u;
+            hit.v = v;
+            hit.triangle = pk.id[lane];
+            res = true;
+        }
+    }
+    return res;
+}
+#endif
+}  // namespace
+
+bool MeshBVH::Intersect(const Ray& ray, RayHit& hit) const {
+    if (nodes.empty())
+        return false;
+    RayData r;
+    for (int k = 0; k < 3; k++) {
+        r.org[k] = ray.origin[k];
+        r.dir[k] = ray.direction[k];
+        r.inv[k] = 1.0f / ray.direction[k];
+        r.near_sel[k] = r.inv[k] < 0.0f;
+    }
+    float prev_t = hit.t;
+    hit.t = ray.tmax < hit.t ? ray.tmax : hit.t;
+    bool res = false;
+
+    struct StackEntry {
+        int32 child;
+        uint32 count;
+        float tnear;
+    };
+    // 每层最多净增3项, 一般的树深度用栈上数组即可; 放不下时转到堆上
+    StackEntry local_stack[256];
+    std::vector<StackEntry> heap_stack;
+    StackEntry* stack = local_stack;
+    size_t stack_capacity = 256;
+    size_t top = 0;
+    stack[top++] = {0, 0, ray.tmin};
+    while (top > 0) {
+        StackEntry e = stack[--top];
+        if (e.tnear > hit.t)
+            continue;
+        if (e.child < 0) {
+            uint32 first = static_cast<uint32>(~e.child);
+            for (uint32 i = 0; i < e.count; i++) {
+                res |= IntersectPacket4(packets[first + i], r, ray.tmin, hit);
+            }
+            continue;
+        }
+        const BVHNode4& node = nodes[e.child];
+        float tnear[4];
+        int bits = IntersectNode4(node, r, ray.tmin, hit.t, tnear);
+        // 按进入距离由远到近入栈, 使最近的子节点先出栈
+        StackEntry hits[4];
+        int hc = 0;
+        for (int lane = 0; lane < 4; lane++) {
+            if (!(bits >> lane & 1))
+                continue;
+            StackEntry s{node.child[lane], node.count[lane], tnear[lane]};
+            int j = hc++;
+            while (j > 0 && hits[j - 1].tnear < s.tnear) {
+                hits[j] = hits[j - 1];
+                j--;
+            }
+            hits[j] = s;
+        }
+        if (top + hc > stack_capacity) {
+            stack_capacity *= 2;
+            if (heap_stack.empty()) {
+                heap_stack.assign(local_stack, local_stack + top);
+            }
+            heap_stack.resize(stack_capacity);
+            stack = heap_stack.data();
+        }
+        for (int i = 0; i < hc; i++) {
+            stack[top++] = hits[i];
+        }
+    }
+    if (!res)
+        hit.t = prev_t;
+    return res;
+}
+
+///////////////////////////////////////////////
+// BVH文件
+//
+void MeshBVH::LoadBVH(const Byte* data, MeshBVH& bvh) {
+    if (*(uint64*)data != BVH_HEADER) {
+        throw std::runtime_error("BVH head code error.");
+    }
+    size_t len;
+    Byte* dt = UncompressData(data + sizeof(uint64), &len);
+    const BVHFile& head = *(const BVHFile*)dt;
+    bvh.bounds = head.bounds;
+    bvh.triangle_count = head.triangle_count;
+    bvh.nodes.resize(head.node_count);
+    bvh.packets.resize(head.packet_count);
+    const Byte* cur = dt + sizeof(BVHFile);
+    std::memcpy(bvh.nodes.data(), cur, sizeof(BVHNode4) * head.node_count);
+    cur += sizeof(BVHNode4) * head.node_count;
+    std::memcpy(bvh.packets.data(), cur,
+                sizeof(TrianglePacket4) * head.packet_count);
+    MemoryTracker::Free(dt);
+}
+void MeshBVH::LoadBVH(const std::string& path, MeshBVH& bvh) {
+    std::ifstream fin(path, std::ios_base::in | std::ios_base::binary);
+    if (!fin.is_open()) {
+        throw std::runtime_error("Cannot open file:" + path);
+    }
+    fin.seekg(0, std::ios::end);
+    size_t length = fin.tellg();
+    fin.seekg(0, std::ios::beg);
+    Byte* data = (Byte*)MemoryTracker::Allocate(length, MemoryTag::General);
+    if (data == nullptr) {
+        throw std::bad_alloc();
+    }
+    fin.read((char*)data, length);
+    fin.close();
+    try {
+        LoadBVH(data, bvh);
+    } catch (...) {
+        MemoryTracker::Free(data);
+        throw;
+    }
+    MemoryTracker::Free(data);
+}
+Byte* MeshBVH::PackBVH(size_t* ret_length, const MeshBVH& bvh) {
+    size_t full_size = sizeof(BVHFile) + sizeof(BVHNode4) * bvh.nodes.size() +
+                       sizeof(TrianglePacket4) * bvh.packets.size();
+    Byte* data = (Byte*)MemoryTracker::Allocate(full_size, MemoryTag::General);
+    Byte* cur = data;
+    if (data == nullptr) {
+        throw std::bad_alloc();
+    }
+    BVHFile& head = *(BVHFile*)cur;
+    head.node_count = static_cast<uint32>(bvh.nodes.size());
+    head.packet_count = static_cast<uint32>(bvh.packets.size());
+    head.triangle_count = bvh.triangle_count;
+    head.reserved = 0;
+    head.bounds = bvh.bounds;
+    cur += sizeof(BVHFile);
+    std::memcpy(cur, bvh.nodes.data(), sizeof(BVHNode4) * bvh.nodes.size());
+    cur += sizeof(BVHNode4) * bvh.nodes.size();
+    std::memcpy(cur, bvh.packets.data(),
+                sizeof(TrianglePacket4) * bvh.packets.size());
+    Byte* res = CompressData(data, &full_size, sizeof(uint64));
+    MemoryTracker::Free(data);
+    *(uint64*)res = BVH_HEADER;
+    *ret_length = full_size;
+    return res;
+}
+void MeshBVH::PackBVH(const std::string& path, const MeshBVH& bvh) {
+    size_t length;
+    Byte* data = PackBVH(&length, bvh);
+    std::ofstream fout(path, std::ios_base::out | std::ios_base::binary |
+                                 std::ios_base::trunc);
+    if (!fout.is_open()) {
+        MemoryTracker::Free(data);
+        throw std::runtime_error("Cannot open file:" + path);
+    }
+    fout.write((char*)data, length);
+    MemoryTracker::Free(data);
+    fout.close();
+}
+Byte* MeshBVH::GenBVHFile(const aiMesh* pointer, size_t* ret_length) {
+    std::vector<uint32> indices(pointer->mNumFaces * 3);
+    for (size_t i = 0; i < pointer->mNumFaces; i++) {
+        const aiFace& face = pointer->mFaces[i];
+        // 非三角形图元(点,线)以退化三角形占位, 保证三角形编号与索引数据一致
+        for (size_t j = 0; j < 3; j++) {
+            indices[i * 3 + j] =
+                face.mNumIndices == 3 ? face.mIndices[j] : face.mIndices[0];
+        }
+    }
+    static_assert(sizeof(ai_real) == sizeof(float),
+                  "BVH requires single precision assimp.");
+    MeshBVH bvh;
+    bvh.Build((const Byte*)pointer->mVertices, sizeof(aiVector3D),
+              indices.data(), pointer->mNumFaces);
+    std::cout << "BVH Nodes:" << bvh.nodes.size()
+              << "\tPackets:" << bvh.packets.size() << '\n';
+    return PackBVH(ret_length, bvh);
+}
+void MeshBVH::GenBVHFile(const aiMesh* ptr, const std::string& save_path) {
+    size_t length;
+    Byte* data = GenBVHFile(ptr, &length);
+    std::ofstream fout(save_path, std::ios_base::out | std::ios_base::binary |
+                                      std::ios_base::trunc);
+    if (!fout.is_open()) {
+        MemoryTracker::Free(data);
+        throw std::runtime_error("Cannot open file:" + save_path);
+    }
+    fout.write((char*)data, length);
+    MemoryTracker::Free(data);
+    fout.close();
+}
+}  // namespace Boundless
@@ -0,0 +1,100 @@
+#ifndef _BOUNDLESS_BVH_HPP_FILE_
+#define _BOUNDLESS_BVH_HPP_FILE_
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 射线查询相关
+//
+
+// 射线: origin + t * direction, t属于[tmin, tmax]
+// direction不要求单位化, 命中的t与direction使用同一参数化
+struct Ray {
+    Vector3f origin, direction;
+    float tmin, tmax;
+};
+// 单个网格的命中结果
+struct RayHit {
+    float t;          // 命中点参数
+    float u, v;       // 重心坐标(命中点 = (1-u-v)*v0 + u*v1 + v*v2)
+    uint32 triangle;  // 三角形编号(对应索引数据中的第triangle个三角形)
+};
+// 包围盒
+struct BoundingBox {
+    Vector3f bmin, bmax;
+    void reset();
+    void expand(const Vector3f& p);
+    void expand(const BoundingBox& b);
+    float area() const;
+    // 射线与包围盒求交, 命中时返回true并写入进入点参数
+    bool intersect(const Ray& ray, float* tnear) const;
+};
+
+// BVH4节点: 4个子节点的包围盒以SoA存储, 一次SSE指令测试4个子节点
+// child[i] >= 0: 内部节点编号
+// child[i] <  0: 叶子, 三角形包从~child[i]开始, 共count[i]个
+// 空槽位的包围盒为空盒(bmin = +inf, bmax = -inf), 永远不会命中
+struct alignas(16) BVHNode4 {
+    float bmin[3][4];
+    float bmax[3][4];
+    int32 child[4];
+    uint32 count[4];
+};
+// 4个三角形的SoA数据包, 预先计算边向量供Moller-Trumbore求交使用
+// 不足4个时以退化三角形填充(id = UINT32_MAX)
+struct alignas(16) TrianglePacket4 {
+    float v0[3][4];
+    float e1[3][4];
+    float e2[3][4];
+    uint32 id[4];
+};
+struct BVHFile {
+    uint32 node_count, packet_count;
+    uint32 triangle_count, reserved;
+    BoundingBox bounds;
+    // 之后依次为BVHNode4[node_count], TrianglePacket4[packet_count]
+};
+const size_t BVH_HEADER = 0xF243516728FF0004;  // BVH文件头代码
+const uint32 bvh_sah_bins = 16;               // SAH分箱数
+const uint32 bvh_max_leaf_triangles = 16;     // 叶子最多三角形数
+const float bvh_traversal_cost = 1.0f;        // SAH遍历代价
+const float bvh_intersect_cost = 1.0f;        // SAH单个三角形求交代价
+
+// 网格三角形BVH, 以SAH分箱构建二叉树后折叠为4叉树
+class MeshBVH {
+    std::vector<BVHNode4> nodes;
+    std::vector<TrianglePacket4> packets;
+    BoundingBox bounds;
+    uint32 triangle_count;
+
+   public:
+    MeshBVH();
+    MeshBVH(MeshBVH&&) noexcept = default;
+    MeshBVH(const MeshBVH&) = delete;
+    MeshBVH& operator=(MeshBVH&&) noexcept = default;
+    MeshBVH& operator=(const MeshBVH&) = delete;
+
+    // 构建BVH
+    // positions: 顶点位置(3个float), 相邻顶点间隔stride字节
+    // indices: 三角形索引, 共triangle_count * 3个
+    void Build(const Byte* positions,
+               size_t stride,
+               const uint32* indices,
+               size_t triangle_count);
+    // 求最近命中, 命中时更新hit并返回true(仅接受t < hit.t的结果)
+    bool Intersect(const Ray& ray, RayHit& hit) const;
+    const BoundingBox& GetBounds() const { return bounds; }
+    uint32 GetTriangleCount() const { return triangle_count; }
+    bool Empty() const { return nodes.empty(); }
+
+    // Load~()方法 从文件加载BVH
+    static void LoadBVH(const Byte* data, MeshBVH& bvh);
+    static void LoadBVH(const std::string& path, MeshBVH& bvh);
+    // Pack~()方法 将BVH打包为文件, 返回的数据使用MemoryTracker::Free释放
+    static Byte* PackBVH(size_t* ret_length, const MeshBVH& bvh);
+    static void PackBVH(const std::string& path, const MeshBVH& bvh);
+    // Gen~()方法 从aiMesh构建BVH并打包, 返回的数据使用MemoryTracker::Free释放
+    static Byte* GenBVHFile(const aiMesh* ptr, size_t* ret_length);
+    static void GenBVHFile(const aiMesh* ptr, const std::string& save_path);
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_BVH_HPP_FILE_
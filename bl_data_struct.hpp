@@ -7,96 +7,1309 @@
 #ifndef _BOUNDLESS_DATA_STRUCT_HPP_FILE_
 #define _BOUNDLESS_DATA_STRUCT_HPP_FILE_
 #include <utility>
+#include <tuple>
+#include <cstddef>
+#include <algorithm>
 #include <exception>
 #include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "bl_page.hpp"
 namespace Boundless {
+///////////////////////////////////////////////
+// 对象池
+//
+// 块组(chunk)按2的幂大小对齐, 从大页内存提供者(bl_page.hpp)分配, 由对象
+// 地址即可找到所属块组; 每个块组记录存活对象数和存活位图, 分别挂在
+// 部分使用/已满/空闲三个链表上.
+// 分配优先使用部分使用的块组; 块组变空后, 空闲块组超过retained_chunks个时
+// 立即归还给系统, 因此卸载关卡后占用的内存会回落.
+// compact()把稀疏块组中的对象搬移到较满的块组, 腾空的块组随之释放.
+//
 template <typename DT, size_t chunk_size = 128>
 class object_pool {
    private:
     union block {
         block* ptr;
-        DT data;
+        alignas(DT) unsigned char data[sizeof(DT)];
     };
-    struct obj_chunk {
-        obj_chunk* next;
-        block blocks[chunk_size];
+    struct chunk_header {
+        chunk_header *prev, *next;  // 所在链表
+        block* free_head;
+        size_t live;
     };
-    obj_chunk* chunk_head;
-    block* free_head;
-public:
-    explicit object_pool(size_t init_chunks) {
-        if (init_chunks == 0) {
-            chunk_head = nullptr;
-            free_head = nullptr;
-            return;
-        }
+    // 块组字节数: 容纳头部和chunk_size个块的最小2的幂, 多余空间也用于存放块
+    static constexpr size_t header_bytes =
+        (sizeof(chunk_header) + alignof(block) - 1) / alignof(block) *
+        alignof(block);
+    static constexpr size_t bitmap_words_estimate = (chunk_size + 63) / 64;
+    static constexpr size_t round_pow2(size_t v) {
+        size_t p = 64;
+        while (p < v)
+            p *= 2;
+        return p;
+    }
+    static constexpr size_t chunk_bytes = round_pow2(
+        header_bytes + bitmap_words_estimate * 8 * 2 + chunk_size * sizeof(block));
+    static constexpr size_t bitmap_words =
+        (chunk_bytes - header_bytes) / sizeof(block) / 64 + 1;
+    static constexpr size_t bitmap_bytes =
+        (bitmap_words * 8 + alignof(block) - 1) / alignof(block) * alignof(block);
 
-        obj_chunk* p = (obj_chunk*)malloc(sizeof(obj_chunk));
-        if (!p) throw std::bad_alloc();
-        for (size_t i = 0; i < chunk_size - 1; i--) {
-            p->blocks[i].ptr = &p->blocks[i + 1];
-        }
-        p->blocks[chunk_size - 1].ptr = nullptr;
-        free_head = &p->blocks[0];
-        p->next = nullptr;
-        chunk_head = p;
+   public:
+    // 每个块组实际容纳的对象数(不小于chunk_size)
+    static constexpr size_t chunk_capacity =
+        (chunk_bytes - header_bytes - bitmap_bytes) / sizeof(block);
+    static_assert(chunk_capacity >= chunk_size);
 
-        for (size_t i = 1; i < init_chunks; i++) {
-        obj_chunk* p = (obj_chunk*)malloc(sizeof(obj_chunk));
-        if (!p) throw std::bad_alloc();
-            for (size_t i = 0; i < chunk_size - 1; i--) {
-                p->blocks[i].ptr = &p->blocks[i + 1];
+   private:
+    struct chunk_list {
+        chunk_header* head = nullptr;
+        size_t count = 0;
+    };
+    chunk_list partial, full, empty;
+    size_t live_total;
+    size_t retained_chunks;
+
+    static uint64_t* bitmap(chunk_header* c) {
+        return reinterpret_cast<uint64_t*>(reinterpret_cast<unsigned char*>(c) +
+                                           header_bytes);
+    }
+    static block* blocks(chunk_header* c) {
+        return reinterpret_cast<block*>(reinterpret_cast<unsigned char*>(c) +
+                                        header_bytes + bitmap_bytes);
+    }
+    static chunk_header* chunk_of(const void* p) {
+        return reinterpret_cast<chunk_header*>(reinterpret_cast<uintptr_t>(p) &
+                                               ~(uintptr_t)(chunk_bytes - 1));
+    }
+    static void list_push(chunk_list& l, chunk_header* c) {
+        c->prev = nullptr;
+        c->next = l.head;
+        if (l.head)
+            l.head->prev = c;
+        l.head = c;
+        l.count++;
+    }
+    static void list_remove(chunk_list& l, chunk_header* c) {
+        if (c->prev)
+            c->prev->next = c->next;
+        else
+            l.head = c->next;
+        if (c->next)
+            c->next->prev = c->prev;
+        l.count--;
+    }
+    chunk_header* new_chunk() {
+        void* mem = page_allocate(chunk_bytes, chunk_bytes);
+        if (!mem)
+            throw std::bad_alloc();
+        chunk_header* c = static_cast<chunk_header*>(mem);
+        block* b = blocks(c);
+        for (size_t i = 0; i < chunk_capacity - 1; i++) {
+            b[i].ptr = &b[i + 1];
+        }
+        b[chunk_capacity - 1].ptr = nullptr;
+        c->free_head = b;
+        c->live = 0;
+        for (size_t i = 0; i < bitmap_words; i++)
+            bitmap(c)[i] = 0;
+        return c;
+    }
+    static void delete_chunk(chunk_header* c) {
+        page_deallocate(c, chunk_bytes, chunk_bytes);
+    }
+    // 从指定块组中取一个块, 维护链表归属
+    block* take(chunk_header* c) {
+        block* b = c->free_head;
+        c->free_head = b->ptr;
+        size_t i = b - blocks(c);
+        bitmap(c)[i / 64] |= 1ULL << (i % 64);
+        if (c->live++ == 0) {
+            list_remove(empty, c);
+            list_push(partial, c);
+        }
+        if (c->live == chunk_capacity) {
+            list_remove(partial, c);
+            list_push(full, c);
+        }
+        live_total++;
+        return b;
+    }
+    // 把块还给所属块组, 块组变空且空闲块组过多时释放
+    void give_back(block* b) {
+        chunk_header* c = chunk_of(b);
+        size_t i = b - blocks(c);
+        bitmap(c)[i / 64] &= ~(1ULL << (i % 64));
+        b->ptr = c->free_head;
+        c->free_head = b;
+        if (c->live-- == chunk_capacity) {
+            list_remove(full, c);
+            list_push(partial, c);
+        }
+        if (c->live == 0) {
+            list_remove(partial, c);
+            if (empty.count >= retained_chunks) {
+                delete_chunk(c);
+            } else {
+                list_push(empty, c);
             }
-            p->blocks[chunk_size - 1].ptr = free_head;
-            free_head = &p->blocks[0];
-            p->next = chunk_head;
-            chunk_head = p;
+        }
+        live_total--;
+    }
+    block* allocate_block() {
+        if (partial.head)
+            return take(partial.head);
+        if (!empty.head)
+            block_allocate();
+        return take(empty.head);
+    }
+
+   public:
+    // init_chunks: 预先分配的块组数; retained_chunks: 保留的空闲块组数上限
+    explicit object_pool(size_t init_chunks, size_t retained = 1)
+        : live_total(0), retained_chunks(retained) {
+        for (size_t i = 0; i < init_chunks; i++) {
+            block_allocate();
         }
     }
     object_pool(object_pool&&) = delete;
     object_pool(const object_pool&) = delete;
     object_pool& operator=(object_pool&&) = delete;
     object_pool& operator=(const object_pool&) = delete;
-    void block_allocate() {
-        obj_chunk* p = (obj_chunk*)malloc(sizeof(obj_chunk));
-        if (!p) throw std::bad_alloc();
-        for (size_t i = 0; i < chunk_size - 1; i--) {
-            p->blocks[i].ptr = &p->blocks[i + 1];
-        }
-        p->blocks[chunk_size - 1].ptr = free_head;
-        free_head = &p->blocks[0];
-        p->next = chunk_head;
-        chunk_head = p;
-    }
+    // 新增一个空闲块组
+    void block_allocate() { list_push(empty, new_chunk()); }
     template <typename... arguments>
     DT* emplace_allocate(arguments&&... args) {
-        if (!free_head)
-            block_allocate();
-        DT* p = &free_head->data;
-        free_head = free_head->ptr;
-        p->DT(std::forward<arguments>(args)...);
-        return p;
-    }
-    DT* allocate() {
-        if (!free_head)
-            block_allocate();
-        DT* p = &free_head->data;
-        free_head = free_head->ptr;
-        return p;
+        block* b = allocate_block();
+        try {
+            return new (b->data) DT(std::forward<arguments>(args)...);
+        } catch (...) {
+            give_back(b);
+            throw;
+        }
     }
+    // 只分配内存, 不构造对象
+    DT* allocate() { return reinterpret_cast<DT*>(allocate_block()->data); }
+    // 析构对象并释放
     void deallocate(DT* ptr) {
         ptr->~DT();
-        ((block*)ptr)->ptr = free_head;
-        free_head = ((block*)ptr)->ptr;
+        give_back(reinterpret_cast<block*>(ptr));
+    }
+    // 只释放内存, 不析构对象
+    void deallocate_raw(void* ptr) { give_back(reinterpret_cast<block*>(ptr)); }
+    // 修改保留的空闲块组数, 多余的立即释放
+    void set_retention(size_t retained) {
+        retained_chunks = retained;
+        while (empty.count > retained_chunks) {
+            chunk_header* c = empty.head;
+            list_remove(empty, c);
+            delete_chunk(c);
+        }
+    }
+    // 把存活率不超过max_occupancy的块组中的对象搬移到较满的块组.
+    // relocate(DT* from, DT* to)负责在to处构造对象(通常为移动构造),
+    // 析构from, 并更新所有指向from的引用. 返回搬移的对象数
+    template <typename relocate_function>
+    size_t compact(relocate_function&& relocate, float max_occupancy = 0.25f) {
+        std::vector<chunk_header*> chunks;
+        chunks.reserve(partial.count);
+        for (chunk_header* c = partial.head; c; c = c->next)
+            chunks.push_back(c);
+        // 由稀到密排序: 从前端搬出, 向后端搬入
+        std::sort(chunks.begin(), chunks.end(),
+                  [](const chunk_header* a, const chunk_header* b) {
+                      return a->live < b->live;
+                  });
+        const size_t threshold =
+            static_cast<size_t>(max_occupancy * chunk_capacity);
+        size_t moved = 0, src = 0, dst = chunks.size();
+        while (src + 1 < dst) {
+            chunk_header* s = chunks[src];
+            if (s->live > threshold)
+                break;
+            chunk_header* d = chunks[dst - 1];
+            if (d->live == chunk_capacity) {
+                dst--;
+                continue;
+            }
+            // 取出源块组中的一个存活对象
+            size_t word = 0;
+            while (bitmap(s)[word] == 0)
+                word++;
+            size_t index = word * 64 + __builtin_ctzll(bitmap(s)[word]);
+            block* from = &blocks(s)[index];
+            block* to = take(d);
+            relocate(reinterpret_cast<DT*>(from->data),
+                     reinterpret_cast<DT*>(to->data));
+            moved++;
+            bool last = s->live == 1;
+            give_back(from);  // 源块组可能在此被释放
+            if (last)
+                src++;
+        }
+        return moved;
     }
+    size_t live_count() const { return live_total; }
+    size_t chunk_count() const {
+        return partial.count + full.count + empty.count;
+    }
+    size_t empty_chunk_count() const { return empty.count; }
+    // 所有块组占用的字节数
+    size_t memory_size() const { return chunk_count() * chunk_bytes; }
+    // 未释放的对象不会被析构
     ~object_pool() {
-        obj_chunk *p = chunk_head,* q;
-        while (!p) {
+        for (chunk_list* l : {&partial, &full, &empty}) {
+            chunk_header* c = l->head;
+            while (c) {
+                chunk_header* n = c->next;
+                delete_chunk(c);
+                c = n;
+            }
+        }
+    }
+};
+
+///////////////////////////////////////////////
+// 按大小分级的对象池
+//
+// 每个大小级别(16, 32, 64, ... max_size_class字节)使用一个object_pool,
+// 对象按大小向上取整到所在级别, 同一级别的对象分配在同一组块组中连续存放.
+// 超过max_size_class的对象直接从堆上分配. 释放时需要给出分配时的大小.
+// 对齐要求不能超过alignof(std::max_align_t).
+//
+const size_t min_size_class = 16;
+const size_t max_size_class = 4096;
+
+template <size_t chunk_bytes = 16384>
+class size_class_pool {
+    template <size_t N>
+    struct alignas(std::max_align_t) sized_block {
+        unsigned char data[N];
+    };
+    // 每个块组至少容纳4个对象
+    template <size_t N>
+    using class_pool =
+        object_pool<sized_block<N>, (chunk_bytes / N > 4 ? chunk_bytes / N : 4)>;
+    template <typename sequence>
+    struct pool_tuple;
+    template <size_t... I>
+    struct pool_tuple<std::index_sequence<I...>> {
+        typedef std::tuple<class_pool<(min_size_class << I)>...> type;
+    };
+    static constexpr size_t class_count = [] {
+        size_t n = 0;
+        for (size_t s = min_size_class; s <= max_size_class; s *= 2)
+            n++;
+        return n;
+    }();
+    typedef std::make_index_sequence<class_count> class_indices;
+    typename pool_tuple<class_indices>::type pools;
+
+    template <size_t... I>
+    static auto make_pools(std::index_sequence<I...>) {
+        return typename pool_tuple<class_indices>::type(
+            (static_cast<void>(I), size_t(0))...);
+    }
+    // 调用f(第index级的对象池)
+    template <typename function, size_t... I>
+    void visit(size_t index, function&& f, std::index_sequence<I...>) {
+        static_cast<void>(
+            ((I == index ? (f(std::get<I>(pools)), true) : false) || ...));
+    }
+
+   public:
+    size_class_pool() : pools(make_pools(class_indices{})) {}
+    size_class_pool(const size_class_pool&) = delete;
+    size_class_pool& operator=(const size_class_pool&) = delete;
+
+    // 大小所在的级别, 超过max_size_class时返回class_count
+    static size_t size_class(size_t size) {
+        size_t index = 0;
+        for (size_t s = min_size_class; s < size; s *= 2) {
+            if (++index == class_count)
+                break;
+        }
+        return index;
+    }
+    void* allocate(size_t size) {
+        size_t index = size_class(size);
+        if (index == class_count)
+            return ::operator new(size);
+        void* ptr = nullptr;
+        visit(index, [&ptr](auto& pool) { ptr = pool.allocate(); },
+              class_indices{});
+        return ptr;
+    }
+    // size必须与分配时相同
+    void deallocate(void* ptr, size_t size) {
+        size_t index = size_class(size);
+        if (index == class_count) {
+            ::operator delete(ptr);
+            return;
+        }
+        visit(index, [ptr](auto& pool) { pool.deallocate_raw(ptr); },
+              class_indices{});
+    }
+    template <typename T, typename... arguments>
+    T* construct(arguments&&... args) {
+        static_assert(alignof(T) <= alignof(std::max_align_t),
+                      "Type alignment is too large for size_class_pool.");
+        void* ptr = allocate(sizeof(T));
+        try {
+            return new (ptr) T(std::forward<arguments>(args)...);
+        } catch (...) {
+            deallocate(ptr, sizeof(T));
+            throw;
+        }
+    }
+    template <typename T>
+    void destroy(T* ptr) {
+        ptr->~T();
+        deallocate(ptr, sizeof(T));
+    }
+    // 所有级别中存活的对象数(不含直接从堆上分配的对象)
+    size_t live_count() {
+        size_t n = 0;
+        for (size_t i = 0; i < class_count; i++)
+            visit(i, [&n](auto& pool) { n += pool.live_count(); },
+                  class_indices{});
+        return n;
+    }
+    size_t memory_size() {
+        size_t n = 0;
+        for (size_t i = 0; i < class_count; i++)
+            visit(i, [&n](auto& pool) { n += pool.memory_size(); },
+                  class_indices{});
+        return n;
+    }
+};
+
+///////////////////////////////////////////////
+// 线程缓存的并发对象池
+//
+// 每个线程在每个池中有一个私有的空闲块缓存(magazine), 分配/释放只访问它.
+// 缓存空时从全局仓库取一批(magazine_size个)块, 缓存满(2*magazine_size)时
+// 归还一批; 仓库是以批为单位的无锁栈(指针低48位 + 16位版本号防止ABA),
+// 只有新建块组时才加锁. 块不区分来源线程, 一个线程分配的对象可以在任意线程释放.
+// 线程序号在线程退出时回收, 复用序号的线程继承其缓存.
+// 序号超过concurrent_pool_max_threads的线程共用一个加锁的缓存.
+// 块组在池析构时才释放.
+//
+const uint32_t concurrent_pool_max_threads = 64;
+
+namespace concurrent_pool_detail {
+// 进程内线程序号的分配与回收
+class thread_slots {
+    std::mutex mut;
+    std::vector<uint32_t> released;
+    uint32_t next = 0;
+
+   public:
+    uint32_t acquire() {
+        std::lock_guard<std::mutex> lk(mut);
+        if (!released.empty()) {
+            uint32_t id = released.back();
+            released.pop_back();
+            return id;
+        }
+        return next++;
+    }
+    void release(uint32_t id) {
+        std::lock_guard<std::mutex> lk(mut);
+        released.push_back(id);
+    }
+};
+inline thread_slots& global_thread_slots() {
+    static thread_slots slots;
+    return slots;
+}
+struct thread_slot {
+    uint32_t id;
+    thread_slot() : id(global_thread_slots().acquire()) {}
+    ~thread_slot() { global_thread_slots().release(id); }
+};
+inline uint32_t current_thread_slot() {
+    thread_local thread_slot slot;
+    return slot.id;
+}
+}  // namespace concurrent_pool_detail
+
+template <typename DT, size_t chunk_size = 1024, size_t magazine_size = 32>
+class concurrent_object_pool {
+    static_assert(sizeof(void*) == 8, "仓库的版本号依赖64位指针");
+    static_assert(chunk_size % magazine_size == 0,
+                  "chunk_size必须是magazine_size的整数倍");
+
+   private:
+    union block {
+        struct {
+            block* next;        // 批内的下一个块
+            block* next_batch;  // 仓库中的下一批(仅批首块)
+        } link;
+        alignas(DT) unsigned char data[sizeof(DT)];
+    };
+    struct obj_chunk {
+        obj_chunk* next;
+        block blocks[chunk_size];
+    };
+    struct alignas(64) thread_cache {
+        size_t count = 0;
+        block* blocks[2 * magazine_size];
+    };
+    static constexpr uint64_t pointer_mask = (1ULL << 48) - 1;
+
+    thread_cache caches[concurrent_pool_max_threads];
+    thread_cache shared_cache;  // 序号超出范围的线程共用
+    std::mutex shared_mut;
+    alignas(64) std::atomic<uint64_t> depot;  // 批首块指针 | 版本号<<48
+    std::mutex chunk_mut;
+    obj_chunk* chunk_head;
+
+    static block* unpack(uint64_t v) {
+        return reinterpret_cast<block*>(static_cast<uintptr_t>(v & pointer_mask));
+    }
+    void push_batch(block* head) {
+        uint64_t old = depot.load(std::memory_order_relaxed);
+        uint64_t tagged;
+        do {
+            head->link.next_batch = unpack(old);
+            tagged = reinterpret_cast<uintptr_t>(head) |
+                     ((old & ~pointer_mask) + (1ULL << 48));
+        } while (!depot.compare_exchange_weak(old, tagged,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+    }
+    block* pop_batch() {
+        uint64_t old = depot.load(std::memory_order_acquire);
+        while (true) {
+            block* head = unpack(old);
+            if (!head)
+                return nullptr;
+            // 块组不会在池析构前释放, 即使head已被其他线程取走, 读取也是安全的;
+            // 此时版本号已改变, CAS失败后重试
+            uint64_t tagged = reinterpret_cast<uintptr_t>(head->link.next_batch) |
+                              ((old & ~pointer_mask) + (1ULL << 48));
+            if (depot.compare_exchange_weak(old, tagged,
+                                            std::memory_order_acquire,
+                                            std::memory_order_acquire))
+                return head;
+        }
+    }
+    // 新建块组: 第一批直接放入缓存, 其余的批放入仓库
+    void grow(thread_cache& cache) {
+        obj_chunk* p = (obj_chunk*)malloc(sizeof(obj_chunk));
+        if (!p)
+            throw std::bad_alloc();
+        {
+            std::lock_guard<std::mutex> lk(chunk_mut);
+            p->next = chunk_head;
+            chunk_head = p;
+        }
+        for (size_t i = 0; i < magazine_size; i++) {
+            cache.blocks[cache.count++] = &p->blocks[i];
+        }
+        for (size_t b = magazine_size; b < chunk_size; b += magazine_size) {
+            for (size_t i = 0; i < magazine_size - 1; i++) {
+                p->blocks[b + i].link.next = &p->blocks[b + i + 1];
+            }
+            p->blocks[b + magazine_size - 1].link.next = nullptr;
+            push_batch(&p->blocks[b]);
+        }
+    }
+    void refill(thread_cache& cache) {
+        block* b = pop_batch();
+        if (!b) {
+            grow(cache);
+            return;
+        }
+        while (b) {
+            cache.blocks[cache.count++] = b;
+            b = b->link.next;
+        }
+    }
+    // 缓存满时把最早放入的一批归还仓库
+    void flush(thread_cache& cache) {
+        for (size_t i = 0; i < magazine_size - 1; i++) {
+            cache.blocks[i]->link.next = cache.blocks[i + 1];
+        }
+        cache.blocks[magazine_size - 1]->link.next = nullptr;
+        push_batch(cache.blocks[0]);
+        for (size_t i = magazine_size; i < cache.count; i++) {
+            cache.blocks[i - magazine_size] = cache.blocks[i];
+        }
+        cache.count -= magazine_size;
+    }
+    block* pop_block(thread_cache& cache) {
+        if (cache.count == 0)
+            refill(cache);
+        return cache.blocks[--cache.count];
+    }
+    void push_block(thread_cache& cache, block* b) {
+        if (cache.count == 2 * magazine_size)
+            flush(cache);
+        cache.blocks[cache.count++] = b;
+    }
+    void* allocate_block() {
+        uint32_t id = concurrent_pool_detail::current_thread_slot();
+        if (id < concurrent_pool_max_threads)
+            return pop_block(caches[id]);
+        std::lock_guard<std::mutex> lk(shared_mut);
+        return pop_block(shared_cache);
+    }
+
+   public:
+    concurrent_object_pool() : depot(0), chunk_head(nullptr) {}
+    concurrent_object_pool(concurrent_object_pool&&) = delete;
+    concurrent_object_pool(const concurrent_object_pool&) = delete;
+    concurrent_object_pool& operator=(concurrent_object_pool&&) = delete;
+    concurrent_object_pool& operator=(const concurrent_object_pool&) = delete;
+    // 未释放的对象不会被析构
+    ~concurrent_object_pool() {
+        obj_chunk *p = chunk_head, *q;
+        while (p) {
             q = p->next;
             free(p);
             p = q;
         }
     }
+
+    template <typename... arguments>
+    DT* emplace_allocate(arguments&&... args) {
+        void* p = allocate_block();
+        try {
+            return new (p) DT(std::forward<arguments>(args)...);
+        } catch (...) {
+            deallocate_raw(p);
+            throw;
+        }
+    }
+    // 只分配内存, 不构造对象
+    DT* allocate() { return reinterpret_cast<DT*>(allocate_block()); }
+    // 析构对象并释放
+    void deallocate(DT* ptr) {
+        ptr->~DT();
+        deallocate_raw(ptr);
+    }
+    // 只释放内存, 不析构对象
+    void deallocate_raw(void* ptr) {
+        uint32_t id = concurrent_pool_detail::current_thread_slot();
+        if (id < concurrent_pool_max_threads) {
+            push_block(caches[id], reinterpret_cast<block*>(ptr));
+            return;
+        }
+        std::lock_guard<std::mutex> lk(shared_mut);
+        push_block(shared_cache, reinterpret_cast<block*>(ptr));
+    }
+};
+
+///////////////////////////////////////////////
+// 分代槽位表
+//
+// 句柄为32位槽位序号 + 32位代数, 删除对象时槽位的代数加一, 旧句柄随之失效.
+// 存活的对象紧密存放在连续数组中(删除时以末尾的对象填补空位), 可以线性遍历;
+// 插入, 删除, 有效性检查均为O(1).
+// 插入和删除会移动对象, 需要长期引用时保存句柄而不是指针.
+//
+struct slot_handle {
+    uint32_t index;
+    uint32_t generation;  // 0表示空句柄
+
+    bool operator==(const slot_handle&) const = default;
+    explicit operator bool() const { return generation != 0; }
+};
+const slot_handle null_slot_handle = {0, 0};
+
+template <typename T>
+class slot_map {
+    struct slot {
+        uint32_t position;    // 使用中: 对象在values中的位置; 空闲: 下一个空闲槽位
+        uint32_t generation;  // 当前(或下一次分配时)的代数
+    };
+    static constexpr uint32_t none = 0xFFFFFFFF;
+
+    std::vector<T> values;
+    std::vector<uint32_t> value_slots;  // values中的位置 -> 槽位
+    std::vector<slot> slots;
+    uint32_t free_head;
+
+   public:
+    slot_map() : free_head(none) {}
+
+    template <typename... arguments>
+    slot_handle emplace(arguments&&... args) {
+        uint32_t index = free_head;
+        if (index == none) {
+            index = static_cast<uint32_t>(slots.size());
+            slots.push_back({none, 1});
+        }
+        values.emplace_back(std::forward<arguments>(args)...);
+        try {
+            value_slots.push_back(index);
+        } catch (...) {
+            values.pop_back();
+            throw;
+        }
+        if (index == free_head)
+            free_head = slots[index].position;
+        slots[index].position = static_cast<uint32_t>(values.size() - 1);
+        return {index, slots[index].generation};
+    }
+    slot_handle insert(const T& value) { return emplace(value); }
+    slot_handle insert(T&& value) { return emplace(std::move(value)); }
+    // 删除对象, 句柄无效时返回false
+    bool erase(slot_handle h) {
+        if (!contains(h))
+            return false;
+        uint32_t pos = slots[h.index].position;
+        uint32_t last = static_cast<uint32_t>(values.size() - 1);
+        if (pos != last) {
+            values[pos] = std::move(values[last]);
+            value_slots[pos] = value_slots[last];
+            slots[value_slots[pos]].position = pos;
+        }
+        values.pop_back();
+        value_slots.pop_back();
+        slot& sl = slots[h.index];
+        sl.generation = sl.generation + 1 == 0 ? 1 : sl.generation + 1;
+        sl.position = free_head;
+        free_head = h.index;
+        return true;
+    }
+    bool contains(slot_handle h) const {
+        return h.index < slots.size() && h.generation != 0 &&
+               slots[h.index].generation == h.generation &&
+               slots[h.index].position < values.size() &&
+               value_slots[slots[h.index].position] == h.index;
+    }
+    // 句柄无效时返回nullptr
+    T* get(slot_handle h) {
+        return contains(h) ? &values[slots[h.index].position] : nullptr;
+    }
+    const T* get(slot_handle h) const {
+        return contains(h) ? &values[slots[h.index].position] : nullptr;
+    }
+    // values中第pos个对象的句柄
+    slot_handle handle_at(size_t pos) const {
+        uint32_t index = value_slots[pos];
+        return {index, slots[index].generation};
+    }
+    void clear() {
+        for (size_t i = 0; i < value_slots.size(); i++) {
+            slot& sl = slots[value_slots[i]];
+            sl.generation = sl.generation + 1 == 0 ? 1 : sl.generation + 1;
+            sl.position = free_head;
+            free_head = value_slots[i];
+        }
+        values.clear();
+        value_slots.clear();
+    }
+    void reserve(size_t count) {
+        values.reserve(count);
+        value_slots.reserve(count);
+    }
+    size_t size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+    T* data() { return values.data(); }
+    const T* data() const { return values.data(); }
+    T* begin() { return values.data(); }
+    T* end() { return values.data() + values.size(); }
+    const T* begin() const { return values.data(); }
+    const T* end() const { return values.data() + values.size(); }
+};
+///////////////////////////////////////////////
+// 开放寻址哈希表(flat_hash_map/flat_hash_set)
+//
+// 元素直接存放在一个连续数组中, 另有一个控制字节数组: 空位, 已删除, 或
+// 已占用(存放哈希值的低7位h2). 查找时按16字节一组用SSE2同时比较一组控制字节,
+// 只对h2相同的位置比较键, 遇到含空位的组即可结束. 容量为2^n-1, 最大负载7/8.
+// 哈希值的高位(h1)决定起始组, 组间按三角数步长探测.
+// 插入可能导致重新分配, 之后所有迭代器和指针失效; 删除不移动其他元素.
+// Hash和Eq都带is_transparent时支持异构查找(如以std::string_view查找std::string).
+// 带hash参数的函数使用预先计算的hash_function()(key), 避免重复计算字符串哈希.
+//
+// 默认哈希: std::string按std::string_view计算, 支持异构查找
+template <typename T>
+struct flat_hash : std::hash<T> {};
+template <>
+struct flat_hash<std::string> {
+    typedef void is_transparent;
+    size_t operator()(std::string_view s) const noexcept {
+        return std::hash<std::string_view>()(s);
+    }
+};
+
+namespace flat_hash_detail {
+typedef int8_t ctrl_t;
+const ctrl_t ctrl_empty = -128;
+const ctrl_t ctrl_deleted = -2;
+const ctrl_t ctrl_sentinel = -1;
+const size_t group_width = 16;
+const size_t cloned_bytes = group_width - 1;
+
+// 16个控制字节, 各match函数返回匹配位置的位掩码
+struct group {
+#ifdef __SSE2__
+    __m128i ctrl;
+    explicit group(const ctrl_t* p)
+        : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+    uint32_t match(ctrl_t h) const {
+        return static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h), ctrl)));
+    }
+    uint32_t match_empty() const { return match(ctrl_empty); }
+    // 空位和已删除都小于ctrl_sentinel
+    uint32_t match_empty_or_deleted() const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), ctrl)));
+    }
+#else
+    ctrl_t ctrl[group_width];
+    explicit group(const ctrl_t* p) { std::memcpy(ctrl, p, group_width); }
+    uint32_t match(ctrl_t h) const {
+        uint32_t m = 0;
+        for (size_t i = 0; i < group_width; i++)
+            m |= static_cast<uint32_t>(ctrl[i] == h) << i;
+        return m;
+    }
+    uint32_t match_empty() const { return match(ctrl_empty); }
+    uint32_t match_empty_or_deleted() const {
+        uint32_t m = 0;
+        for (size_t i = 0; i < group_width; i++)
+            m |= static_cast<uint32_t>(ctrl[i] < ctrl_sentinel) << i;
+        return m;
+    }
+#endif
+};
+// 空表共用的控制字节, 查找在第一组就遇到空位
+inline ctrl_t* empty_ctrl() {
+    alignas(16) static const ctrl_t bytes[group_width] = {
+        ctrl_sentinel, ctrl_empty, ctrl_empty, ctrl_empty,
+        ctrl_empty,    ctrl_empty, ctrl_empty, ctrl_empty,
+        ctrl_empty,    ctrl_empty, ctrl_empty, ctrl_empty,
+        ctrl_empty,    ctrl_empty, ctrl_empty, ctrl_empty};
+    return const_cast<ctrl_t*>(bytes);
+}
+// 打散哈希值的各位(std::hash对整数是恒等映射)
+inline size_t mix(size_t h) {
+    uint64_t x = static_cast<uint64_t>(h);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return static_cast<size_t>(x);
+}
+inline uint32_t trailing_zeros(uint32_t m) {
+    return static_cast<uint32_t>(__builtin_ctz(m));
+}
+
+struct set_policy {
+    template <typename T>
+    static const T& key(const T& v) {
+        return v;
+    }
+};
+struct map_policy {
+    template <typename T>
+    static const auto& key(const T& v) {
+        return v.first;
+    }
+};
+
+template <typename slot_type,
+          typename key_type,
+          typename policy,
+          typename hasher,
+          typename key_equal>
+class raw_hash_table {
+   protected:
+    ctrl_t* ctrl;
+    slot_type* slots;
+    size_t capacity;     // 2^n-1, 空表为0
+    size_t count;
+    size_t growth_left;  // 再插入多少个元素需要扩容(已删除的位置不计入)
+    [[no_unique_address]] hasher hash;
+    [[no_unique_address]] key_equal eq;
+
+    static constexpr bool transparent = requires {
+        typename hasher::is_transparent;
+        typename key_equal::is_transparent;
+    };
+    template <typename Q>
+    static constexpr bool lookup_key =
+        transparent || std::is_same_v<std::remove_cvref_t<Q>, key_type>;
+
+    static size_t max_growth(size_t cap) { return cap - cap / 8; }
+    static size_t ctrl_bytes(size_t cap) {
+        return (cap + 1 + cloned_bytes + alignof(slot_type) - 1) /
+               alignof(slot_type) * alignof(slot_type);
+    }
+    static constexpr size_t storage_align =
+        alignof(slot_type) > 16 ? alignof(slot_type) : 16;
+    // 写控制字节, 前cloned_bytes个同时写入末尾的副本
+    void set_ctrl(size_t i, ctrl_t h) {
+        ctrl[i] = h;
+        ctrl[((i - cloned_bytes) & capacity) + (cloned_bytes & capacity)] = h;
+    }
+    size_t find_index(const auto& key, size_t h) const {
+        const ctrl_t h2 = static_cast<ctrl_t>(h & 0x7F);
+        size_t offset = (h >> 7) & capacity, step = 0;
+        while (true) {
+            group g(ctrl + offset);
+            for (uint32_t m = g.match(h2); m; m &= m - 1) {
+                size_t i = (offset + trailing_zeros(m)) & capacity;
+                if (eq(policy::key(slots[i]), key))
+                    return i;
+            }
+            if (g.match_empty())
+                return capacity;  // 未找到, 返回end()的位置
+            step += group_width;
+            offset = (offset + step) & capacity;
+        }
+    }
+    size_t find_free(size_t h) const {
+        size_t offset = (h >> 7) & capacity, step = 0;
+        while (true) {
+            uint32_t m = group(ctrl + offset).match_empty_or_deleted();
+            if (m)
+                return (offset + trailing_zeros(m)) & capacity;
+            step += group_width;
+            offset = (offset + step) & capacity;
+        }
+    }
+    void resize(size_t new_capacity) {
+        ctrl_t* old_ctrl = ctrl;
+        slot_type* old_slots = slots;
+        size_t old_capacity = capacity;
+        const size_t cb = ctrl_bytes(new_capacity);
+        void* mem = ::operator new(cb + sizeof(slot_type) * new_capacity,
+                                   std::align_val_t(storage_align));
+        ctrl = static_cast<ctrl_t*>(mem);
+        slots = reinterpret_cast<slot_type*>(static_cast<char*>(mem) + cb);
+        capacity = new_capacity;
+        std::memset(ctrl, ctrl_empty, capacity + 1 + cloned_bytes);
+        ctrl[capacity] = ctrl_sentinel;
+        growth_left = max_growth(capacity) - count;
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (old_ctrl[i] >= 0) {
+                size_t h = mix(hash(policy::key(old_slots[i])));
+                size_t j = find_free(h);
+                set_ctrl(j, static_cast<ctrl_t>(h & 0x7F));
+                new (slots + j) slot_type(std::move(old_slots[i]));
+                old_slots[i].~slot_type();
+            }
+        }
+        if (old_capacity)
+            ::operator delete(old_ctrl, std::align_val_t(storage_align));
+    }
+    // 没有空余位置时扩容; 已删除的位置过多时以相同容量重建
+    void prepare_insert() {
+        if (growth_left > 0)
+            return;
+        if (capacity && count <= max_growth(capacity) / 2)
+            resize(capacity);
+        else
+            resize(capacity ? capacity * 2 + 1 : group_width - 1);
+    }
+    // 返回键所在的位置, 不存在时返回一个已标记为占用但未构造的位置
+    std::pair<size_t, bool> find_or_prepare(const auto& key, size_t hashed) {
+        const size_t h = mix(hashed);
+        size_t i = find_index(key, h);
+        if (i != capacity)
+            return {i, false};
+        prepare_insert();
+        i = find_free(h);
+        growth_left -= ctrl[i] == ctrl_empty;
+        set_ctrl(i, static_cast<ctrl_t>(h & 0x7F));
+        count++;
+        return {i, true};
+    }
+    // 构造失败时撤销find_or_prepare()
+    void abandon(size_t i) {
+        set_ctrl(i, ctrl_deleted);
+        count--;
+    }
+    void erase_at(size_t i) {
+        slots[i].~slot_type();
+        count--;
+        // 所在的组与前一组之间没有连续占满时, 探测不会越过这里, 可以直接置空
+        size_t before = (i - group_width) & capacity;
+        uint32_t empty_after = group(ctrl + i).match_empty();
+        uint32_t empty_before = group(ctrl + before).match_empty();
+        bool was_never_full =
+            empty_before && empty_after &&
+            trailing_zeros(empty_after) + (__builtin_clz(empty_before) - 16) <
+                group_width;
+        if (was_never_full) {
+            set_ctrl(i, ctrl_empty);
+            growth_left++;
+        } else {
+            set_ctrl(i, ctrl_deleted);
+        }
+    }
+    void destroy_all() {
+        if (!std::is_trivially_destructible_v<slot_type>) {
+            for (size_t i = 0; i < capacity; i++)
+                if (ctrl[i] >= 0)
+                    slots[i].~slot_type();
+        }
+    }
+    void release() {
+        destroy_all();
+        if (capacity)
+            ::operator delete(ctrl, std::align_val_t(storage_align));
+        ctrl = empty_ctrl();
+        slots = nullptr;
+        capacity = count = growth_left = 0;
+    }
+
+   public:
+    template <bool is_const>
+    class basic_iterator {
+        friend class raw_hash_table;
+        template <bool>
+        friend class basic_iterator;
+        const ctrl_t* c;
+        slot_type* s;
+        basic_iterator(const ctrl_t* c, slot_type* s) : c(c), s(s) {
+            skip();
+        }
+        // 跳过空位和已删除, 停在占用位置或末尾的ctrl_sentinel
+        void skip() {
+            while (*c < ctrl_sentinel) {
+                c++;
+                s++;
+            }
+        }
+
+       public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef slot_type value_type;
+        typedef ptrdiff_t difference_type;
+        typedef std::conditional_t<is_const, const slot_type, slot_type>&
+            reference;
+        typedef std::conditional_t<is_const, const slot_type, slot_type>*
+            pointer;
+
+        basic_iterator() : c(nullptr), s(nullptr) {}
+        operator basic_iterator<true>() const { return {c, s}; }
+        reference operator*() const { return *s; }
+        pointer operator->() const { return s; }
+        basic_iterator& operator++() {
+            c++;
+            s++;
+            skip();
+            return *this;
+        }
+        basic_iterator operator++(int) {
+            basic_iterator t = *this;
+            ++*this;
+            return t;
+        }
+        bool operator==(const basic_iterator& o) const { return c == o.c; }
+    };
+    typedef basic_iterator<false> iterator;
+    typedef basic_iterator<true> const_iterator;
+
+   protected:
+    iterator iterator_at(size_t i) { return {ctrl + i, slots + i}; }
+
+   public:
+
+    raw_hash_table()
+        : ctrl(empty_ctrl()),
+          slots(nullptr),
+          capacity(0),
+          count(0),
+          growth_left(0) {}
+    raw_hash_table(const raw_hash_table& other) : raw_hash_table() {
+        hash = other.hash;
+        eq = other.eq;
+        reserve(other.count);
+        for (const slot_type& v : other) {
+            size_t h = mix(hash(policy::key(v)));
+            size_t i = find_free(h);
+            set_ctrl(i, static_cast<ctrl_t>(h & 0x7F));
+            new (slots + i) slot_type(v);
+            count++;
+            growth_left--;
+        }
+    }
+    raw_hash_table(raw_hash_table&& other) noexcept
+        : ctrl(other.ctrl),
+          slots(other.slots),
+          capacity(other.capacity),
+          count(other.count),
+          growth_left(other.growth_left),
+          hash(std::move(other.hash)),
+          eq(std::move(other.eq)) {
+        other.ctrl = empty_ctrl();
+        other.slots = nullptr;
+        other.capacity = other.count = other.growth_left = 0;
+    }
+    raw_hash_table& operator=(const raw_hash_table& other) {
+        if (this != &other) {
+            raw_hash_table t(other);
+            *this = std::move(t);
+        }
+        return *this;
+    }
+    raw_hash_table& operator=(raw_hash_table&& other) noexcept {
+        if (this != &other) {
+            release();
+            std::swap(ctrl, other.ctrl);
+            std::swap(slots, other.slots);
+            std::swap(capacity, other.capacity);
+            std::swap(count, other.count);
+            std::swap(growth_left, other.growth_left);
+            hash = std::move(other.hash);
+            eq = std::move(other.eq);
+        }
+        return *this;
+    }
+    ~raw_hash_table() { release(); }
+
+    iterator begin() { return {ctrl, slots}; }
+    iterator end() { return {ctrl + capacity, slots + capacity}; }
+    const_iterator begin() const { return {ctrl, slots}; }
+    const_iterator end() const { return {ctrl + capacity, slots + capacity}; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t bucket_count() const { return capacity; }
+    float load_factor() const {
+        return capacity ? static_cast<float>(count) / capacity : 0.0f;
+    }
+    const hasher& hash_function() const { return hash; }
+    const key_equal& key_eq() const { return eq; }
+    void clear() {
+        if (count == 0)
+            return;
+        destroy_all();
+        std::memset(ctrl, ctrl_empty, capacity + 1 + cloned_bytes);
+        ctrl[capacity] = ctrl_sentinel;
+        count = 0;
+        growth_left = max_growth(capacity);
+    }
+    // 保证插入n个元素之前不会重新分配
+    void reserve(size_t n) {
+        if (n <= count + growth_left)
+            return;
+        size_t cap = group_width - 1;
+        while (max_growth(cap) < n)
+            cap = cap * 2 + 1;
+        resize(cap);
+    }
+
+    template <typename Q>
+        requires lookup_key<Q>
+    iterator find(const Q& key, size_t hashed) {
+        size_t i = find_index(key, mix(hashed));
+        return {ctrl + i, slots + i};
+    }
+    template <typename Q>
+        requires lookup_key<Q>
+    const_iterator find(const Q& key, size_t hashed) const {
+        size_t i = find_index(key, mix(hashed));
+        return {ctrl + i, slots + i};
+    }
+    template <typename Q>
+        requires lookup_key<Q>
+    iterator find(const Q& key) {
+        return find(key, hash(key));
+    }
+    template <typename Q>
+        requires lookup_key<Q>
+    const_iterator find(const Q& key) const {
+        return find(key, hash(key));
+    }
+    template <typename Q>
+        requires lookup_key<Q>
+    bool contains(const Q& key, size_t hashed) const {
+        return find_index(key, mix(hashed)) != capacity;
+    }
+    template <typename Q>
+        requires lookup_key<Q>
+    bool contains(const Q& key) const {
+        return contains(key, hash(key));
+    }
+    void erase(const_iterator it) { erase_at(it.s - slots); }
+    template <typename Q>
+        requires lookup_key<Q>
+    size_t erase(const Q& key) {
+        size_t i = find_index(key, mix(hash(key)));
+        if (i == capacity)
+            return 0;
+        erase_at(i);
+        return 1;
+    }
+};
+}  // namespace flat_hash_detail
+
+template <typename K,
+          typename Hash = flat_hash<K>,
+          typename Eq = std::equal_to<>>
+class flat_hash_set
+    : public flat_hash_detail::
+          raw_hash_table<K, K, flat_hash_detail::set_policy, Hash, Eq> {
+    typedef flat_hash_detail::
+        raw_hash_table<K, K, flat_hash_detail::set_policy, Hash, Eq>
+            base;
+
+   public:
+    typedef K key_type;
+    typedef K value_type;
+    using typename base::const_iterator;
+    using typename base::iterator;
+
+    flat_hash_set() = default;
+    flat_hash_set(std::initializer_list<K> list) {
+        this->reserve(list.size());
+        for (const K& k : list)
+            insert(k);
+    }
+    // 插入预先计算了哈希值的键
+    template <typename Q>
+        requires base::template lookup_key<Q>
+    std::pair<iterator, bool> insert_hashed(size_t hashed, Q&& key) {
+        auto [i, inserted] = this->find_or_prepare(key, hashed);
+        if (inserted) {
+            try {
+                new (this->slots + i) K(std::forward<Q>(key));
+            } catch (...) {
+                this->abandon(i);
+                throw;
+            }
+        }
+        return {this->iterator_at(i), inserted};
+    }
+    std::pair<iterator, bool> insert(const K& key) {
+        return insert_hashed(this->hash(key), key);
+    }
+    std::pair<iterator, bool> insert(K&& key) {
+        size_t h = this->hash(key);
+        return insert_hashed(h, std::move(key));
+    }
+    template <typename... arguments>
+    std::pair<iterator, bool> emplace(arguments&&... args) {
+        return insert(K(std::forward<arguments>(args)...));
+    }
+    template <typename Q>
+        requires base::template lookup_key<Q>
+    size_t count(const Q& key) const {
+        return this->contains(key);
+    }
+};
+
+template <typename K,
+          typename V,
+          typename Hash = flat_hash<K>,
+          typename Eq = std::equal_to<>>
+class flat_hash_map : public flat_hash_detail::raw_hash_table<
+                          std::pair<K, V>,
+                          K,
+                          flat_hash_detail::map_policy,
+                          Hash,
+                          Eq> {
+    typedef flat_hash_detail::
+        raw_hash_table<std::pair<K, V>, K, flat_hash_detail::map_policy, Hash, Eq>
+            base;
+
+   public:
+    typedef K key_type;
+    typedef V mapped_type;
+    // 元素中的键不可修改, 否则哈希表损坏
+    typedef std::pair<K, V> value_type;
+    using typename base::const_iterator;
+    using typename base::iterator;
+
+    flat_hash_map() = default;
+    flat_hash_map(std::initializer_list<value_type> list) {
+        this->reserve(list.size());
+        for (const value_type& v : list)
+            insert(v);
+    }
+    // 键不存在时以args构造值; Q可以是能构造K的异构键
+    template <typename Q, typename... arguments>
+        requires base::template lookup_key<Q>
+    std::pair<iterator, bool> try_emplace_hashed(size_t hashed,
+                                                 Q&& key,
+                                                 arguments&&... args) {
+        auto [i, inserted] = this->find_or_prepare(key, hashed);
+        if (inserted) {
+            try {
+                new (this->slots + i) value_type(
+                    std::piecewise_construct,
+                    std::forward_as_tuple(K(std::forward<Q>(key))),
+                    std::forward_as_tuple(std::forward<arguments>(args)...));
+            } catch (...) {
+                this->abandon(i);
+                throw;
+            }
+        }
+        return {this->iterator_at(i), inserted};
+    }
+    template <typename Q, typename... arguments>
+        requires base::template lookup_key<Q>
+    std::pair<iterator, bool> try_emplace(Q&& key, arguments&&... args) {
+        size_t h = this->hash(key);
+        return try_emplace_hashed(h, std::forward<Q>(key),
+                                  std::forward<arguments>(args)...);
+    }
+    std::pair<iterator, bool> insert(const value_type& v) {
+        return try_emplace(v.first, v.second);
+    }
+    std::pair<iterator, bool> insert(value_type&& v) {
+        return try_emplace(std::move(v.first), std::move(v.second));
+    }
+    template <typename Q, typename M>
+        requires base::template lookup_key<Q>
+    std::pair<iterator, bool> insert_or_assign(Q&& key, M&& value) {
+        auto res = try_emplace(std::forward<Q>(key), std::forward<M>(value));
+        if (!res.second)
+            res.first->second = std::forward<M>(value);
+        return res;
+    }
+    template <typename Q>
+        requires base::template lookup_key<Q>
+    V& operator[](Q&& key) {
+        return try_emplace(std::forward<Q>(key)).first->second;
+    }
+    template <typename Q>
+        requires base::template lookup_key<Q>
+    V& at(const Q& key) {
+        iterator it = this->find(key);
+        if (it == this->end())
+            throw std::out_of_range("flat_hash_map::at");
+        return it->second;
+    }
+    template <typename Q>
+        requires base::template lookup_key<Q>
+    const V& at(const Q& key) const {
+        const_iterator it = this->find(key);
+        if (it == this->end())
+            throw std::out_of_range("flat_hash_map::at");
+        return it->second;
+    }
+    template <typename Q>
+        requires base::template lookup_key<Q>
+    size_t count(const Q& key) const {
+        return this->contains(key);
+    }
 };
 }  // namespace Boundless
 #endif  //!_BOUNDLESS_DATA_STRUCT_HPP_FILE_
\ No newline at end of file
@@ -0,0 +1,475 @@
+#include "bl_image.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+#define BL_IMAGE_USE_SSE
+#endif
+
+namespace Boundless {
+namespace {
+// 单个输出像素的滤波核: taps[offset[i], offset[i+1])
+struct FilterTap {
+    int32 index;
+    float weight;
+};
+struct FilterTable {
+    std::vector<uint32> offset;
+    std::vector<FilterTap> taps;
+};
+
+const float kaiser_alpha = 4.0f;
+const float kaiser_width = 3.0f;  // 半宽(以输出像素为单位)
+
+float BesselI0(float x) {
+    float sum = 1.0f, term = 1.0f, q = x * x * 0.25f;
+    for (int k = 1; k < 16; k++) {
+        term *= q / static_cast<float>(k * k);
+        sum += term;
+    }
+    return sum;
+}
+float KaiserSinc(float t) {
+    if (std::abs(t) >= kaiser_width)
+        return 0.0f;
+    float s = t == 0.0f ? 1.0f
+                        : std::sin(static_cast<float>(BL_MATH_PI) * t) /
+                              (static_cast<float>(BL_MATH_PI) * t);
+    float r = t / kaiser_width;
+    return s * BesselI0(kaiser_alpha * std::sqrt(1.0f - r * r)) /
+           BesselI0(kaiser_alpha);
+}
+FilterTable BuildFilter(GLsizei src, GLsizei dst, MipFilter filter) {
+    FilterTable table;
+    table.offset.reserve(dst + 1);
+    float scale = static_cast<float>(src) / dst;
+    std::vector<float> weights(src);
+    for (GLsizei x = 0; x < dst; x++) {
+        table.offset.push_back(static_cast<uint32>(table.taps.size()));
+        std::fill(weights.begin(), weights.end(), 0.0f);
+        int32 lo, hi;
+        if (filter == MipFilter::BOX) {
+            // 输出像素覆盖的源区间[x*s, (x+1)*s]与每个源像素的重叠长度
+            float a = x * scale, b = (x + 1) * scale;
+            lo = static_cast<int32>(std::floor(a));
+            hi = std::min<int32>(static_cast<int32>(std::ceil(b)), src) - 1;
+            for (int32 i = lo; i <= hi; i++) {
+                weights[i] = std::min<float>(b, i + 1.0f) - std::max<float>(a, i);
+            }
+        } else {
+            float center = (x + 0.5f) * scale, radius = kaiser_width * scale;
+            lo = static_cast<int32>(std::floor(center - radius));
+            hi = static_cast<int32>(std::ceil(center + radius));
+            for (int32 i = lo; i <= hi; i++) {
+                float w = KaiserSinc((i + 0.5f - center) / scale);
+                weights[std::clamp<int32>(i, 0, src - 1)] += w;  // 边缘重复
+            }
+            lo = std::max<int32>(0, static_cast<int32>(std::floor(center - radius)));
+            hi = std::min<int32>(src - 1, static_cast<int32>(std::ceil(center + radius)));
+        }
+        float sum = 0.0f;
+        for (int32 i = lo; i <= hi; i++)
+            sum += weights[i];
+        for (int32 i = lo; i <= hi; i++) {
+            if (weights[i] != 0.0f)
+                table.taps.push_back({i, weights[i] / sum});
+        }
+    }
+    table.offset.push_back(static_cast<uint32>(table.taps.size()));
+    return table;
+}
+// dst[0, count) += src[0, count) * w
+inline void RowAxpy(float* dst, const float* src, float w, size_t count) {
+    size_t i = 0;
+#if defined(__AVX__)
+    __m256 w8 = _mm256_set1_ps(w);
+    for (; i + 8 <= count; i += 8) {
+        __m256 d = _mm256_loadu_ps(dst + i);
+        d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_loadu_ps(src + i), w8));
+        _mm256_storeu_ps(dst + i, d);
+    }
+#endif
+#ifdef BL_IMAGE_USE_SSE
+    __m128 w4 = _mm_set1_ps(w);
+    for (; i + 4 <= count; i += 4) {
+        __m128 d = _mm_loadu_ps(dst + i);
+        d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(src + i), w4));
+        _mm_storeu_ps(dst + i, d);
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] += src[i] * w;
+}
+
+// sRGB解码表与编码阈值表
+struct SRGBTables {
+    float decode[256];
+    float threshold[255];  // 相邻两个编码值中点对应的线性值
+    SRGBTables() {
+        auto to_linear = [](float c) {
+            return c <= 0.04045f ? c / 12.92f
+                                 : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        };
+        for (int i = 0; i < 256; i++)
+            decode[i] = to_linear(i / 255.0f);
+        for (int i = 0; i < 255; i++)
+            threshold[i] = to_linear((i + 0.5f) / 255.0f);
+    }
+};
+const SRGBTables& GetSRGBTables() {
+    static const SRGBTables tables;
+    return tables;
+}
+inline Byte EncodeSRGB(const SRGBTables& t, float v) {
+    return static_cast<Byte>(std::upper_bound(t.threshold, t.threshold + 255, v) -
+                             t.threshold);
+}
+inline Byte EncodeUnorm(float v) {
+    return static_cast<Byte>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+// 5位指数, 无符号位的小浮点(R11G11B10F的分量, 半精度去掉符号位)
+// 负数与NaN -> 0, 超出范围钳制到最大值, 最近舍入
+template <int mant_bits>
+constexpr float SmallFloatMax() {
+    return (2.0f - 1.0f / (1 << mant_bits)) * 32768.0f;
+}
+const float small_float_min_normal = 1.0f / 16384.0f;  // 2^-14
+template <int mant_bits>
+inline uint32 PackSmallFloat(float v) {
+    if (!(v > 0.0f))
+        return 0;
+    v = std::min(v, SmallFloatMax<mant_bits>());
+    if (v < small_float_min_normal) {
+        return static_cast<uint32>(
+            std::nearbyint(v * static_cast<float>(1 << (14 + mant_bits))));
+    }
+    uint32 bits;
+    std::memcpy(&bits, &v, sizeof(float));
+    // 舍入后截取指数与尾数, 指数偏置由127改为15
+    return ((bits + (1u << (22 - mant_bits))) >> (23 - mant_bits)) -
+           (112u << mant_bits);
+}
+inline uint32 PackRGB9E5(float r, float g, float b) {
+    const float max_value = 65408.0f;  // (511/512) * 2^16
+    auto clamp = [max_value](float v) {
+        return v > 0.0f ? std::min(v, max_value) : 0.0f;
+    };
+    r = clamp(r);
+    g = clamp(g);
+    b = clamp(b);
+    float m = std::max(r, std::max(g, b));
+    int32 e = std::max<int32>(-16, static_cast<int32>(std::floor(std::log2(
+                                       std::max(m, 1e-30f))))) + 16;
+    float scale = std::ldexp(1.0f, 24 - e);
+    if (static_cast<uint32>(m * scale + 0.5f) == 512) {
+        e++;
+        scale *= 0.5f;
+    }
+    return static_cast<uint32>(r * scale + 0.5f) |
+           static_cast<uint32>(g * scale + 0.5f) << 9 |
+           static_cast<uint32>(b * scale + 0.5f) << 18 |
+           static_cast<uint32>(e) << 27;
+}
+#ifdef BL_IMAGE_USE_SSE
+inline __m128 SelectPS(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+inline __m128i SelectEpi32(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+template <int mant_bits>
+inline __m128i PackSmallFloat4(__m128 v) {
+    v = _mm_max_ps(v, _mm_setzero_ps());  // 第二个操作数在NaN时被返回
+    v = _mm_min_ps(v, _mm_set1_ps(SmallFloatMax<mant_bits>()));
+    __m128i bits = _mm_castps_si128(v);
+    __m128i normal = _mm_sub_epi32(
+        _mm_srli_epi32(_mm_add_epi32(bits, _mm_set1_epi32(1 << (22 - mant_bits))),
+                       23 - mant_bits),
+        _mm_set1_epi32(112 << mant_bits));
+    __m128i denorm = _mm_cvtps_epi32(
+        _mm_mul_ps(v, _mm_set1_ps(static_cast<float>(1 << (14 + mant_bits)))));
+    __m128i is_denorm = _mm_castps_si128(
+        _mm_cmplt_ps(v, _mm_set1_ps(small_float_min_normal)));
+    return SelectEpi32(is_denorm, denorm, normal);
+}
+// 4个像素的RGB -> RGB9E5
+inline __m128i PackRGB9E5x4(__m128 r, __m128 g, __m128 b) {
+    const __m128 zero = _mm_setzero_ps(), max_value = _mm_set1_ps(65408.0f);
+    r = _mm_min_ps(_mm_max_ps(r, zero), max_value);
+    g = _mm_min_ps(_mm_max_ps(g, zero), max_value);
+    b = _mm_min_ps(_mm_max_ps(b, zero), max_value);
+    __m128 m = _mm_max_ps(r, _mm_max_ps(g, b));
+    // floor(log2(m))直接取自指数位, 下限-16
+    __m128i e = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(m), 23),
+                              _mm_set1_epi32(127));
+    __m128i lo = _mm_set1_epi32(-16);
+    e = SelectEpi32(_mm_cmpgt_epi32(e, lo), e, lo);
+    e = _mm_add_epi32(e, _mm_set1_epi32(16));
+    // scale = 2^(24 - e), 直接构造指数位
+    __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(
+        _mm_sub_epi32(_mm_set1_epi32(24 + 127), e), 23));
+    const __m128 half = _mm_set1_ps(0.5f);
+    __m128i ms = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(m, scale), half));
+    __m128i carry = _mm_cmpeq_epi32(ms, _mm_set1_epi32(512));
+    e = _mm_sub_epi32(e, carry);  // carry为-1
+    scale = SelectPS(_mm_castsi128_ps(carry), _mm_mul_ps(scale, half), scale);
+    __m128i rs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r, scale), half));
+    __m128i gs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(g, scale), half));
+    __m128i bs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(b, scale), half));
+    return _mm_or_si128(_mm_or_si128(rs, _mm_slli_epi32(gs, 9)),
+                        _mm_or_si128(_mm_slli_epi32(bs, 18),
+                                     _mm_slli_epi32(e, 27)));
+}
+#endif
+}  // namespace
+
+ImageF ImageFromBytes(const Byte* data,
+                      GLsizei width,
+                      GLsizei height,
+                      int channels,
+                      bool srgb) {
+    const SRGBTables& t = GetSRGBTables();
+    ImageF image{width, height, {}};
+    size_t count = static_cast<size_t>(width) * height;
+    image.pixels.resize(count * 4);
+#pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < static_cast<int64_t>(count); i++) {
+        float* p = &image.pixels[i * 4];
+        p[0] = p[1] = p[2] = 0.0f;
+        p[3] = 1.0f;
+        for (int c = 0; c < channels; c++) {
+            Byte b = data[i * channels + c];
+            p[c] = srgb && c < 3 ? t.decode[b] : b / 255.0f;
+        }
+    }
+    return image;
+}
+void ImageToBytes(const ImageF& image, int channels, bool srgb, Byte* dst) {
+    const SRGBTables& t = GetSRGBTables();
+    size_t count = static_cast<size_t>(image.width) * image.height;
+#pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < static_cast<int64_t>(count); i++) {
+        const float* p = &image.pixels[i * 4];
+        for (int c = 0; c < channels; c++) {
+            dst[i * channels + c] =
+                srgb && c < 3 ? EncodeSRGB(t, p[c]) : EncodeUnorm(p[c]);
+        }
+    }
+}
+ImageF ImageFromFloats(const float* data,
+                       GLsizei width,
+                       GLsizei height,
+                       int channels) {
+    ImageF image{width, height, {}};
+    size_t count = static_cast<size_t>(width) * height;
+    image.pixels.resize(count * 4);
+#pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < static_cast<int64_t>(count); i++) {
+        float* p = &image.pixels[i * 4];
+        p[0] = p[1] = p[2] = 0.0f;
+        p[3] = 1.0f;
+        for (int c = 0; c < channels; c++)
+            p[c] = data[i * channels + c];
+    }
+    return image;
+}
+void ImageToRGB9E5(const ImageF& image, Byte* dst) {
+    int64_t count = static_cast<int64_t>(image.width) * image.height;
+    const float* src = image.pixels.data();
+    uint32* out = (uint32*)dst;
+    int64_t simd_count = 0;
+#ifdef BL_IMAGE_USE_SSE
+    simd_count = count / 4 * 4;
+#pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < simd_count; i += 4) {
+        __m128 p0 = _mm_loadu_ps(src + i * 4), p1 = _mm_loadu_ps(src + i * 4 + 4),
+               p2 = _mm_loadu_ps(src + i * 4 + 8), p3 = _mm_loadu_ps(src + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+        _mm_storeu_si128((__m128i*)(out + i), PackRGB9E5x4(p0, p1, p2));
+    }
+#endif
+    for (int64_t i = simd_count; i < count; i++)
+        out[i] = PackRGB9E5(src[i * 4], src[i * 4 + 1], src[i * 4 + 2]);
+}
+void ImageToR11G11B10F(const ImageF& image, Byte* dst) {
+    int64_t count = static_cast<int64_t>(image.width) * image.height;
+    const float* src = image.pixels.data();
+    uint32* out = (uint32*)dst;
+    int64_t simd_count = 0;
+#ifdef BL_IMAGE_USE_SSE
+    simd_count = count / 4 * 4;
+#pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < simd_count; i += 4) {
+        __m128 p0 = _mm_loadu_ps(src + i * 4), p1 = _mm_loadu_ps(src + i * 4 + 4),
+               p2 = _mm_loadu_ps(src + i * 4 + 8), p3 = _mm_loadu_ps(src + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+        __m128i packed = _mm_or_si128(
+            PackSmallFloat4<6>(p0),
+            _mm_or_si128(_mm_slli_epi32(PackSmallFloat4<6>(p1), 11),
+                         _mm_slli_epi32(PackSmallFloat4<5>(p2), 22)));
+        _mm_storeu_si128((__m128i*)(out + i), packed);
+    }
+#endif
+    for (int64_t i = simd_count; i < count; i++) {
+        out[i] = PackSmallFloat<6>(src[i * 4]) |
+                 PackSmallFloat<6>(src[i * 4 + 1]) << 11 |
+                 PackSmallFloat<5>(src[i * 4 + 2]) << 22;
+    }
+}
+void ImageToHalf(const ImageF& image, int channels, Byte* dst) {
+    int64_t count = static_cast<int64_t>(image.width) * image.height;
+    const float* src = image.pixels.data();
+    uint16* out = (uint16*)dst;
+#pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < count; i++) {
+        uint16 h[8];
+#if defined(__F16C__)
+        __m128 v = _mm_loadu_ps(src + i * 4);
+        v = _mm_and_ps(v, _mm_cmpord_ps(v, v));  // NaN -> 0
+        v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-65504.0f)),
+                       _mm_set1_ps(65504.0f));
+        _mm_storeu_si128((__m128i*)h, _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+#elif defined(BL_IMAGE_USE_SSE)
+        __m128 v = _mm_loadu_ps(src + i * 4);
+        const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+        __m128i sign = _mm_srli_epi32(_mm_castps_si128(_mm_and_ps(v, sign_mask)), 16);
+        __m128i bits =
+            _mm_or_si128(PackSmallFloat4<10>(_mm_andnot_ps(sign_mask, v)), sign);
+        uint32 w[4];
+        _mm_storeu_si128((__m128i*)w, bits);
+        for (int c = 0; c < 4; c++)
+            h[c] = static_cast<uint16>(w[c]);
+#else
+        for (int c = 0; c < 4; c++) {
+            float v = src[i * 4 + c];
+            h[c] = static_cast<uint16>(PackSmallFloat<10>(std::abs(v)) |
+                                       (std::signbit(v) ? 0x8000u : 0u));
+        }
+#endif
+        std::memcpy(out + i * channels, h, sizeof(uint16) * channels);
+    }
+}
+ImageF DownsampleImage(const ImageF& src,
+                       GLsizei width,
+                       GLsizei height,
+                       MipFilter filter) {
+    FilterTable fx = BuildFilter(src.width, width, filter);
+    FilterTable fy = BuildFilter(src.height, height, filter);
+    // 水平: src.width * src.height -> width * src.height
+    std::vector<float> tmp(static_cast<size_t>(width) * src.height * 4);
+#pragma omp parallel for schedule(dynamic, 16)
+    for (GLsizei y = 0; y < src.height; y++) {
+        const float* row = &src.pixels[static_cast<size_t>(y) * src.width * 4];
+        float* out = &tmp[static_cast<size_t>(y) * width * 4];
+        for (GLsizei x = 0; x < width; x++) {
+#ifdef BL_IMAGE_USE_SSE
+            __m128 acc = _mm_setzero_ps();
+            for (uint32 k = fx.offset[x]; k < fx.offset[x + 1]; k++) {
+                const FilterTap& tap = fx.taps[k];
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(row + tap.index * 4),
+                                                 _mm_set1_ps(tap.weight)));
+            }
+            _mm_storeu_ps(out + x * 4, acc);
+#else
+            float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (uint32 k = fx.offset[x]; k < fx.offset[x + 1]; k++) {
+                const FilterTap& tap = fx.taps[k];
+                for (int c = 0; c < 4; c++)
+                    acc[c] += row[tap.index * 4 + c] * tap.weight;
+            }
+            std::copy(acc, acc + 4, out + x * 4);
+#endif
+        }
+    }
+    // 垂直: width * src.height -> width * height
+    ImageF dst{width, height, {}};
+    dst.pixels.assign(static_cast<size_t>(width) * height * 4, 0.0f);
+    size_t row_floats = static_cast<size_t>(width) * 4;
+#pragma omp parallel for schedule(dynamic, 16)
+    for (GLsizei y = 0; y < height; y++) {
+        float* out = &dst.pixels[y * row_floats];
+        for (uint32 k = fy.offset[y]; k < fy.offset[y + 1]; k++) {
+            const FilterTap& tap = fy.taps[k];
+            RowAxpy(out, &tmp[tap.index * row_floats], tap.weight, row_floats);
+        }
+    }
+    return dst;
+}
+ImageF LimitImageSize(ImageF&& image, GLsizei max_size) {
+    GLsizei longest = std::max(image.width, image.height);
+    if (max_size <= 0 || longest <= max_size)
+        return std::move(image);
+    double scale = static_cast<double>(max_size) / longest;
+    GLsizei w = std::max<GLsizei>(1, static_cast<GLsizei>(image.width * scale + 0.5));
+    GLsizei h = std::max<GLsizei>(1, static_cast<GLsizei>(image.height * scale + 0.5));
+    return DownsampleImage(image, std::min(w, max_size), std::min(h, max_size),
+                           MipFilter::KAISER);
+}
+void RenormalizeNormals(ImageF& image, int channels) {
+    const bool rebuild_z = channels == 2;
+    int64_t count = static_cast<int64_t>(image.width) * image.height;
+    float* pixels = image.pixels.data();
+#pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < count; i++) {
+        float* p = pixels + i * 4;
+#ifdef BL_IMAGE_USE_SSE
+        const __m128 one = _mm_set1_ps(1.0f), half = _mm_set1_ps(0.5f);
+        const __m128 xyz_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+        __m128 v = _mm_loadu_ps(p);
+        __m128 n = _mm_sub_ps(_mm_add_ps(v, v), one);
+        __m128 sq = _mm_mul_ps(n, n);
+        if (rebuild_z) {
+            // z = sqrt(max(0, 1 - x^2 - y^2))
+            __m128 xy = _mm_add_ss(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(1, 1, 1, 1)));
+            __m128 z = _mm_sqrt_ss(_mm_max_ss(_mm_sub_ss(one, xy), _mm_setzero_ps()));
+            // 保留xy, z放到第2个分量
+            const __m128 xy_mask = _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, -1));
+            n = _mm_or_ps(_mm_and_ps(n, xy_mask),
+                          _mm_shuffle_ps(_mm_setzero_ps(), z, _MM_SHUFFLE(1, 0, 0, 0)));
+            sq = _mm_mul_ps(n, n);
+        }
+        sq = _mm_and_ps(sq, xyz_mask);
+        // 水平求和x^2 + y^2 + z^2
+        __m128 t = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 3, 0, 1)));
+        t = _mm_add_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 0, 3, 2)));
+        // 长度为0的法线(如平坦区域的(0.5, 0.5, 0.5))改为+Z
+        __m128 degenerate = _mm_cmplt_ps(t, _mm_set1_ps(1e-12f));
+        n = SelectPS(degenerate, _mm_set_ps(0.0f, 1.0f, 0.0f, 0.0f), n);
+        __m128 len = SelectPS(degenerate, one, _mm_sqrt_ps(t));
+        __m128 r = _mm_add_ps(_mm_mul_ps(_mm_div_ps(n, len), half), half);
+        // alpha保持不变
+        r = _mm_or_ps(_mm_and_ps(xyz_mask, r), _mm_andnot_ps(xyz_mask, v));
+        _mm_storeu_ps(p, r);
+#else
+        float n[3] = {p[0] * 2.0f - 1.0f, p[1] * 2.0f - 1.0f, p[2] * 2.0f - 1.0f};
+        if (rebuild_z)
+            n[2] = std::sqrt(std::max(0.0f, 1.0f - n[0] * n[0] - n[1] * n[1]));
+        float len2 = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+        if (len2 < 1e-12f) {
+            n[0] = n[1] = 0.0f;
+            n[2] = len2 = 1.0f;
+        }
+        float len = std::sqrt(len2);
+        for (int c = 0; c < 3; c++)
+            p[c] = n[c] / len * 0.5f + 0.5f;
+#endif
+    }
+}
+std::vector<ImageF> GenMipChain(ImageF&& base,
+                                MipFilter filter,
+                                GLsizei max_levels) {
+    std::vector<ImageF> chain;
+    chain.push_back(std::move(base));
+    while (chain.back().width > 1 || chain.back().height > 1) {
+        if (max_levels > 0 && static_cast<GLsizei>(chain.size()) >= max_levels)
+            break;
+        const ImageF& prev = chain.back();
+        ImageF next = DownsampleImage(prev, std::max(1, prev.width / 2),
+                                      std::max(1, prev.height / 2), filter);
+        chain.push_back(std::move(next));
+    }
+    return chain;
+}
+}  // namespace Boundless
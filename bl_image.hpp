@@ -0,0 +1,52 @@
+#ifndef _BOUNDLESS_IMAGE_HPP_FILE_
+#define _BOUNDLESS_IMAGE_HPP_FILE_
+#include "bl_resource.hpp"
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 纹理烘焙用的图像处理
+//
+// 图像统一以RGBA float(线性空间)存储, 缺少的通道补为(0,0,0,1)
+// 缩放为可分离滤波: 先水平后垂直, 按行并行(OpenMP), 像素与行内运算使用SSE/AVX
+//
+struct ImageF {
+    GLsizei width, height;
+    std::vector<float> pixels;  // width * height * 4
+};
+
+// 8位数据转为线性RGBA, srgb为真时对RGB通道做sRGB解码
+ImageF ImageFromBytes(const Byte* data,
+                      GLsizei width,
+                      GLsizei height,
+                      int channels,
+                      bool srgb);
+// 线性float数据(stbi_loadf)转为RGBA
+ImageF ImageFromFloats(const float* data,
+                       GLsizei width,
+                       GLsizei height,
+                       int channels);
+// 线性RGBA转为8位数据(只输出前channels个通道), srgb为真时对RGB通道做sRGB编码
+void ImageToBytes(const ImageF& image, int channels, bool srgb, Byte* dst);
+// HDR打包, 负数与NaN视为0, 超出格式范围的值钳制到最大值(不产生无穷大)
+// GL_RGB9_E5: 每像素uint32, GL_UNSIGNED_INT_5_9_9_9_REV
+void ImageToRGB9E5(const ImageF& image, Byte* dst);
+// GL_R11F_G11F_B10F: 每像素uint32, GL_UNSIGNED_INT_10F_11F_11F_REV
+void ImageToR11G11B10F(const ImageF& image, Byte* dst);
+// 半精度浮点(只输出前channels个通道), GL_HALF_FLOAT
+void ImageToHalf(const ImageF& image, int channels, Byte* dst);
+// 缩放到width * height(缩小)
+ImageF DownsampleImage(const ImageF& src,
+                       GLsizei width,
+                       GLsizei height,
+                       MipFilter filter);
+// 长边超过max_size时以Kaiser滤波等比例缩小, 否则原样返回; max_size为0表示不限
+ImageF LimitImageSize(ImageF&& image, GLsizei max_size);
+// 法线贴图重新归一化: RGB由[0,1]解码到[-1,1], 归一化后重新编码
+// channels为2时只存储xy, z由xy重建后参与归一化
+void RenormalizeNormals(ImageF& image, int channels);
+// 生成mipmap链, 第0层为base; max_levels为0时生成到1x1
+std::vector<ImageF> GenMipChain(ImageF&& base,
+                                MipFilter filter,
+                                GLsizei max_levels = 0);
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_IMAGE_HPP_FILE_
@@ -0,0 +1,227 @@
+#include "bl_impostor.hpp"
+
+namespace Boundless {
+Program Impostor::bake_shader;
+Program Impostor::shader;
+
+namespace {
+// 八面体映射解码, uv属于[-1,1]^2, y轴向上
+Vector3f OctahedronDecode(float u, float v) {
+    Vector3f n(u, 1.0f - std::abs(u) - std::abs(v), v);
+    if (n.y() < 0.0f) {
+        float x = (1.0f - std::abs(n.z())) * (n.x() >= 0.0f ? 1.0f : -1.0f);
+        float z = (1.0f - std::abs(n.x())) * (n.z() >= 0.0f ? 1.0f : -1.0f);
+        n.x() = x;
+        n.z() = z;
+    }
+    return n.normalized();
+}
+Matrix4f LookAt(const Vector3f& eye,
+                const Vector3f& target,
+                const Vector3f& up) {
+    Vector3f f = (target - eye).normalized();
+    Vector3f s = f.cross(up).normalized();
+    Vector3f u = s.cross(f);
+    Matrix4f view;
+    view << s.x(), s.y(), s.z(), -s.dot(eye), u.x(), u.y(), u.z(),
+        -u.dot(eye), -f.x(), -f.y(), -f.z(), f.dot(eye), 0.0f, 0.0f, 0.0f,
+        1.0f;
+    return view;
+}
+void DrawMeshRaw(Mesh& mesh) {
+    glBindVertexArray(mesh.getVAO());
+    if (mesh.getIndexStatus() == IndexStatus::NO_INDEX) {
+        glDrawArrays(mesh.getPrimitiveType(), 0, mesh.getCount());
+    } else if (mesh.getIndexStatus() == IndexStatus::ONLY_INDEX) {
+        glDrawElements(mesh.getPrimitiveType(), mesh.getCount(),
+                       mesh.getIndexType(), 0);
+    } else if (mesh.getIndexStatus() == IndexStatus::RESTART_INDEX) {
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(mesh.getRestartIndex());
+        glDrawElements(mesh.getPrimitiveType(), mesh.getCount(),
+                       mesh.getIndexType(), 0);
+        glDisable(GL_PRIMITIVE_RESTART);
+    }
+}
+}  // namespace
+
+Impostor::Impostor()
+    : frames(0),
+      radius(0.0f),
+      center(0.0f, 0.0f, 0.0f),
+      instance_buffer(0),
+      vertex_array(0),
+      instance_capacity(0),
+      distance(100.0f),
+      queued(false) {}
+Impostor::~Impostor() {
+    MemoryTracker::DeleteBuffers(1, &instance_buffer);
+    glDeleteVertexArrays(1, &vertex_array);
+}
+void Impostor::InitShader() {
+    bake_shader.Init({{impostor_bake_vertshader_path, GL_VERTEX_SHADER},
+                      {impostor_bake_fragshader_path, GL_FRAGMENT_SHADER}});
+    shader.Init({{impostor_vertshader_path, GL_VERTEX_SHADER},
+                 {impostor_fragshader_path, GL_FRAGMENT_SHADER}});
+}
+void Impostor::Bake(Mesh& mesh,
+                    const BoundingBox& bounds,
+                    const Vector4f& color,
+                    GLuint frame_count,
+                    GLuint resolution) {
+    frames = frame_count;
+    center = (bounds.bmin + bounds.bmax) * 0.5f;
+    radius = (bounds.bmax - bounds.bmin).norm() * 0.5f;
+    GLsizei size = static_cast<GLsizei>(frames * resolution);
+    // mipmap层数不超过单个视角的层数, 避免视角之间互相渗透
+    GLsizei levels = 1;
+    while ((resolution >> levels) > 0)
+        levels++;
+
+    Texture* targets[2] = {&albedo, &normal_depth};
+    for (Texture* tex : targets) {
+        MemoryTracker::DeleteTextures(1, &tex->texture_id);
+        glCreateTextures(GL_TEXTURE_2D, 1, &tex->texture_id);
+        MemoryTracker::TextureStorage2D(MemoryTag::Texture, tex->texture_id,
+                                        levels, GL_RGBA8, size, size);
+        glTextureParameteri(tex->texture_id, GL_TEXTURE_MIN_FILTER,
+                            GL_LINEAR_MIPMAP_LINEAR);
+        glTextureParameteri(tex->texture_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(tex->texture_id, GL_TEXTURE_WRAP_S,
+                            GL_CLAMP_TO_EDGE);
+        glTextureParameteri(tex->texture_id, GL_TEXTURE_WRAP_T,
+                            GL_CLAMP_TO_EDGE);
+        tex->target = GL_TEXTURE_2D;
+        tex->width = size;
+        tex->height = size;
+        tex->depth = 0;
+    }
+    GLuint fbo, depth_rb;
+    glCreateRenderbuffers(1, &depth_rb);
+    glNamedRenderbufferStorage(depth_rb, GL_DEPTH_COMPONENT24, size, size);
+    glCreateFramebuffers(1, &fbo);
+    glNamedFramebufferTexture(fbo, GL_COLOR_ATTACHMENT0, albedo.texture_id, 0);
+    glNamedFramebufferTexture(fbo, GL_COLOR_ATTACHMENT1,
+                              normal_depth.texture_id, 0);
+    glNamedFramebufferRenderbuffer(fbo, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER,
+                                   depth_rb);
+    const GLenum draw_buffers[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glNamedFramebufferDrawBuffers(fbo, 2, draw_buffers);
+    if (glCheckNamedFramebufferStatus(fbo, GL_FRAMEBUFFER) !=
+        GL_FRAMEBUFFER_COMPLETE) {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &depth_rb);
+        throw std::runtime_error("Impostor framebuffer incomplete.");
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+    const GLfloat zero[4] = {0.0f, 0.0f, 0.0f, 0.0f}, one = 1.0f;
+    glClearNamedFramebufferfv(fbo, GL_COLOR, 0, zero);
+    glClearNamedFramebufferfv(fbo, GL_COLOR, 1, zero);
+    glClearNamedFramebufferfv(fbo, GL_DEPTH, 0, &one);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glEnable(GL_DEPTH_TEST);
+    Program::UseProgram(bake_shader);
+    glProgramUniform4fv(bake_shader.GetID(), impostor_color_uniform, 1,
+                        &color.x());
+    Matrix4f normal_matrix = Matrix4f::Identity();
+    glProgramUniformMatrix4fv(bake_shader.GetID(),
+                              impostor_normalmatrix_uniform, 1, GL_FALSE,
+                              &normal_matrix(0, 0));
+    // 正交投影, 相机位于包围球外2r处, 深度范围覆盖整个包围球
+    Matrix4f proj = Matrix4f::Identity();
+    proj(0, 0) = 1.0f / radius;
+    proj(1, 1) = 1.0f / radius;
+    proj(2, 2) = -2.0f / (2.0f * radius);
+    proj(2, 3) = -(3.0f * radius + radius) / (2.0f * radius);
+    for (GLuint y = 0; y < frames; y++) {
+        for (GLuint x = 0; x < frames; x++) {
+            Vector3f dir = OctahedronDecode((x + 0.5f) / frames * 2.0f - 1.0f,
+                                            (y + 0.5f) / frames * 2.0f - 1.0f);
+            Vector3f up = std::abs(dir.y()) > 0.999f ? Vector3f(0.0f, 0.0f, 1.0f)
+                                                     : Vector3f(0.0f, 1.0f, 0.0f);
+            Matrix4f mvp =
+                proj * LookAt(center + dir * 2.0f * radius, center, up);
+            glProgramUniformMatrix4fv(bake_shader.GetID(),
+                                      impostor_mvpmatrix_uniform, 1, GL_FALSE,
+                                      &mvp(0, 0));
+            glViewport(x * resolution, y * resolution, resolution, resolution);
+            DrawMeshRaw(mesh);
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    if (!depth_test)
+        glDisable(GL_DEPTH_TEST);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &depth_rb);
+    glGenerateTextureMipmap(albedo.texture_id);
+    glGenerateTextureMipmap(normal_depth.texture_id);
+}
+void Impostor::Save(const std::string& path) {
+    Texture::PackTexture(path + ".albedo.texture", albedo, 1, GL_RGBA,
+                         GL_UNSIGNED_BYTE);
+    Texture::PackTexture(path + ".normal.texture", normal_depth, 1, GL_RGBA,
+                         GL_UNSIGNED_BYTE);
+}
+void Impostor::Load(const std::string& path,
+                    const BoundingBox& bounds,
+                    GLuint frame_count) {
+    frames = frame_count;
+    center = (bounds.bmin + bounds.bmax) * 0.5f;
+    radius = (bounds.bmax - bounds.bmin).norm() * 0.5f;
+    Texture::LoadTexture(path + ".albedo.texture", albedo);
+    Texture::LoadTexture(path + ".normal.texture", normal_depth);
+}
+void Impostor::Add(const Matrix4f& model_matrix) {
+    Vector4f c = model_matrix * Vector4f(center.x(), center.y(), center.z(), 1.0f);
+    instances.push_back(
+        {c.head<3>(), model_matrix.block<3, 1>(0, 0).norm()});
+}
+void Impostor::Flush(const Matrix4f& vp_matrix,
+                     const Vector3f& camera_position,
+                     const Vector3f& light_direction) {
+    static_assert(sizeof(Instance) == 16, "Impostor instance must be vec4.");
+    if (instances.empty())
+        return;
+    if (vertex_array == 0) {
+        glCreateVertexArrays(1, &vertex_array);
+        glEnableVertexArrayAttrib(vertex_array, impostor_instance_attrib);
+        glVertexArrayAttribFormat(vertex_array, impostor_instance_attrib, 4,
+                                  GL_FLOAT, GL_FALSE, 0);
+        glVertexArrayAttribBinding(vertex_array, impostor_instance_attrib, 0);
+        glVertexArrayBindingDivisor(vertex_array, 0, 1);
+    }
+    GLsizeiptr bytes = sizeof(Instance) * instances.size();
+    if (bytes > instance_capacity) {
+        // 容量按2倍增长, 重新创建实例缓冲
+        instance_capacity = std::max<GLsizeiptr>(bytes, instance_capacity * 2);
+        MemoryTracker::DeleteBuffers(1, &instance_buffer);
+        glCreateBuffers(1, &instance_buffer);
+        MemoryTracker::BufferStorage(MemoryTag::Render, instance_buffer,
+                                     instance_capacity, nullptr,
+                                     GL_DYNAMIC_STORAGE_BIT);
+        glVertexArrayVertexBuffer(vertex_array, 0, instance_buffer, 0,
+                                  sizeof(Instance));
+    }
+    glNamedBufferSubData(instance_buffer, 0, bytes, instances.data());
+
+    glBindVertexArray(vertex_array);
+    Program::UseProgram(shader);
+    glProgramUniformMatrix4fv(shader.GetID(), impostor_vpmatrix_uniform, 1,
+                              GL_FALSE, &vp_matrix(0, 0));
+    glProgramUniform3fv(shader.GetID(), impostor_campos_uniform, 1,
+                        &camera_position.x());
+    glProgramUniform1i(shader.GetID(), impostor_frames_uniform, frames);
+    glProgramUniform1f(shader.GetID(), impostor_radius_uniform, radius);
+    glProgramUniform3fv(shader.GetID(), impostor_lightdir_uniform, 1,
+                        &light_direction.x());
+    glBindTextureUnit(0, albedo.texture_id);
+    glBindTextureUnit(1, normal_depth.texture_id);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4,
+                          static_cast<GLsizei>(instances.size()));
+    instances.clear();
+}
+}  // namespace Boundless
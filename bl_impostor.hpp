@@ -0,0 +1,87 @@
+#ifndef _BOUNDLESS_IMPOSTOR_HPP_FILE_
+#define _BOUNDLESS_IMPOSTOR_HPP_FILE_
+#include "bl_render.hpp"
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// Impostor相关
+//
+// 将网格从N*N个方向(八面体映射)渲染到图集中, 远处物体以朝向相机的四边形代替
+// 图集0: 反照率(RGBA8, alpha为覆盖率)
+// 图集1: 法向量(RGB, 物体空间, 映射到[0,1]) + 深度(A, 包围球内线性深度)
+//
+const GLuint impostor_vertpos_attrib = 4;     // 与ADS网格布局一致
+const GLuint impostor_vertnormal_attrib = 5;  // 与ADS网格布局一致
+const GLuint impostor_mvpmatrix_uniform = 0;
+const GLuint impostor_normalmatrix_uniform = 1;
+const GLuint impostor_color_uniform = 2;
+const GLuint impostor_vpmatrix_uniform = 0;
+const GLuint impostor_campos_uniform = 1;
+const GLuint impostor_frames_uniform = 2;
+const GLuint impostor_radius_uniform = 3;
+const GLuint impostor_lightdir_uniform = 4;
+const GLuint impostor_instance_attrib = 0;
+const char* const impostor_bake_vertshader_path =
+    ".\\shader\\impostor_bake_vertex.glsl";
+const char* const impostor_bake_fragshader_path =
+    ".\\shader\\impostor_bake_fragment.glsl";
+const char* const impostor_vertshader_path = ".\\shader\\impostor_vertex.glsl";
+const char* const impostor_fragshader_path =
+    ".\\shader\\impostor_fragment.glsl";
+const GLuint default_impostor_frames = 8;        // 每个方向上的视角数
+const GLuint default_impostor_resolution = 128;  // 单个视角的像素边长
+
+class Impostor {
+   public:
+    // 单个实例: 世界空间中心位置与缩放
+    struct Instance {
+        Vector3f position;
+        float scale;
+    };
+
+   private:
+    Texture albedo, normal_depth;
+    GLuint frames;
+    float radius;     // 包围球半径(模型空间)
+    Vector3f center;  // 包围球中心(模型空间)
+    std::vector<Instance> instances;
+    GLuint instance_buffer, vertex_array;
+    GLsizeiptr instance_capacity;
+
+   public:
+    float distance;  // 超过该距离时使用impostor绘制
+    bool queued;     // 本帧是否已加入Renderer的绘制队列
+
+    static Program bake_shader;
+    static Program shader;
+
+    Impostor();
+    Impostor(const Impostor&) = delete;
+    Impostor& operator=(const Impostor&) = delete;
+    ~Impostor();
+
+    // 烘焙: mesh需使用ADS顶点布局(位置4号, 法向量5号属性)
+    void Bake(Mesh& mesh,
+              const BoundingBox& bounds,
+              const Vector4f& color,
+              GLuint frame_count = default_impostor_frames,
+              GLuint resolution = default_impostor_resolution);
+    // 将烘焙结果保存为纹理文件(path.albedo.texture, path.normal.texture)
+    void Save(const std::string& path);
+    // 读取已保存的烘焙结果
+    void Load(const std::string& path,
+              const BoundingBox& bounds,
+              GLuint frame_count = default_impostor_frames);
+
+    // 按物体的模型矩阵加入一个实例(只使用平移与均匀缩放), 在Flush时统一绘制
+    void Add(const Matrix4f& model_matrix);
+    // 以一次实例化绘制调用绘制所有实例并清空队列
+    void Flush(const Matrix4f& vp_matrix,
+               const Vector3f& camera_position,
+               const Vector3f& light_direction);
+    size_t GetInstanceCount() const { return instances.size(); }
+
+    static void InitShader();
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_IMPOSTOR_HPP_FILE_
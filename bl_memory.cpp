@@ -0,0 +1,144 @@
+#include "bl_memory.hpp"
+#include <algorithm>
+#include "bl_memory_tracker.hpp"
+#include "bl_page.hpp"
+
+namespace Boundless {
+frame_arena::frame_arena(size_t capacity, uint32_t frame_count)
+    : index(0), high_water(0), overflows(0) {
+    frames.resize(std::max<uint32_t>(frame_count, 1));
+    for (frame_block& f : frames) {
+        f.base = (unsigned char*)page_allocate(capacity, frame_alignment);
+        f.capacity = capacity;
+        if (!f.base) {
+            for (frame_block& g : frames)
+                page_deallocate(g.base, g.capacity, frame_alignment);
+            throw std::bad_alloc();
+        }
+        f.overflow_bytes = 0;
+    }
+    MemoryTracker::AddExternal(MemoryTag::Pool, capacity * frames.size());
+    cursor = frames[0].base;
+    limit = frames[0].base + frames[0].capacity;
+}
+frame_arena::~frame_arena() {
+    for (frame_block& f : frames) {
+        for (void* p : f.overflow)
+            free(p);
+        page_deallocate(f.base, f.capacity, frame_alignment);
+        MemoryTracker::AddExternal(MemoryTag::Pool,
+                                   -(int64_t)(f.capacity + f.overflow_bytes));
+    }
+}
+void* frame_arena::allocate_overflow(size_t size, size_t alignment) {
+    frame_block& f = frames[index];
+    void* raw = malloc(size + alignment - 1);
+    if (!raw)
+        throw std::bad_alloc();
+    try {
+        f.overflow.push_back(raw);
+    } catch (...) {
+        free(raw);
+        throw;
+    }
+    f.overflow_bytes += size;
+    overflows++;
+    MemoryTracker::AddExternal(MemoryTag::Pool, size);
+    uintptr_t p = (reinterpret_cast<uintptr_t>(raw) + alignment - 1) &
+                  ~static_cast<uintptr_t>(alignment - 1);
+    return reinterpret_cast<void*>(p);
+}
+size_t frame_arena::used() const {
+    const frame_block& f = frames[index];
+    return static_cast<size_t>(cursor - f.base) + f.overflow_bytes;
+}
+void frame_arena::next_frame() {
+    high_water = std::max(high_water, used());
+    index = (index + 1) % frames.size();
+    frame_block& f = frames[index];
+    if (!f.overflow.empty()) {
+        // 该帧上一次溢出: 释放溢出块, 扩大内存块
+        for (void* p : f.overflow)
+            free(p);
+        f.overflow.clear();
+        MemoryTracker::AddExternal(MemoryTag::Pool, -(int64_t)f.overflow_bytes);
+        f.overflow_bytes = 0;
+        if (f.capacity < high_water) {
+            // 取不小于最高用量的2的幂, 给对齐填充留出余量
+            size_t capacity = std::max<size_t>(f.capacity, 64);
+            while (capacity < high_water)
+                capacity *= 2;
+            unsigned char* base =
+                (unsigned char*)page_allocate(capacity, frame_alignment);
+            if (base) {
+                MemoryTracker::AddExternal(MemoryTag::Pool,
+                                           (int64_t)capacity - f.capacity);
+                page_deallocate(f.base, f.capacity, frame_alignment);
+                f.base = base;
+                f.capacity = capacity;
+            }
+        }
+    }
+    cursor = f.base;
+    limit = f.base + f.capacity;
+}
+frame_arena_stats frame_arena::stats() const {
+    return {used(), high_water, frames[index].capacity, overflows};
+}
+void* pool_resource::do_allocate(size_t bytes, size_t alignment) {
+    if (alignment > alignof(std::max_align_t))
+        return upstream->allocate(bytes, alignment);
+    return pool.allocate(bytes);
+}
+void pool_resource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    if (alignment > alignof(std::max_align_t)) {
+        upstream->deallocate(ptr, bytes, alignment);
+        return;
+    }
+    pool.deallocate(ptr, bytes);
+}
+level_arena::level_arena(size_t initial_size,
+                         std::pmr::memory_resource* upstream)
+    : blocks(nullptr),
+      cursor(nullptr),
+      limit(nullptr),
+      initial_size(std::max<size_t>(initial_size, 256)),
+      next_size(this->initial_size),
+      used_bytes(0),
+      capacity_bytes(0),
+      upstream(upstream) {}
+void* level_arena::do_allocate(size_t bytes, size_t alignment) {
+    uintptr_t p = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) &
+                  ~static_cast<uintptr_t>(alignment - 1);
+    if (cursor == nullptr || p + bytes > reinterpret_cast<uintptr_t>(limit)) {
+        // 新内存块, 头部之后按请求的对齐留出余量
+        size_t need = sizeof(block_header) + bytes + alignment;
+        while (next_size < need)
+            next_size *= 2;
+        block_header* b = static_cast<block_header*>(
+            upstream->allocate(next_size, alignof(std::max_align_t)));
+        b->next = blocks;
+        b->size = next_size;
+        blocks = b;
+        cursor = reinterpret_cast<unsigned char*>(b + 1);
+        limit = reinterpret_cast<unsigned char*>(b) + next_size;
+        capacity_bytes += next_size;
+        next_size *= 2;
+        p = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) &
+            ~static_cast<uintptr_t>(alignment - 1);
+    }
+    cursor = reinterpret_cast<unsigned char*>(p + bytes);
+    used_bytes += bytes;
+    return reinterpret_cast<void*>(p);
+}
+void level_arena::release() {
+    while (blocks) {
+        block_header* n = blocks->next;
+        upstream->deallocate(blocks, blocks->size, alignof(std::max_align_t));
+        blocks = n;
+    }
+    cursor = limit = nullptr;
+    next_size = initial_size;
+    used_bytes = capacity_bytes = 0;
+}
+}  // namespace Boundless
@@ -0,0 +1,197 @@
+#ifndef _BOUNDLESS_MEMORY_HPP_FILE_
+#define _BOUNDLESS_MEMORY_HPP_FILE_
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <vector>
+#include "bl_data_struct.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 逐帧线性分配器
+//
+// 每帧的临时数据(绘制列表, 排序缓冲等)从当前帧的连续内存块中顺序分配,
+// 不单独释放; next_frame()切换到下一块并把游标移回起点.
+// 共frames块轮流使用, 一帧分配的内存在之后frames-1帧内仍然有效(帧间重叠).
+// 当前块用尽时临时从堆上分配溢出块, 轮回该帧时释放溢出块,
+// 并把该帧的内存块扩大到不小于历史最高用量的2的幂.
+// 每帧的内存块来自大页内存提供者(bl_page.hpp), 溢出块仍在堆上.
+// 只能在一个线程使用.
+//
+const size_t default_frame_arena_size = 1ULL << 20;  // 每帧1MB
+const uint32_t default_frame_arena_frames = 2;
+
+struct frame_arena_stats {
+    size_t used;        // 当前帧已分配的字节数(含溢出)
+    size_t high_water;  // 所有已结束的帧中的最高用量
+    size_t capacity;    // 当前帧内存块的大小
+    uint64_t overflows;  // 发生溢出的分配次数
+};
+
+class frame_arena {
+    struct frame_block {
+        unsigned char* base;
+        size_t capacity;
+        std::vector<void*> overflow;  // 溢出块, 轮回该帧时释放
+        size_t overflow_bytes;
+    };
+    std::vector<frame_block> frames;
+    uint32_t index;
+    unsigned char* cursor;  // 当前帧的分配位置
+    unsigned char* limit;
+    size_t high_water;
+    uint64_t overflows;
+
+    void* allocate_overflow(size_t size, size_t alignment);
+
+   public:
+    // 每帧内存块起点的对齐, 缓存行大小
+    static constexpr size_t frame_alignment = 64;
+    explicit frame_arena(size_t capacity = default_frame_arena_size,
+                         uint32_t frame_count = default_frame_arena_frames);
+    frame_arena(const frame_arena&) = delete;
+    frame_arena& operator=(const frame_arena&) = delete;
+    ~frame_arena();
+
+    void* allocate(size_t size,
+                   size_t alignment = alignof(std::max_align_t)) {
+        uintptr_t p = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) &
+                      ~static_cast<uintptr_t>(alignment - 1);
+        if (p + size > reinterpret_cast<uintptr_t>(limit))
+            return allocate_overflow(size, alignment);
+        cursor = reinterpret_cast<unsigned char*>(p + size);
+        return reinterpret_cast<void*>(p);
+    }
+    template <typename T>
+    T* allocate_array(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+    // 开始新的一帧, 之前第frames-1帧的内存被复用
+    void next_frame();
+    size_t used() const;
+    frame_arena_stats stats() const;
+};
+
+// 从frame_arena分配的STL分配器, deallocate()不做任何事.
+// 容器扩容时旧的内存直到帧轮回才会回收, 尽量先reserve()
+template <typename T>
+class frame_allocator {
+    template <typename U>
+    friend class frame_allocator;
+    frame_arena* arena;
+
+   public:
+    typedef T value_type;
+
+    frame_allocator(frame_arena& a) noexcept : arena(&a) {}
+    template <typename U>
+    frame_allocator(const frame_allocator<U>& other) noexcept
+        : arena(other.arena) {}
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T*, size_t) noexcept {}
+    template <typename U>
+    bool operator==(const frame_allocator<U>& other) const noexcept {
+        return arena == other.arena;
+    }
+};
+template <typename T>
+using frame_vector = std::vector<T, frame_allocator<T>>;
+
+///////////////////////////////////////////////
+// std::pmr适配
+//
+// 引擎的容器使用std::pmr, 构造时传入下面的memory_resource或用
+// scoped_default_resource替换默认资源, 即可让整个子系统使用局部分配器.
+// 这些资源都不是线程安全的.
+//
+
+// frame_arena的适配, deallocate()不做任何事, 内存在帧轮回时回收
+class frame_arena_resource : public std::pmr::memory_resource {
+    frame_arena* arena;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        return arena->allocate(bytes, alignment);
+    }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+   public:
+    explicit frame_arena_resource(frame_arena& a) : arena(&a) {}
+};
+
+// 按大小分级的对象池(size_class_pool)的适配, 适合频繁增删的小对象(链表节点等).
+// 对齐要求超过alignof(std::max_align_t)的请求交给upstream
+class pool_resource : public std::pmr::memory_resource {
+    size_class_pool<> pool;
+    std::pmr::memory_resource* upstream;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+   public:
+    explicit pool_resource(
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream(upstream) {}
+    size_t live_count() { return pool.live_count(); }
+    size_t memory_size() { return pool.memory_size(); }
+};
+
+// 关卡内存: 单调增长, deallocate()不做任何事, 卸载关卡时release()一次性释放.
+// 内存块从initial_size开始倍增
+const size_t default_level_arena_size = 4ULL << 20;
+
+class level_arena : public std::pmr::memory_resource {
+    struct block_header {
+        block_header* next;
+        size_t size;
+    };
+    block_header* blocks;
+    unsigned char* cursor;
+    unsigned char* limit;
+    size_t initial_size, next_size;
+    size_t used_bytes, capacity_bytes;
+    std::pmr::memory_resource* upstream;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+   public:
+    explicit level_arena(
+        size_t initial_size = default_level_arena_size,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    level_arena(const level_arena&) = delete;
+    level_arena& operator=(const level_arena&) = delete;
+    ~level_arena() override { release(); }
+    // 释放所有内存块, 不调用析构函数; 之后可以继续分配
+    void release();
+    size_t used() const { return used_bytes; }
+    size_t capacity() const { return capacity_bytes; }
+};
+
+// 在作用域内替换std::pmr的默认资源, 期间默认构造的pmr容器都使用resource
+class scoped_default_resource {
+    std::pmr::memory_resource* previous;
+
+   public:
+    explicit scoped_default_resource(std::pmr::memory_resource* resource)
+        : previous(std::pmr::set_default_resource(resource)) {}
+    scoped_default_resource(const scoped_default_resource&) = delete;
+    scoped_default_resource& operator=(const scoped_default_resource&) = delete;
+    ~scoped_default_resource() { std::pmr::set_default_resource(previous); }
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_MEMORY_HPP_FILE_
@@ -0,0 +1,292 @@
+#include "bl_memory_tracker.hpp"
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include "bl_log.hpp"
+#include "bl_page.hpp"
+#include "bl_resource.hpp"
+
+namespace Boundless {
+namespace {
+// 每个线程一组计数, 只由所属线程写入; 线程退出后计数保留, 由之后的线程复用
+struct thread_counters {
+    std::atomic<int64_t> cpu_bytes[memory_tag_count];
+    std::atomic<uint64_t> cpu_count[memory_tag_count];
+    std::atomic<bool> in_use;
+    thread_counters* next;
+};
+std::atomic<thread_counters*> counters_head{nullptr};
+
+thread_counters* acquire_counters() {
+    for (thread_counters* c = counters_head.load(std::memory_order_acquire); c;
+         c = c->next) {
+        bool expected = false;
+        if (c->in_use.compare_exchange_strong(expected, true))
+            return c;
+    }
+    thread_counters* c = new thread_counters;
+    for (size_t i = 0; i < memory_tag_count; i++) {
+        c->cpu_bytes[i].store(0, std::memory_order_relaxed);
+        c->cpu_count[i].store(0, std::memory_order_relaxed);
+    }
+    c->in_use.store(true, std::memory_order_relaxed);
+    c->next = counters_head.load(std::memory_order_relaxed);
+    while (!counters_head.compare_exchange_weak(c->next, c,
+                                                std::memory_order_release))
+        ;
+    return c;
+}
+thread_local thread_counters* local_counters = nullptr;
+struct counters_release {
+    ~counters_release() {
+        if (local_counters) {
+            local_counters->in_use.store(false, std::memory_order_release);
+            local_counters = nullptr;
+        }
+    }
+};
+thread_counters& local() {
+    if (!local_counters) {
+        static thread_local counters_release release;
+        static_cast<void>(release);
+        local_counters = acquire_counters();
+    }
+    return *local_counters;
+}
+void count_cpu(MemoryTag tag, int64_t delta, bool allocation) {
+    thread_counters& c = local();
+    const size_t i = static_cast<size_t>(tag);
+    // 只有本线程写入, 不需要原子的读-改-写
+    c.cpu_bytes[i].store(c.cpu_bytes[i].load(std::memory_order_relaxed) + delta,
+                         std::memory_order_relaxed);
+    if (allocation)
+        c.cpu_count[i].store(c.cpu_count[i].load(std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+}
+
+// Allocate()在用户内存前放置的头部, 保持max_align_t对齐
+struct alignas(std::max_align_t) allocation_header {
+    uint64_t size;
+    uint32_t tag;
+    uint32_t magic;
+};
+const uint32_t allocation_magic = 0xB1A110C8;
+// 不小于大页的分配(解压缓冲区, 流式加载的暂存数据等)交给大页内存提供者
+bool use_pages(size_t total) {
+    return total >= page_slab_size;
+}
+
+// 显存只在GL线程记录, 不需要同步
+struct gpu_allocation {
+    MemoryTag tag;
+    size_t bytes;
+};
+std::unordered_map<GLuint, gpu_allocation> gpu_buffers, gpu_textures;
+int64_t gpu_bytes[memory_tag_count];
+uint64_t gpu_count[memory_tag_count];
+
+void track_gpu(std::unordered_map<GLuint, gpu_allocation>& table,
+               MemoryTag tag,
+               GLuint name,
+               size_t bytes) {
+    auto it = table.find(name);
+    if (it != table.end()) {  // 名称被复用而没有经过Delete~()
+        gpu_bytes[static_cast<size_t>(it->second.tag)] -= it->second.bytes;
+        table.erase(it);
+    }
+    table.emplace(name, gpu_allocation{tag, bytes});
+    gpu_bytes[static_cast<size_t>(tag)] += bytes;
+    gpu_count[static_cast<size_t>(tag)]++;
+}
+void untrack_gpu(std::unordered_map<GLuint, gpu_allocation>& table,
+                 GLsizei n,
+                 const GLuint* names) {
+    for (GLsizei i = 0; i < n; i++) {
+        auto it = table.find(names[i]);
+        if (it == table.end())
+            continue;
+        gpu_bytes[static_cast<size_t>(it->second.tag)] -= it->second.bytes;
+        table.erase(it);
+    }
+}
+
+std::mutex stats_mutex;  // 保护峰值, 预算和输出状态
+int64_t cpu_peak[memory_tag_count], gpu_peak[memory_tag_count];
+int64_t cpu_budget[memory_tag_count], gpu_budget[memory_tag_count];
+bool over_budget[memory_tag_count];
+double dump_interval = 0.0;
+std::chrono::steady_clock::time_point last_dump = std::chrono::steady_clock::now();
+
+// 调用时需持有stats_mutex
+MemoryTagStats collect(size_t i) {
+    MemoryTagStats s{};
+    for (thread_counters* c = counters_head.load(std::memory_order_acquire); c;
+         c = c->next) {
+        s.cpu_current += c->cpu_bytes[i].load(std::memory_order_relaxed);
+        s.cpu_count += c->cpu_count[i].load(std::memory_order_relaxed);
+    }
+    s.gpu_current = gpu_bytes[i];
+    s.gpu_count = gpu_count[i];
+    cpu_peak[i] = std::max(cpu_peak[i], s.cpu_current);
+    gpu_peak[i] = std::max(gpu_peak[i], s.gpu_current);
+    s.cpu_peak = cpu_peak[i];
+    s.gpu_peak = gpu_peak[i];
+    s.cpu_budget = cpu_budget[i];
+    s.gpu_budget = gpu_budget[i];
+    return s;
+}
+void dump_locked() {
+    for (size_t i = 0; i < memory_tag_count; i++) {
+        MemoryTagStats s = collect(i);
+        INFO("MemoryTracker", MemoryTracker::TagName(static_cast<MemoryTag>(i)),
+             ": cpu ", s.cpu_current, " (峰值 ", s.cpu_peak, ", 分配 ",
+             s.cpu_count, "次), gpu ", s.gpu_current, " (峰值 ", s.gpu_peak,
+             ", 分配 ", s.gpu_count, "次)");
+    }
+}
+}  // namespace
+
+const char* MemoryTracker::TagName(MemoryTag tag) {
+    static const char* names[memory_tag_count] = {
+        "General", "Mesh",        "Texture",   "Render",
+        "Pool",    "Compression", "Streaming", "Assimp"};
+    size_t i = static_cast<size_t>(tag);
+    return i < memory_tag_count ? names[i] : "Unknown";
+}
+void* MemoryTracker::Allocate(size_t size, MemoryTag tag) {
+    const size_t total = sizeof(allocation_header) + size;
+    allocation_header* h = (allocation_header*)(use_pages(total)
+                                                    ? page_allocate(total)
+                                                    : malloc(total));
+    if (h == nullptr) {
+        throw std::bad_alloc();
+    }
+    h->size = size;
+    h->tag = static_cast<uint32_t>(tag);
+    h->magic = allocation_magic;
+    count_cpu(tag, static_cast<int64_t>(size), true);
+    return h + 1;
+}
+void MemoryTracker::Free(void* ptr) {
+    if (ptr == nullptr)
+        return;
+    allocation_header* h = static_cast<allocation_header*>(ptr) - 1;
+    assert(h->magic == allocation_magic);
+    h->magic = 0;
+    count_cpu(static_cast<MemoryTag>(h->tag), -static_cast<int64_t>(h->size),
+              false);
+    const size_t total = sizeof(allocation_header) + h->size;
+    if (use_pages(total))
+        page_deallocate(h, total);
+    else
+        free(h);
+}
+void MemoryTracker::AddExternal(MemoryTag tag, int64_t delta) {
+    count_cpu(tag, delta, delta > 0);
+}
+void MemoryTracker::BufferStorage(MemoryTag tag,
+                                  GLuint buffer,
+                                  GLsizeiptr size,
+                                  const void* data,
+                                  GLbitfield flags) {
+    glNamedBufferStorage(buffer, size, data, flags);
+    track_gpu(gpu_buffers, tag, buffer, static_cast<size_t>(size));
+}
+void MemoryTracker::TextureStorage1D(MemoryTag tag,
+                                     GLuint texture,
+                                     GLsizei levels,
+                                     GLenum internal_format,
+                                     GLsizei width) {
+    glTextureStorage1D(texture, levels, internal_format, width);
+    track_gpu(gpu_textures, tag, texture,
+              TextureStorageSize(internal_format, levels, width, 1, 1, false));
+}
+void MemoryTracker::TextureStorage2D(MemoryTag tag,
+                                     GLuint texture,
+                                     GLsizei levels,
+                                     GLenum internal_format,
+                                     GLsizei width,
+                                     GLsizei height) {
+    glTextureStorage2D(texture, levels, internal_format, width, height);
+    GLint target = 0;
+    glGetTextureParameteriv(texture, GL_TEXTURE_TARGET, &target);
+    size_t bytes;
+    if (target == GL_TEXTURE_CUBE_MAP) {
+        bytes = TextureStorageSize(internal_format, levels, width, height, 6,
+                                   true);
+    } else if (target == GL_TEXTURE_1D_ARRAY) {
+        bytes = TextureStorageSize(internal_format, levels, width, 1, height,
+                                   true);
+    } else {
+        bytes = TextureStorageSize(internal_format, levels, width, height, 1,
+                                   false);
+    }
+    track_gpu(gpu_textures, tag, texture, bytes);
+}
+void MemoryTracker::TextureStorage3D(MemoryTag tag,
+                                     GLuint texture,
+                                     GLsizei levels,
+                                     GLenum internal_format,
+                                     GLsizei width,
+                                     GLsizei height,
+                                     GLsizei depth) {
+    glTextureStorage3D(texture, levels, internal_format, width, height, depth);
+    GLint target = 0;
+    glGetTextureParameteriv(texture, GL_TEXTURE_TARGET, &target);
+    track_gpu(gpu_textures, tag, texture,
+              TextureStorageSize(internal_format, levels, width, height, depth,
+                                 target != GL_TEXTURE_3D));
+}
+void MemoryTracker::DeleteBuffers(GLsizei n, const GLuint* buffers) {
+    untrack_gpu(gpu_buffers, n, buffers);
+    glDeleteBuffers(n, buffers);
+}
+void MemoryTracker::DeleteTextures(GLsizei n, const GLuint* textures) {
+    untrack_gpu(gpu_textures, n, textures);
+    glDeleteTextures(n, textures);
+}
+MemoryTagStats MemoryTracker::GetStats(MemoryTag tag) {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return collect(static_cast<size_t>(tag));
+}
+void MemoryTracker::SetBudget(MemoryTag tag, int64_t cpu_bytes, int64_t gpu_bytes) {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    cpu_budget[static_cast<size_t>(tag)] = cpu_bytes;
+    gpu_budget[static_cast<size_t>(tag)] = gpu_bytes;
+}
+void MemoryTracker::SetDumpInterval(double seconds) {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    dump_interval = seconds;
+    last_dump = std::chrono::steady_clock::now();
+}
+void MemoryTracker::Dump() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    dump_locked();
+}
+void MemoryTracker::Update() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    for (size_t i = 0; i < memory_tag_count; i++) {
+        MemoryTagStats s = collect(i);
+        bool over = (s.cpu_budget > 0 && s.cpu_current > s.cpu_budget) ||
+                    (s.gpu_budget > 0 && s.gpu_current > s.gpu_budget);
+        // 只在刚超出预算时警告一次
+        if (over && !over_budget[i]) {
+            WARNING("MemoryTracker", TagName(static_cast<MemoryTag>(i)),
+                    "超出预算: cpu ", s.cpu_current, "/", s.cpu_budget, ", gpu ",
+                    s.gpu_current, "/", s.gpu_budget);
+        }
+        over_budget[i] = over;
+    }
+    if (dump_interval > 0.0) {
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - last_dump).count() >=
+            dump_interval) {
+            last_dump = now;
+            dump_locked();
+        }
+    }
+}
+}  // namespace Boundless
@@ -0,0 +1,105 @@
+#ifndef _BOUNDLESS_MEMORY_TRACKER_HPP_FILE_
+#define _BOUNDLESS_MEMORY_TRACKER_HPP_FILE_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "glad/glad.h"
+namespace Boundless {
+///////////////////////////////////////////////
+// 按标签统计的内存追踪
+//
+// 引擎的堆内存通过MemoryTracker::Allocate()/Free()分配, 显存通过
+// BufferStorage()/TextureStorage*()分配, 都记在一个标签下.
+// 堆内存的计数是每个线程独立的原子变量(只由本线程写入), 分配和释放不加锁;
+// 读取统计时把所有线程的计数相加. 峰值在读取统计或Update()时采样.
+// 显存相关的函数只能在GL上下文所在的线程调用.
+// 每帧调用Update(): 检查预算, 并按SetDumpInterval()的间隔输出统计.
+//
+enum struct MemoryTag : uint32_t {
+    General = 0,
+    Mesh,
+    Texture,
+    Render,       // 渲染器使用的缓冲区(uniform, 回读, 上传环等)
+    Pool,         // 对象池, 逐帧内存
+    Compression,  // 压缩/解压缓冲区
+    Streaming,    // 流式加载的暂存数据
+    Assimp,       // Assimp导入时占用的内存
+    Count
+};
+const size_t memory_tag_count = static_cast<size_t>(MemoryTag::Count);
+
+struct MemoryTagStats {
+    int64_t cpu_current;  // 当前堆内存字节数
+    int64_t cpu_peak;     // 采样得到的峰值
+    uint64_t cpu_count;   // 累计分配次数
+    int64_t gpu_current;  // 当前显存字节数
+    int64_t gpu_peak;
+    uint64_t gpu_count;
+    int64_t cpu_budget;  // 预算, 0表示不限制
+    int64_t gpu_budget;
+};
+
+class MemoryTracker {
+   public:
+    static const char* TagName(MemoryTag tag);
+
+    // 分配失败时抛出std::bad_alloc, 返回的内存按alignof(std::max_align_t)对齐.
+    // 不小于page_slab_size的分配使用大页内存(bl_page.hpp)
+    static void* Allocate(size_t size, MemoryTag tag);
+    // 只能释放Allocate()返回的内存, ptr可以为空
+    static void Free(void* ptr);
+    // 记录引擎之外的库占用的堆内存(如Assimp场景), delta可以为负
+    static void AddExternal(MemoryTag tag, int64_t delta);
+
+    // 以下函数调用对应的GL函数并记录显存
+    static void BufferStorage(MemoryTag tag,
+                              GLuint buffer,
+                              GLsizeiptr size,
+                              const void* data,
+                              GLbitfield flags);
+    static void TextureStorage1D(MemoryTag tag,
+                                 GLuint texture,
+                                 GLsizei levels,
+                                 GLenum internal_format,
+                                 GLsizei width);
+    // 立方体贴图也使用TextureStorage2D, 按6个面计算
+    static void TextureStorage2D(MemoryTag tag,
+                                 GLuint texture,
+                                 GLsizei levels,
+                                 GLenum internal_format,
+                                 GLsizei width,
+                                 GLsizei height);
+    static void TextureStorage3D(MemoryTag tag,
+                                 GLuint texture,
+                                 GLsizei levels,
+                                 GLenum internal_format,
+                                 GLsizei width,
+                                 GLsizei height,
+                                 GLsizei depth);
+    // 删除GL对象并扣除记录的显存, 未记录的名称直接删除
+    static void DeleteBuffers(GLsizei n, const GLuint* buffers);
+    static void DeleteTextures(GLsizei n, const GLuint* textures);
+
+    static MemoryTagStats GetStats(MemoryTag tag);
+    // 超过预算时Update()输出警告, 0表示不限制
+    static void SetBudget(MemoryTag tag, int64_t cpu_bytes, int64_t gpu_bytes);
+    // Update()输出统计的间隔(秒), 0表示不输出
+    static void SetDumpInterval(double seconds);
+    static void Dump();
+    static void Update();
+};
+// 在作用域内记录一段外部库占用的堆内存
+class ExternalMemoryScope {
+    MemoryTag tag;
+    int64_t bytes;
+
+   public:
+    ExternalMemoryScope(MemoryTag tag, int64_t bytes) : tag(tag), bytes(bytes) {
+        MemoryTracker::AddExternal(tag, bytes);
+    }
+    ExternalMemoryScope(const ExternalMemoryScope&) = delete;
+    ExternalMemoryScope& operator=(const ExternalMemoryScope&) = delete;
+    ~ExternalMemoryScope() { MemoryTracker::AddExternal(tag, -bytes); }
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_MEMORY_TRACKER_HPP_FILE_
@@ -0,0 +1,547 @@
+#include "bl_mesh_codec.hpp"
+
+#include <cfloat>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Boundless {
+namespace {
+// 连接关系符号: 低6位为顶点符号, 高2位为后续边掩码
+const Byte codec_vertex_new = 0;     // 新顶点
+const Byte codec_vertex_escape = 63;  // 显式回引, 其后为变长整数
+const Byte codec_candidate_max = 62;  // 边界候选编号上限
+
+inline uint64 EdgeKey(uint32 a, uint32 b) {
+    return (static_cast<uint64>(a) << 32) | b;
+}
+inline uint32 ZigZag(int32 v) {
+    return (static_cast<uint32>(v) << 1) ^ static_cast<uint32>(v >> 31);
+}
+inline int32 UnZigZag(uint32 v) {
+    return static_cast<int32>(v >> 1) ^ -static_cast<int32>(v & 1);
+}
+void WriteVarint(std::vector<Byte>& out, uint32 v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<Byte>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<Byte>(v));
+}
+class StreamReader {
+    const Byte *cur, *end;
+
+   public:
+    StreamReader(const Byte* data, size_t length)
+        : cur(data), end(data + length) {}
+    Byte byte() {
+        if (cur == end) {
+            throw std::runtime_error("Mesh codec data truncated.");
+        }
+        return *cur++;
+    }
+    uint32 varint() {
+        uint32 v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            Byte b = byte();
+            v |= static_cast<uint32>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return v;
+        }
+        throw std::runtime_error("Mesh codec varint overflow.");
+    }
+};
+
+// 已解码部分的边界状态, 编码器与解码器各维护一份且保持完全一致
+// 第三个顶点若已存在, 通常是与a或b共享一条仍未闭合的边的顶点
+class BoundaryState {
+    std::unordered_set<uint64> edges;
+    std::vector<std::vector<uint32>> out, in;
+
+    void add_edge(uint32 a, uint32 b) {
+        edges.insert(EdgeKey(a, b));
+        out[a].push_back(b);
+        in[b].push_back(a);
+    }
+
+   public:
+    void add_vertex() {
+        out.emplace_back();
+        in.emplace_back();
+    }
+    void add_triangle(uint32 a, uint32 b, uint32 c) {
+        add_edge(a, b);
+        add_edge(b, c);
+        add_edge(c, a);
+    }
+    // 三角形(b,a,c)中c的候选: 已有未闭合边(b,v)或(v,a)的顶点v
+    void candidates(uint32 a, uint32 b, std::vector<uint32>& list) const {
+        list.clear();
+        auto push = [&list](uint32 v) {
+            if (std::find(list.begin(), list.end(), v) == list.end())
+                list.push_back(v);
+        };
+        for (uint32 v : out[b]) {
+            if (v != a && !edges.count(EdgeKey(v, b)))
+                push(v);
+        }
+        for (uint32 v : in[a]) {
+            if (v != b && !edges.count(EdgeKey(a, v)))
+                push(v);
+        }
+    }
+};
+
+// 量化后的顶点属性与预测编码
+struct AttributeCoder {
+    uint32 components;
+    std::vector<int32> values;  // 按解码顺序存放的量化值
+
+    void predict(const int32* a,
+                 const int32* b,
+                 const int32* d,
+                 int32* p) const {
+        for (uint32 k = 0; k < components; k++) {
+            p[k] = a ? a[k] + b[k] - d[k] : (b ? b[k] : 0);
+        }
+    }
+    const int32* at(uint32 v) const { return &values[v * components]; }
+};
+
+struct Gate {
+    uint32 a, b, d;  // 有向边(a,b)与该边所在三角形的第三个顶点d
+    uint32 tri;      // 仅编码器使用: 边另一侧的三角形
+};
+}  // namespace
+
+Byte* MeshCodec::Encode(const Byte* mesh_data,
+                        const std::vector<MeshCodecAttrib>& layout,
+                        size_t* ret_length) {
+    const MeshFile& head = *(const MeshFile*)mesh_data;
+    uint32 comps = 0;
+    for (const MeshCodecAttrib& at : layout)
+        comps += at.components;
+    if (head.primitive_type != GL_TRIANGLES ||
+        head.index_status != IndexStatus::ONLY_INDEX ||
+        head.index_type != GL_UNSIGNED_INT || head.buffer_count != 0 ||
+        comps == 0 || head.vbo.length % (comps * sizeof(float)) != 0) {
+        throw std::runtime_error("Mesh codec: unsupported mesh layout.");
+    }
+    const float* vertices = (const float*)(mesh_data + head.vbo.start);
+    const uint32* indices = (const uint32*)(mesh_data + head.ibo.start);
+    uint32 vertex_count =
+        static_cast<uint32>(head.vbo.length / (comps * sizeof(float)));
+    uint32 tri_count = static_cast<uint32>(head.ibo.length / sizeof(uint32) / 3);
+
+    // 量化
+    std::vector<float> minimum(comps, FLT_MAX), step(comps, 0.0f);
+    std::vector<float> maximum(comps, -FLT_MAX);
+    for (uint32 v = 0; v < vertex_count; v++) {
+        for (uint32 k = 0; k < comps; k++) {
+            minimum[k] = std::min(minimum[k], vertices[v * comps + k]);
+            maximum[k] = std::max(maximum[k], vertices[v * comps + k]);
+        }
+    }
+    std::vector<float> scale(comps, 0.0f);
+    for (uint32 k = 0, base = 0; k < layout.size(); base += layout[k].components, k++) {
+        float levels = static_cast<float>((1u << layout[k].bits) - 1);
+        for (uint32 c = base; c < base + layout[k].components; c++) {
+            float range = maximum[c] - minimum[c];
+            if (vertex_count == 0 || range <= 0.0f) {
+                minimum[c] = vertex_count == 0 ? 0.0f : minimum[c];
+                continue;
+            }
+            scale[c] = levels / range;
+            step[c] = range / levels;
+        }
+    }
+    std::vector<int32> quantized(static_cast<size_t>(vertex_count) * comps);
+    for (size_t i = 0; i < quantized.size(); i++) {
+        size_t k = i % comps;
+        quantized[i] = static_cast<int32>(
+            std::floor((vertices[i] - minimum[k]) * scale[k] + 0.5f));
+    }
+
+    // 三角形邻接(有向边 -> 三角形), 非流形边只保留第一个
+    std::unordered_map<uint64, uint32> edge_tri;
+    edge_tri.reserve(static_cast<size_t>(tri_count) * 3);
+    for (uint32 t = 0; t < tri_count; t++) {
+        for (int k = 0; k < 3; k++) {
+            edge_tri.try_emplace(
+                EdgeKey(indices[t * 3 + k], indices[t * 3 + (k + 1) % 3]), t);
+        }
+    }
+    std::vector<bool> claimed(tri_count, false);
+    std::vector<uint32> remap(vertex_count, UINT32_MAX);
+    std::vector<Byte> conn, attr;
+    BoundaryState boundary;
+    AttributeCoder coder{comps, {}};
+    coder.values.reserve(quantized.size());
+    uint32 decoded = 0;
+    std::vector<int32> pred(comps);
+    std::vector<uint32> list;
+    std::vector<Gate> stack;
+
+    // 写出一个顶点; a,b,d为新编号, 为nullptr时退化为差分预测
+    auto emit_vertex = [&](uint32 old, const int32* a, const int32* b,
+                           const int32* d) {
+        coder.predict(a, b, d, pred.data());
+        const int32* q = &quantized[static_cast<size_t>(old) * comps];
+        for (uint32 k = 0; k < comps; k++) {
+            WriteVarint(attr, ZigZag(q[k] - pred[k]));
+        }
+        coder.values.insert(coder.values.end(), q, q + comps);
+        boundary.add_vertex();
+        remap[old] = decoded++;
+    };
+    auto claim = [&](uint32 a, uint32 b) -> int64_t {
+        auto it = edge_tri.find(EdgeKey(b, a));
+        if (it == edge_tri.end() || claimed[it->second])
+            return -1;
+        claimed[it->second] = true;
+        return it->second;
+    };
+    for (uint32 s = 0; s < tri_count; s++) {
+        if (claimed[s])
+            continue;
+        claimed[s] = true;
+        const uint32* tri = indices + s * 3;
+        for (int k = 0; k < 3; k++) {
+            if (remap[tri[k]] == UINT32_MAX) {
+                conn.push_back(codec_vertex_new);
+                emit_vertex(tri[k], nullptr,
+                            decoded > 0 ? coder.at(decoded - 1) : nullptr,
+                            nullptr);
+            } else {
+                conn.push_back(codec_vertex_escape);
+                WriteVarint(conn, decoded - 1 - remap[tri[k]]);
+            }
+        }
+        uint32 v[3] = {remap[tri[0]], remap[tri[1]], remap[tri[2]]};
+        boundary.add_triangle(v[0], v[1], v[2]);
+        Byte mask = 0;
+        Gate gates[3];
+        int gate_count = 0;
+        for (int k = 0; k < 3; k++) {
+            int64_t n = claim(tri[k], tri[(k + 1) % 3]);
+            if (n >= 0) {
+                mask |= 1 << k;
+                gates[gate_count++] = {tri[k], tri[(k + 1) % 3],
+                                       tri[(k + 2) % 3],
+                                       static_cast<uint32>(n)};
+            }
+        }
+        conn.push_back(mask);
+        while (gate_count > 0)
+            stack.push_back(gates[--gate_count]);
+
+        while (!stack.empty()) {
+            Gate g = stack.back();
+            stack.pop_back();
+            // 旋转邻接三角形使其为(b,a,c)
+            const uint32* nt = indices + g.tri * 3;
+            int r = 0;
+            while (!(nt[r] == g.b && nt[(r + 1) % 3] == g.a))
+                r++;
+            uint32 c = nt[(r + 2) % 3];
+            uint32 na = remap[g.a], nb = remap[g.b];
+            Byte sym;
+            uint32 escape = UINT32_MAX;
+            if (remap[c] == UINT32_MAX) {
+                sym = codec_vertex_new;
+            } else {
+                boundary.candidates(na, nb, list);
+                auto it = std::find(list.begin(), list.end(), remap[c]);
+                size_t idx = it - list.begin();
+                if (it != list.end() && idx < codec_candidate_max) {
+                    sym = static_cast<Byte>(idx + 1);
+                } else {
+                    sym = codec_vertex_escape;
+                    escape = decoded - 1 - remap[c];
+                }
+            }
+            mask = 0;
+            int64_t left = claim(g.a, c), right = claim(c, g.b);
+            if (left >= 0)
+                mask |= 1;
+            if (right >= 0)
+                mask |= 2;
+            conn.push_back(static_cast<Byte>(mask << 6 | sym));
+            if (escape != UINT32_MAX)
+                WriteVarint(conn, escape);
+            if (sym == codec_vertex_new) {
+                emit_vertex(c, coder.at(na), coder.at(nb),
+                            coder.at(remap[g.d]));
+            }
+            boundary.add_triangle(nb, na, remap[c]);
+            // 先处理(a,c), 因此后压栈
+            if (right >= 0)
+                stack.push_back({c, g.b, g.a, static_cast<uint32>(right)});
+            if (left >= 0)
+                stack.push_back({g.a, c, g.b, static_cast<uint32>(left)});
+        }
+    }
+    // 未被三角形引用的顶点
+    for (uint32 v = 0; v < vertex_count; v++) {
+        if (remap[v] == UINT32_MAX) {
+            emit_vertex(v, nullptr,
+                        decoded > 0 ? coder.at(decoded - 1) : nullptr, nullptr);
+        }
+    }
+
+    size_t length = sizeof(MeshCodecFile) +
+                    sizeof(MeshCodecAttrib) * layout.size() +
+                    sizeof(float) * comps * 2 + conn.size() + attr.size();
+    Byte* data = (Byte*)MemoryTracker::Allocate(length, MemoryTag::Compression);
+    if (data == nullptr) {
+        throw std::bad_alloc();
+    }
+    MeshCodecFile& file = *(MeshCodecFile*)data;
+    file.primitive_type = head.primitive_type;
+    file.index_type = head.index_type;
+    file.index_status = head.index_status;
+    file.restart_index = head.restart_index;
+    file.vertex_count = vertex_count;
+    file.triangle_count = tri_count;
+    file.component_count = comps;
+    file.attrib_count = static_cast<uint32>(layout.size());
+    file.connectivity_length = conn.size();
+    file.attribute_length = attr.size();
+    Byte* cur = data + sizeof(MeshCodecFile);
+    std::memcpy(cur, layout.data(), sizeof(MeshCodecAttrib) * layout.size());
+    cur += sizeof(MeshCodecAttrib) * layout.size();
+    std::memcpy(cur, minimum.data(), sizeof(float) * comps);
+    cur += sizeof(float) * comps;
+    std::memcpy(cur, step.data(), sizeof(float) * comps);
+    cur += sizeof(float) * comps;
+    std::memcpy(cur, conn.data(), conn.size());
+    cur += conn.size();
+    std::memcpy(cur, attr.data(), attr.size());
+    Byte* res = CompressData(data, &length, sizeof(uint64));
+    MemoryTracker::Free(data);
+    *(uint64*)res = MESH_CODEC_HEADER;
+    *ret_length = length;
+    return res;
+}
+Byte* MeshCodec::Decode(const Byte* data, size_t* ret_length) {
+    if (*(uint64*)data != MESH_CODEC_HEADER) {
+        throw std::runtime_error("Mesh codec head code error.");
+    }
+    size_t len;
+    Byte* dt = UncompressData(data + sizeof(uint64), &len);
+    const MeshCodecFile file = *(MeshCodecFile*)dt;
+    const uint32 comps = file.component_count;
+    const float* minimum =
+        (const float*)(dt + sizeof(MeshCodecFile) +
+                       sizeof(MeshCodecAttrib) * file.attrib_count);
+    const float* step = minimum + comps;
+    const Byte* conn_data = (const Byte*)(step + comps);
+    StreamReader conn(conn_data, file.connectivity_length);
+    StreamReader attr(conn_data + file.connectivity_length,
+                      file.attribute_length);
+
+    MeshFile head;
+    head.primitive_type = file.primitive_type;
+    head.index_type = file.index_type;
+    head.index_status = file.index_status;
+    head.restart_index = file.restart_index;
+    head.buffer_count = 0;
+    head.mesh_count = file.triangle_count * 3;
+    head.vbo.start = sizeof(MeshFile);
+    head.vbo.length = sizeof(float) * comps * file.vertex_count;
+    head.ibo.start = head.vbo.start + head.vbo.length;
+    head.ibo.length = sizeof(uint32) * 3 * file.triangle_count;
+    *ret_length = sizeof(MeshFile) + head.vbo.length + head.ibo.length;
+    Byte* res = (Byte*)MemoryTracker::Allocate(*ret_length,
+                                               MemoryTag::Compression);
+    if (res == nullptr) {
+        MemoryTracker::Free(dt);
+        throw std::bad_alloc();
+    }
+    std::memcpy(res, &head, sizeof(MeshFile));
+    uint32* indices = (uint32*)(res + head.ibo.start);
+    BoundaryState boundary;
+    AttributeCoder coder{comps, {}};
+    coder.values.reserve(static_cast<size_t>(comps) * file.vertex_count);
+    uint32 decoded = 0, tri_decoded = 0;
+    std::vector<int32> pred(comps);
+    std::vector<uint32> list;
+    std::vector<Gate> stack;
+    try {
+        auto read_vertex = [&](const int32* a, const int32* b, const int32* d) {
+            if (decoded >= file.vertex_count) {
+                throw std::runtime_error("Mesh codec vertex overflow.");
+            }
+            coder.predict(a, b, d, pred.data());
+            for (uint32 k = 0; k < comps; k++) {
+                coder.values.push_back(pred[k] + UnZigZag(attr.varint()));
+            }
+            boundary.add_vertex();
+            return decoded++;
+        };
+        auto read_escape = [&]() {
+            uint32 delta = conn.varint();
+            if (delta >= decoded) {
+                throw std::runtime_error("Mesh codec reference error.");
+            }
+            return decoded - 1 - delta;
+        };
+        while (tri_decoded < file.triangle_count) {
+            uint32 v[3];
+            for (int k = 0; k < 3; k++) {
+                Byte sym = conn.byte();
+                v[k] = sym == codec_vertex_new
+                           ? read_vertex(nullptr,
+                                         decoded > 0 ? coder.at(decoded - 1)
+                                                     : nullptr,
+                                         nullptr)
+                           : read_escape();
+            }
+            boundary.add_triangle(v[0], v[1], v[2]);
+            std::memcpy(indices + tri_decoded * 3, v, sizeof(v));
+            tri_decoded++;
+            Byte mask = conn.byte();
+            for (int k = 2; k >= 0; k--) {
+                if (mask & (1 << k))
+                    stack.push_back({v[k], v[(k + 1) % 3], v[(k + 2) % 3], 0});
+            }
+            while (!stack.empty()) {
+                Gate g = stack.back();
+                stack.pop_back();
+                if (tri_decoded >= file.triangle_count) {
+                    throw std::runtime_error("Mesh codec triangle overflow.");
+                }
+                Byte code = conn.byte(), sym = code & 63;
+                uint32 c;
+                if (sym == codec_vertex_new) {
+                    c = read_vertex(coder.at(g.a), coder.at(g.b),
+                                    coder.at(g.d));
+                } else if (sym == codec_vertex_escape) {
+                    c = read_escape();
+                } else {
+                    boundary.candidates(g.a, g.b, list);
+                    if (sym > list.size()) {
+                        throw std::runtime_error("Mesh codec candidate error.");
+                    }
+                    c = list[sym - 1];
+                }
+                boundary.add_triangle(g.b, g.a, c);
+                indices[tri_decoded * 3] = g.b;
+                indices[tri_decoded * 3 + 1] = g.a;
+                indices[tri_decoded * 3 + 2] = c;
+                tri_decoded++;
+                if (code & 0x80)
+                    stack.push_back({c, g.b, g.a, 0});
+                if (code & 0x40)
+                    stack.push_back({g.a, c, g.b, 0});
+            }
+        }
+        while (decoded < file.vertex_count) {
+            read_vertex(nullptr, decoded > 0 ? coder.at(decoded - 1) : nullptr,
+                        nullptr);
+        }
+    } catch (...) {
+        MemoryTracker::Free(res);
+        MemoryTracker::Free(dt);
+        throw;
+    }
+    float* vertices = (float*)(res + head.vbo.start);
+    for (size_t i = 0; i < coder.values.size(); i++) {
+        size_t k = i % comps;
+        vertices[i] = minimum[k] + coder.values[i] * step[k];
+    }
+    MemoryTracker::Free(dt);
+    return res;
+}
+std::future<Byte*> MeshCodec::DecodeFileAsync(const std::string& path) {
+    return DefaultThreadPool().submit([path]() -> Byte* {
+        std::ifstream fin(path, std::ios_base::in | std::ios_base::binary |
+                                    std::ios_base::ate);
+        if (!fin.is_open()) {
+            throw std::runtime_error("Cannot open file:" + path);
+        }
+        size_t length = static_cast<size_t>(fin.tellg());
+        fin.seekg(0);
+        Byte* data = (Byte*)MemoryTracker::Allocate(length,
+                                                    MemoryTag::Compression);
+        if (data == nullptr) {
+            throw std::bad_alloc();
+        }
+        fin.read((char*)data, length);
+        fin.close();
+        Byte* res;
+        try {
+            if (*(uint64*)data == MESH_CODEC_HEADER) {
+                res = Decode(data, &length);
+            } else if (*(uint64*)data == MESH_HEADER) {
+                res = UncompressData(data + sizeof(uint64), &length);
+            } else {
+                throw std::runtime_error("Mesh head code error.");
+            }
+        } catch (...) {
+            MemoryTracker::Free(data);
+            throw;
+        }
+        MemoryTracker::Free(data);
+        return res;
+    });
+}
+std::vector<MeshCodecAttrib> MeshCodec::GetLayout(const aiMesh* ptr,
+                                                  const MeshCodecArg& arg) {
+    std::vector<MeshCodecAttrib> layout;
+    layout.push_back({3, arg.position_bits});
+    if (ptr->HasNormals())
+        layout.push_back({3, arg.normal_bits});
+    for (size_t i = 0; i < ptr->GetNumUVChannels(); i++) {
+        if (ptr->HasTextureCoords(i))
+            layout.push_back({ptr->mNumUVComponents[i], arg.texcoord_bits});
+    }
+    for (size_t i = 0; i < ptr->GetNumColorChannels(); i++)
+        layout.push_back({4, arg.color_bits});
+    if (ptr->HasTangentsAndBitangents()) {
+        layout.push_back({3, arg.tangent_bits});
+        layout.push_back({3, arg.tangent_bits});
+    }
+    return layout;
+}
+void MeshCodec::GenCodecFile(const std::string& path, const MeshCodecArg& arg) {
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, assimp_load_process);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
+        !scene->mRootNode) {
+        throw std::runtime_error(importer.GetErrorString());
+    }
+    aiMemoryInfo scene_memory;
+    importer.GetMemoryRequirements(scene_memory);
+    ExternalMemoryScope assimp_memory(MemoryTag::Assimp, scene_memory.total);
+    for (size_t i = 0; i < scene->mNumMeshes; i++) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        std::string name = path + std::to_string(i) + mesh->mName.C_Str();
+        size_t length;
+        Byte* data = Mesh::GenMeshFile(mesh, name + ".mesh", &length);
+        if (mesh->HasFaces()) {
+            size_t raw_length;
+            Byte* raw = UncompressData(data + sizeof(uint64), &raw_length);
+            MemoryTracker::Free(data);
+            try {
+                data = Encode(raw, GetLayout(mesh, arg), &length);
+            } catch (...) {
+                MemoryTracker::Free(raw);
+                throw;
+            }
+            MemoryTracker::Free(raw);
+            std::cout << "Encoded size:" << length << "Bytes" << std::endl;
+        }
+        std::ofstream fout(name + ".mesh", std::ios_base::out |
+                                               std::ios_base::binary |
+                                               std::ios_base::trunc);
+        if (!fout.is_open()) {
+            MemoryTracker::Free(data);
+            throw std::runtime_error("Cannot open file:" + name + ".mesh");
+        }
+        fout.write((char*)data, length);
+        MemoryTracker::Free(data);
+        fout.close();
+    }
+}
+}  // namespace Boundless
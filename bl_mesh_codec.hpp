@@ -0,0 +1,63 @@
+#ifndef _BOUNDLESS_MESH_CODEC_HPP_FILE_
+#define _BOUNDLESS_MESH_CODEC_HPP_FILE_
+#include "bl_resource.hpp"
+#include "bl_thread.hpp"
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 网格压缩编码(发布用)
+//
+// 连接关系: 按Edgebreaker方式沿三角形的边深度优先遍历
+//   每个三角形记录第三个顶点的来源(新顶点/边界候选/显式回引)与后续可走的边
+// 顶点属性: 逐分量量化, 新顶点用平行四边形预测, 残差以zigzag变长整数存储
+// 最后整体经过CompressData(deflate)压缩
+// 仅支持 GL_TRIANGLES + ONLY_INDEX + GL_UNSIGNED_INT 且VBO全部为float的网格
+// 解码后顶点与三角形顺序会改变(按遍历顺序), 三角形绕序不变
+//
+const size_t MESH_CODEC_HEADER = 0xF246384152FF0006;  // 编码Mesh文件头代码
+
+// 顶点属性描述: float分量数与量化位数
+struct MeshCodecAttrib {
+    uint32 components, bits;
+};
+struct MeshCodecArg {
+    uint32 position_bits = 14;
+    uint32 normal_bits = 10;
+    uint32 texcoord_bits = 12;
+    uint32 color_bits = 8;
+    uint32 tangent_bits = 10;
+};
+struct MeshCodecFile {
+    GLenum primitive_type, index_type;
+    IndexStatus index_status;
+    uint32 restart_index;
+    uint32 vertex_count, triangle_count;
+    uint32 component_count;  // 单个顶点的float分量数
+    uint32 attrib_count;
+    uint64 connectivity_length, attribute_length;
+    // 其后依次为:
+    // MeshCodecAttrib[attrib_count]
+    // float minimum[component_count], step[component_count]
+    // 连接关系数据, 顶点属性数据
+};
+class MeshCodec {
+   public:
+    // 编码未压缩的MeshFile数据, layout按顺序描述VBO中单个顶点的组成
+    // 返回的数据使用MemoryTracker::Free释放
+    static Byte* Encode(const Byte* mesh_data,
+                        const std::vector<MeshCodecAttrib>& layout,
+                        size_t* ret_length);
+    // 解码为未压缩的MeshFile数据(使用MemoryTracker::Free释放), 不调用OpenGL, 可在任意线程执行
+    static Byte* Decode(const Byte* data, size_t* ret_length);
+    // 在DefaultThreadPool中读取并解码文件(MESH_HEADER或MESH_CODEC_HEADER)
+    // 结果交给渲染线程的Mesh::LoadMeshData(), 之后使用MemoryTracker::Free释放
+    static std::future<Byte*> DecodeFileAsync(const std::string& path);
+    // 按GenMeshFile的顶点布局生成layout
+    static std::vector<MeshCodecAttrib> GetLayout(const aiMesh* ptr,
+                                                  const MeshCodecArg& arg);
+    // 同GenMeshFile, 但有面的网格以编码格式写出
+    static void GenCodecFile(const std::string& path,
+                             const MeshCodecArg& arg = {});
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_MESH_CODEC_HPP_FILE_
@@ -17,11 +17,11 @@ void MeshMaker::MakeCube(Mesh& mesh, float size, VertexData df) {
         };
         const uint16 viarr[17]{0, 1, 2, 3, 4, 5, 6, 7, UINT16_MAX,
                                2, 4, 0, 6, 1, 7, 3, 5};
-        glNamedBufferStorage(mesh.index_buffer, sizeof(viarr), viarr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.index_buffer,
+                                     sizeof(viarr), viarr, GL_STATIC_READ);
         glVertexArrayElementBuffer(mesh.vertex_array, mesh.index_buffer);
-        glNamedBufferStorage(mesh.vertex_array, sizeof(vparr), vparr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.vertex_array,
+                                     sizeof(vparr), vparr, GL_STATIC_READ);
         glVertexArrayVertexBuffer(mesh.vertex_array, 0, mesh.vertex_buffer, 0,
                                   12);
         glEnableVertexArrayAttrib(mesh.vertex_array, 0);
@@ -63,11 +63,11 @@ void MeshMaker::MakeCube(Mesh& mesh, float size, VertexData df) {
             0,  1,  2,  3,  UINT16_MAX, 4,  5,  6,  7,  UINT16_MAX,
             8,  9,  10, 11, UINT16_MAX, 12, 13, 14, 15, UINT16_MAX,
             16, 17, 18, 19, UINT16_MAX, 20, 21, 22, 23, UINT16_MAX};
-        glNamedBufferStorage(mesh.index_buffer, sizeof(viarr), viarr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.index_buffer,
+                                     sizeof(viarr), viarr, GL_STATIC_READ);
         glVertexArrayElementBuffer(mesh.vertex_array, mesh.index_buffer);
-        glNamedBufferStorage(mesh.vertex_array, sizeof(vparr), vparr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.vertex_array,
+                                     sizeof(vparr), vparr, GL_STATIC_READ);
         glVertexArrayVertexBuffer(mesh.vertex_array, 0, mesh.vertex_buffer, 0,
                                   24);
         glEnableVertexArrayAttrib(mesh.vertex_array, 0);
@@ -93,7 +93,9 @@ static void MeshMaker::MakePlane(Mesh& mesh,
     mesh.InitIndexStatus(IndexStatus::RESTART_INDEX);
     int cnt = (xdiv + 1) * (ydiv + 1);
     if (df == VertexData::POSITION) {
-        float *vparr = (float*)malloc(sizeof(float) * 3 * cnt), *cur = vparr;
+        float* vparr = (float*)MemoryTracker::Allocate(sizeof(float) * 3 * cnt,
+                                                       MemoryTag::Mesh);
+        float* cur = vparr;
         if (!vparr)
             throw std::bad_alloc();
         for (int j = 0; j < ydiv - 1; j++) {
@@ -103,17 +105,19 @@ static void MeshMaker::MakePlane(Mesh& mesh,
                 *(cur++) = 0.0f;
             }
         }
-        glNamedBufferStorage(mesh.vertex_array, sizeof(vparr), vparr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.vertex_array,
+                                     sizeof(vparr), vparr, GL_STATIC_READ);
         glVertexArrayVertexBuffer(mesh.vertex_array, 0, mesh.vertex_buffer, 0,
                                   12);
         glEnableVertexArrayAttrib(mesh.vertex_array, 0);
         glVertexArrayAttribFormat(mesh.vertex_array, 0, 3, GL_FLOAT, GL_FALSE,
                                   0);
         glVertexArrayAttribBinding(mesh.vertex_array, 0, 0);
-        free(vparr);
+        MemoryTracker::Free(vparr);
     } else if (df == VertexData::NORMAL) {
-        float *vparr = (float*)malloc(sizeof(float) * 6 * cnt), *cur = vparr;
+        float* vparr = (float*)MemoryTracker::Allocate(sizeof(float) * 6 * cnt,
+                                                       MemoryTag::Mesh);
+        float* cur = vparr;
         if (!vparr)
             throw std::bad_alloc();
         for (int j = 0; j < ydiv - 1; j++) {
@@ -126,8 +130,8 @@ static void MeshMaker::MakePlane(Mesh& mesh,
                 *(cur++) = 1.0f;
             }
         }
-        glNamedBufferStorage(mesh.vertex_array, sizeof(vparr), vparr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.vertex_array,
+                                     sizeof(vparr), vparr, GL_STATIC_READ);
         glVertexArrayVertexBuffer(mesh.vertex_array, 0, mesh.vertex_buffer, 0,
                                   12);
         glEnableVertexArrayAttrib(mesh.vertex_array, 0);
@@ -138,13 +142,14 @@ static void MeshMaker::MakePlane(Mesh& mesh,
                                   0);
         glVertexArrayAttribBinding(mesh.vertex_array, 0, 0);
         glVertexArrayAttribBinding(mesh.vertex_array, 1, 0);
-        free(vparr);
+        MemoryTracker::Free(vparr);
     }
     if (cnt < UINT16_MAX) {
         mesh.index_type = GL_UNSIGNED_SHORT;
         mesh.mesh_count = (ydiv - 1) * (xdiv * 2 + 3) - 1;
-        uint16 *viarr = (uint16*)malloc(sizeof(uint16) * mesh.mesh_count),
-               *icur = viarr;
+        uint16* viarr = (uint16*)MemoryTracker::Allocate(
+            sizeof(uint16) * mesh.mesh_count, MemoryTag::Mesh);
+        uint16* icur = viarr;
         if (!viarr)
             throw std::bad_alloc();
         for (int j = 0; j < ydiv - 1; j++) {
@@ -154,16 +159,17 @@ static void MeshMaker::MakePlane(Mesh& mesh,
             }
             *(cur++) = UINT16_MAX;
         }
-        glNamedBufferStorage(mesh.index_buffer,
-                             sizeof(uint16) * mesh.mesh_count, viarr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.index_buffer,
+                                     sizeof(uint16) * mesh.mesh_count, viarr,
+                                     GL_STATIC_READ);
         glVertexArrayElementBuffer(mesh.vertex_array, mesh.index_buffer);
-        free(viarr);
+        MemoryTracker::Free(viarr);
     } else {
         mesh.index_type = GL_UNSIGNED_INT;
         mesh.mesh_count = (ydiv - 1) * (xdiv * 2 + 3) - 1;
-        uint32 *viarr = (uint32*)malloc(sizeof(uint32) * mesh.mesh_count),
-               *icur = viarr;
+        uint32* viarr = (uint32*)MemoryTracker::Allocate(
+            sizeof(uint32) * mesh.mesh_count, MemoryTag::Mesh);
+        uint32* icur = viarr;
         if (!viarr)
             throw std::bad_alloc();
         for (int j = 0; j < ydiv - 1; j++) {
@@ -173,11 +179,11 @@ static void MeshMaker::MakePlane(Mesh& mesh,
             }
             *(cur++) = UINT32_MAX;
         }
-        glNamedBufferStorage(mesh.index_buffer,
-                             sizeof(uint32) * mesh.mesh_count, viarr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.index_buffer,
+                                     sizeof(uint32) * mesh.mesh_count, viarr,
+                                     GL_STATIC_READ);
         glVertexArrayElementBuffer(mesh.vertex_array, mesh.index_buffer);
-        free(viarr);
+        MemoryTracker::Free(viarr);
     }
 }
 void MeshMaker::MakeSphere(Mesh& mesh,
@@ -193,7 +199,9 @@ void MeshMaker::MakeSphere(Mesh& mesh,
     mesh.InitIndexStatus(IndexStatus::RESTART_INDEX);
     int cnt = rdiv * hdiv + 2;
     if (df == VertexData::POSITION) {
-        float *vparr = (float*)malloc(sizeof(float) * 3 * cnt), *cur = vparr;
+        float* vparr = (float*)MemoryTracker::Allocate(sizeof(float) * 3 * cnt,
+                                                       MemoryTag::Mesh);
+        float* cur = vparr;
         if (!vparr)
             throw std::bad_alloc();
         *(cur++) = 0.0f;
@@ -214,18 +222,20 @@ void MeshMaker::MakeSphere(Mesh& mesh,
                 *(cur++) = pos.z();
             }
         }
-        glNamedBufferStorage(mesh.vertex_array, sizeof(float) * 3 * cnt, vparr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.vertex_array,
+                                     sizeof(float) * 3 * cnt, vparr,
+                                     GL_STATIC_READ);
         glVertexArrayVertexBuffer(mesh.vertex_array, 0, mesh.vertex_buffer, 0,
                                   12);
         glEnableVertexArrayAttrib(mesh.vertex_array, 0);
         glVertexArrayAttribFormat(mesh.vertex_array, 0, 3, GL_FLOAT, GL_FALSE,
                                   0);
         glVertexArrayAttribBinding(mesh.vertex_array, 0, 0);
-        free(vparr);
+        MemoryTracker::Free(vparr);
     } else if (df == VertexData::NORMAL) {
-        float *vparr = (float*)malloc(sizeof(float) * 3 * 2 * cnt),
-              *cur = vparr;
+        float* vparr = (float*)MemoryTracker::Allocate(
+            sizeof(float) * 3 * 2 * cnt, MemoryTag::Mesh);
+        float* cur = vparr;
         if (!vparr)
             throw std::bad_alloc();
         *(cur++) = 0.0f;
@@ -252,8 +262,9 @@ void MeshMaker::MakeSphere(Mesh& mesh,
                 *(cur++) = pos.z();
             }
         }
-        glNamedBufferStorage(mesh.vertex_array, sizeof(float) * 3 * 2 * cnt,
-                             vparr, GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.vertex_array,
+                                     sizeof(float) * 3 * 2 * cnt, vparr,
+                                     GL_STATIC_READ);
         glVertexArrayVertexBuffer(mesh.vertex_array, 0, mesh.vertex_buffer, 0,
                                   12);
         glEnableVertexArrayAttrib(mesh.vertex_array, 0);
@@ -264,14 +275,15 @@ void MeshMaker::MakeSphere(Mesh& mesh,
                                   12);
         glVertexArrayAttribBinding(mesh.vertex_array, 0, 0);
         glVertexArrayAttribBinding(mesh.vertex_array, 1, 0);
-        free(vparr);
+        MemoryTracker::Free(vparr);
     }
     if (cnt < UINT16_MAX) {
         mesh.index_type = GL_UNSIGNED_SHORT;
         mesh.mesh_count =
             rdiv * (hdiv * 2 + 1) + 2 * (rdiv / 2 * 5 + rdiv % 2 * 3);
-        uint16 *viarr = (uint16*)malloc(sizeof(uint16) * mesh.mesh_count),
-               *cur = viarr;
+        uint16* viarr = (uint16*)MemoryTracker::Allocate(
+            sizeof(uint16) * mesh.mesh_count, MemoryTag::Mesh);
+        uint16* cur = viarr;
         if (!viarr)
             throw std::bad_alloc();
         for (int i = 0; i < rdiv - 1; i++) {
@@ -335,17 +347,18 @@ void MeshMaker::MakeSphere(Mesh& mesh,
             *(cur++) = static_cast<uint16>(2 + (rdiv - 1) * hdiv + hdiv - 1);
             *(cur++) = static_cast<uint16>(2 + hdiv - 1);
         }
-        glNamedBufferStorage(mesh.index_buffer,
-                             sizeof(uint16) * mesh.mesh_count, viarr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.index_buffer,
+                                     sizeof(uint16) * mesh.mesh_count, viarr,
+                                     GL_STATIC_READ);
         glVertexArrayElementBuffer(mesh.vertex_array, mesh.index_buffer);
-        free(viarr);
+        MemoryTracker::Free(viarr);
     } else {
         mesh.index_type = GL_UNSIGNED_INT;
         mesh.mesh_count =
             (rdiv * (hdiv * 2 + 1) + 2 * (rdiv / 2 * 5 + rdiv % 2 * 3));
-        uint32 *viarr = (uint32*)malloc(sizeof(uint32) * mesh.mesh_count),
-               *cur = viarr;
+        uint32* viarr = (uint32*)MemoryTracker::Allocate(
+            sizeof(uint32) * mesh.mesh_count, MemoryTag::Mesh);
+        uint32* cur = viarr;
         if (!viarr)
             throw std::bad_alloc();
         for (int i = 0; i < rdiv - 1; i++) {
@@ -409,11 +422,11 @@ void MeshMaker::MakeSphere(Mesh& mesh,
             *(cur++) = static_cast<uint32>(2 + (rdiv - 1) * hdiv + hdiv - 1);
             *(cur++) = static_cast<uint32>(2 + hdiv - 1);
         }
-        glNamedBufferStorage(mesh.index_buffer,
-                             sizeof(uint32) * mesh.mesh_count, viarr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.index_buffer,
+                                     sizeof(uint32) * mesh.mesh_count, viarr,
+                                     GL_STATIC_READ);
         glVertexArrayElementBuffer(mesh.vertex_array, mesh.index_buffer);
-        free(viarr);
+        MemoryTracker::Free(viarr);
     }
 }
 // void MeshMaker::MakeTorus(Mesh& mesh,
@@ -442,11 +455,11 @@ void MeshMaker::MakeCubord(Mesh& mesh,
         };
         const uint16 viarr[17]{0, 1, 2, 3, 4, 5, 6, 7, UINT16_MAX,
                                2, 4, 0, 6, 1, 7, 3, 5};
-        glNamedBufferStorage(mesh.index_buffer, sizeof(viarr), viarr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.index_buffer,
+                                     sizeof(viarr), viarr, GL_STATIC_READ);
         glVertexArrayElementBuffer(mesh.vertex_array, mesh.index_buffer);
-        glNamedBufferStorage(mesh.vertex_array, sizeof(vparr), vparr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.vertex_array,
+                                     sizeof(vparr), vparr, GL_STATIC_READ);
         glVertexArrayVertexBuffer(mesh.vertex_array, 0, mesh.vertex_buffer, 0,
                                   12);
         glEnableVertexArrayAttrib(mesh.vertex_array, 0);
@@ -484,11 +497,11 @@ void MeshMaker::MakeCubord(Mesh& mesh,
             0,  1,  2,  3,  UINT16_MAX, 4,  5,  6,  7,  UINT16_MAX,
             8,  9,  10, 11, UINT16_MAX, 12, 13, 14, 15, UINT16_MAX,
             16, 17, 18, 19, UINT16_MAX, 20, 21, 22, 23, UINT16_MAX};
-        glNamedBufferStorage(mesh.index_buffer, sizeof(viarr), viarr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.index_buffer,
+                                     sizeof(viarr), viarr, GL_STATIC_READ);
         glVertexArrayElementBuffer(mesh.vertex_array, mesh.index_buffer);
-        glNamedBufferStorage(mesh.vertex_array, sizeof(vparr), vparr,
-                             GL_STATIC_READ);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.vertex_array,
+                                     sizeof(vparr), vparr, GL_STATIC_READ);
         glVertexArrayVertexBuffer(mesh.vertex_array, 0, mesh.vertex_buffer, 0,
                                   24);
         glEnableVertexArrayAttrib(mesh.vertex_array, 0);
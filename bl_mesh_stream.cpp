@@ -0,0 +1,768 @@
+#include "bl_mesh_stream.hpp"
+
+#include <cfloat>
+#include <cstring>
+#include <unordered_map>
+
+namespace Boundless {
+namespace {
+///////////////////////////////////////////////
+// 有界缓冲的读写器
+//
+class BufferedReader {
+    std::ifstream in;
+    std::vector<char> buf;
+    size_t pos, end;
+
+    bool fill() {
+        if (pos < end) {
+            std::memmove(buf.data(), buf.data() + pos, end - pos);
+        }
+        end -= pos;
+        pos = 0;
+        in.read(buf.data() + end, buf.size() - end);
+        end += static_cast<size_t>(in.gcount());
+        return end > 0;
+    }
+
+   public:
+    BufferedReader(const std::string& path, size_t size)
+        : in(path, std::ios::in | std::ios::binary),
+          buf(size),
+          pos(0),
+          end(0) {
+        if (!in.is_open()) {
+            throw std::runtime_error("Cannot open file:" + path);
+        }
+    }
+    bool read(void* dst, size_t n) {
+        char* out = (char*)dst;
+        while (n > 0) {
+            if (pos == end && !fill())
+                return false;
+            size_t c = std::min(n, end - pos);
+            std::memcpy(out, buf.data() + pos, c);
+            pos += c;
+            out += c;
+            n -= c;
+        }
+        return true;
+    }
+    bool getline(std::string& line) {
+        line.clear();
+        while (true) {
+            if (pos == end && !fill())
+                return !line.empty();
+            char* begin = buf.data() + pos;
+            char* nl = (char*)std::memchr(begin, '\n', end - pos);
+            if (nl) {
+                line.append(begin, nl - begin);
+                pos += nl - begin + 1;
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                return true;
+            }
+            line.append(begin, end - pos);
+            pos = end;
+        }
+    }
+};
+class BufferedWriter {
+    std::ofstream out;
+    std::vector<char> buf;
+    size_t pos;
+
+   public:
+    BufferedWriter(const std::string& path, size_t size)
+        : out(path, std::ios::out | std::ios::binary | std::ios::trunc),
+          buf(size),
+          pos(0) {
+        if (!out.is_open()) {
+            throw std::runtime_error("Cannot open file:" + path);
+        }
+    }
+    void write(const void* data, size_t n) {
+        const char* p = (const char*)data;
+        while (n > 0) {
+            size_t c = std::min(n, buf.size() - pos);
+            std::memcpy(buf.data() + pos, p, c);
+            pos += c;
+            p += c;
+            n -= c;
+            if (pos == buf.size())
+                flush();
+        }
+    }
+    void flush() {
+        out.write(buf.data(), pos);
+        pos = 0;
+    }
+    void close() {
+        flush();
+        out.close();
+    }
+};
+
+///////////////////////////////////////////////
+// 阶段1: 流式解析
+//
+struct ParseSink {
+    BufferedWriter& vertices;
+    BufferedWriter& faces;
+    uint64 vertex_count = 0, face_count = 0;
+    float bmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float bmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+    void vertex(const float p[3]) {
+        for (int k = 0; k < 3; k++) {
+            bmin[k] = std::min(bmin[k], p[k]);
+            bmax[k] = std::max(bmax[k], p[k]);
+        }
+        vertices.write(p, sizeof(float) * 3);
+        vertex_count++;
+    }
+    // 多边形以扇形三角化
+    void face(const uint32* idx, size_t n) {
+        for (size_t i = 2; i < n; i++) {
+            uint32 tri[3] = {idx[0], idx[i - 1], idx[i]};
+            faces.write(tri, sizeof(tri));
+            face_count++;
+        }
+    }
+};
+
+enum struct PlyType : int { NONE, INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64 };
+PlyType ParsePlyType(const std::string& s) {
+    if (s == "char" || s == "int8")
+        return PlyType::INT8;
+    if (s == "uchar" || s == "uint8")
+        return PlyType::UINT8;
+    if (s == "short" || s == "int16")
+        return PlyType::INT16;
+    if (s == "ushort" || s == "uint16")
+        return PlyType::UINT16;
+    if (s == "int" || s == "int32")
+        return PlyType::INT32;
+    if (s == "uint" || s == "uint32")
+        return PlyType::UINT32;
+    if (s == "float" || s == "float32")
+        return PlyType::FLOAT32;
+    if (s == "double" || s == "float64")
+        return PlyType::FLOAT64;
+    return PlyType::NONE;
+}
+size_t PlyTypeSize(PlyType t) {
+    switch (t) {
+        case PlyType::INT8:
+        case PlyType::UINT8:
+            return 1;
+        case PlyType::INT16:
+        case PlyType::UINT16:
+            return 2;
+        case PlyType::INT32:
+        case PlyType::UINT32:
+        case PlyType::FLOAT32:
+            return 4;
+        case PlyType::FLOAT64:
+            return 8;
+        default:
+            return 0;
+    }
+}
+double PlyValue(const Byte* p, PlyType t, bool swap) {
+    Byte tmp[8];
+    size_t n = PlyTypeSize(t);
+    for (size_t i = 0; i < n; i++)
+        tmp[i] = swap ? p[n - 1 - i] : p[i];
+    switch (t) {
+        case PlyType::INT8:
+            return *(int8*)tmp;
+        case PlyType::UINT8:
+            return *(uint8_t*)tmp;
+        case PlyType::INT16:
+            return *(int16*)tmp;
+        case PlyType::UINT16:
+            return *(uint16*)tmp;
+        case PlyType::INT32:
+            return *(int32*)tmp;
+        case PlyType::UINT32:
+            return *(uint32*)tmp;
+        case PlyType::FLOAT32:
+            return *(float*)tmp;
+        case PlyType::FLOAT64:
+            return *(double*)tmp;
+        default:
+            return 0.0;
+    }
+}
+struct PlyProperty {
+    std::string name;
+    PlyType type, count_type;  // count_type != NONE 表示list属性
+};
+struct PlyElement {
+    std::string name;
+    uint64 count;
+    std::vector<PlyProperty> props;
+};
+void ParsePLY(const std::string& path, ParseSink& sink, size_t buffer_size) {
+    BufferedReader in(path, buffer_size);
+    std::string line, token;
+    if (!in.getline(line) || line != "ply") {
+        throw std::runtime_error("PLY head error:" + path);
+    }
+    int format = -1;  // 0:ascii 1:binary_little_endian 2:binary_big_endian
+    std::vector<PlyElement> elements;
+    while (in.getline(line) && line != "end_header") {
+        std::istringstream ls(line);
+        ls >> token;
+        if (token == "format") {
+            ls >> token;
+            format = token == "ascii" ? 0
+                     : token == "binary_little_endian" ? 1
+                     : token == "binary_big_endian"    ? 2
+                                                        : -1;
+        } else if (token == "element") {
+            PlyElement e;
+            ls >> e.name >> e.count;
+            elements.push_back(e);
+        } else if (token == "property" && !elements.empty()) {
+            PlyProperty p;
+            ls >> token;
+            if (token == "list") {
+                ls >> token;
+                p.count_type = ParsePlyType(token);
+                ls >> token;
+                p.type = ParsePlyType(token);
+            } else {
+                p.count_type = PlyType::NONE;
+                p.type = ParsePlyType(token);
+            }
+            ls >> p.name;
+            elements.back().props.push_back(p);
+        }
+    }
+    if (format < 0) {
+        throw std::runtime_error("PLY format error:" + path);
+    }
+    const uint16 probe = 1;
+    bool little = *(const Byte*)&probe == 1;
+    bool swap = (format == 1 && !little) || (format == 2 && little);
+    std::vector<uint32> poly;
+    std::vector<double> values;
+    Byte raw[8];
+    for (const PlyElement& e : elements) {
+        bool is_vertex = e.name == "vertex", is_face = e.name == "face";
+        int xyz[3] = {-1, -1, -1}, list = -1;
+        for (size_t i = 0; i < e.props.size(); i++) {
+            const std::string& n = e.props[i].name;
+            if (n == "x")
+                xyz[0] = static_cast<int>(i);
+            else if (n == "y")
+                xyz[1] = static_cast<int>(i);
+            else if (n == "z")
+                xyz[2] = static_cast<int>(i);
+            if (e.props[i].count_type != PlyType::NONE &&
+                (n == "vertex_indices" || n == "vertex_index"))
+                list = static_cast<int>(i);
+        }
+        values.resize(e.props.size());
+        for (uint64 r = 0; r < e.count; r++) {
+            std::istringstream ls;
+            if (format == 0) {
+                if (!in.getline(line))
+                    throw std::runtime_error("PLY data truncated:" + path);
+                ls.str(line);
+            }
+            for (size_t i = 0; i < e.props.size(); i++) {
+                const PlyProperty& p = e.props[i];
+                bool keep = static_cast<int>(i) == list;
+                if (p.count_type == PlyType::NONE) {
+                    if (format == 0) {
+                        ls >> values[i];
+                    } else {
+                        if (!in.read(raw, PlyTypeSize(p.type)))
+                            throw std::runtime_error("PLY data truncated:" + path);
+                        values[i] = PlyValue(raw, p.type, swap);
+                    }
+                    continue;
+                }
+                double cnt;
+                if (format == 0) {
+                    ls >> cnt;
+                } else {
+                    if (!in.read(raw, PlyTypeSize(p.count_type)))
+                        throw std::runtime_error("PLY data truncated:" + path);
+                    cnt = PlyValue(raw, p.count_type, swap);
+                }
+                if (keep)
+                    poly.clear();
+                for (uint64 k = 0; k < static_cast<uint64>(cnt); k++) {
+                    double v;
+                    if (format == 0) {
+                        ls >> v;
+                    } else {
+                        if (!in.read(raw, PlyTypeSize(p.type)))
+                            throw std::runtime_error("PLY data truncated:" + path);
+                        v = PlyValue(raw, p.type, swap);
+                    }
+                    if (keep)
+                        poly.push_back(static_cast<uint32>(v));
+                }
+            }
+            if (is_vertex && xyz[0] >= 0 && xyz[1] >= 0 && xyz[2] >= 0) {
+                float pos[3] = {static_cast<float>(values[xyz[0]]),
+                                static_cast<float>(values[xyz[1]]),
+                                static_cast<float>(values[xyz[2]])};
+                sink.vertex(pos);
+            } else if (is_face && list >= 0) {
+                sink.face(poly.data(), poly.size());
+            }
+        }
+    }
+}
+void ParseOBJ(const std::string& path, ParseSink& sink, size_t buffer_size) {
+    BufferedReader in(path, buffer_size);
+    std::string line;
+    std::vector<uint32> poly;
+    while (in.getline(line)) {
+        const char* p = line.c_str();
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+            char* e;
+            float pos[3];
+            p += 2;
+            for (int k = 0; k < 3; k++) {
+                pos[k] = std::strtof(p, &e);
+                p = e;
+            }
+            sink.vertex(pos);
+        } else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+            poly.clear();
+            p += 2;
+            while (*p) {
+                char* e;
+                long long idx = std::strtoll(p, &e, 10);
+                if (e == p)
+                    break;
+                // OBJ索引从1开始, 负数表示相对当前顶点数
+                idx = idx < 0 ? static_cast<long long>(sink.vertex_count) + idx
+                              : idx - 1;
+                if (idx < 0 || idx > static_cast<long long>(UINT32_MAX)) {
+                    throw std::runtime_error("OBJ index out of range:" + path);
+                }
+                poly.push_back(static_cast<uint32>(idx));
+                p = e;
+                while (*p && *p != ' ' && *p != '\t')
+                    p++;  // 跳过 /vt/vn
+                while (*p == ' ' || *p == '\t')
+                    p++;
+            }
+            sink.face(poly.data(), poly.size());
+        }
+    }
+}
+
+///////////////////////////////////////////////
+// 阶段2: 空间分桶
+//
+// 对顶点临时文件的直接映射页缓存, 用于按索引随机读取顶点位置
+class VertexPageCache {
+    std::ifstream in;
+    size_t page_floats;
+    std::vector<float> data;
+    std::vector<uint64> tags;
+
+   public:
+    VertexPageCache(const std::string& path, size_t budget)
+        : in(path, std::ios::in | std::ios::binary) {
+        if (!in.is_open()) {
+            throw std::runtime_error("Cannot open file:" + path);
+        }
+        page_floats = 3 * 4096;  // 每页4096个顶点
+        size_t pages = std::max<size_t>(1, budget / (page_floats * sizeof(float)));
+        data.resize(pages * page_floats);
+        tags.assign(pages, UINT64_MAX);
+    }
+    const float* get(uint64 vertex) {
+        uint64 page = vertex * 3 / page_floats;
+        size_t slot = page % tags.size();
+        float* base = data.data() + slot * page_floats;
+        if (tags[slot] != page) {
+            in.clear();
+            in.seekg(page * page_floats * sizeof(float));
+            in.read((char*)base, page_floats * sizeof(float));
+            tags[slot] = page;
+        }
+        return base + (vertex * 3 - page * page_floats);
+    }
+};
+// 每个桶在内存中有一个固定大小的缓冲, 写满后作为一个块追加到共享临时文件
+const size_t bucket_min_block = 4096;
+class BucketWriter {
+    std::ofstream out;
+    size_t block_bytes;
+    std::vector<std::vector<Byte>> buffers;
+    uint64 offset;
+
+   public:
+    std::vector<std::vector<DataRange>> blocks;
+
+    BucketWriter(const std::string& path, size_t bucket_count, size_t budget)
+        : out(path, std::ios::out | std::ios::binary | std::ios::trunc),
+          buffers(bucket_count),
+          offset(0),
+          blocks(bucket_count) {
+        if (!out.is_open()) {
+            throw std::runtime_error("Cannot open file:" + path);
+        }
+        // 桶数由调用者按budget / bucket_min_block限制, 只有预算过小时才会超出
+        block_bytes = std::max<size_t>(bucket_min_block, budget / bucket_count);
+        block_bytes -= block_bytes % (sizeof(float) * 9);
+    }
+    void write(size_t bucket, const float tri[9]) {
+        std::vector<Byte>& b = buffers[bucket];
+        if (b.capacity() == 0)
+            b.reserve(block_bytes);
+        b.insert(b.end(), (const Byte*)tri, (const Byte*)(tri + 9));
+        if (b.size() >= block_bytes)
+            flush(bucket);
+    }
+    void flush(size_t bucket) {
+        std::vector<Byte>& b = buffers[bucket];
+        if (b.empty())
+            return;
+        out.write((const char*)b.data(), b.size());
+        blocks[bucket].push_back({offset, b.size()});
+        offset += b.size();
+        b.clear();
+    }
+    void close() {
+        for (size_t i = 0; i < buffers.size(); i++) {
+            flush(i);
+            std::vector<Byte>().swap(buffers[i]);
+        }
+        out.close();
+    }
+};
+
+///////////////////////////////////////////////
+// 阶段3: 逐簇焊接与优化
+//
+struct WeldKey {
+    int32 v[3];
+    bool operator==(const WeldKey& o) const {
+        return v[0] == o.v[0] && v[1] == o.v[1] && v[2] == o.v[2];
+    }
+};
+struct WeldKeyHash {
+    size_t operator()(const WeldKey& k) const {
+        uint64 h = static_cast<uint32>(k.v[0]) * 0x9E3779B97F4A7C15ULL;
+        h ^= static_cast<uint32>(k.v[1]) * 0xC2B2AE3D27D4EB4FULL + (h << 6);
+        h ^= static_cast<uint32>(k.v[2]) * 0x165667B19E3779F9ULL + (h >> 2);
+        return static_cast<size_t>(h);
+    }
+};
+// Tipsify顶点缓存优化(Sander 2007), 返回新的三角形顺序
+std::vector<uint32> Tipsify(const std::vector<uint32>& indices,
+                            uint32 vertex_count,
+                            uint32 cache_size) {
+    uint32 tri_count = static_cast<uint32>(indices.size() / 3);
+    std::vector<uint32> live(vertex_count, 0), offsets(vertex_count + 1, 0);
+    for (uint32 v : indices)
+        live[v]++;
+    for (uint32 v = 0; v < vertex_count; v++)
+        offsets[v + 1] = offsets[v] + live[v];
+    std::vector<uint32> adj(indices.size()), fill(offsets.begin(),
+                                                  offsets.end() - 1);
+    for (uint32 t = 0; t < tri_count; t++) {
+        for (int k = 0; k < 3; k++)
+            adj[fill[indices[t * 3 + k]]++] = t;
+    }
+    std::vector<uint32> cache_time(vertex_count, 0), dead_end;
+    std::vector<bool> emitted(tri_count, false);
+    std::vector<uint32> order, candidates;
+    order.reserve(tri_count);
+    uint32 time = cache_size + 1, cursor = 0;
+    int64_t fan = vertex_count > 0 ? 0 : -1;
+    while (fan >= 0) {
+        candidates.clear();
+        for (uint32 i = offsets[fan]; i < offsets[fan + 1]; i++) {
+            uint32 t = adj[i];
+            if (emitted[t])
+                continue;
+            for (int k = 0; k < 3; k++) {
+                uint32 v = indices[t * 3 + k];
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - cache_time[v] > cache_size) {
+                    cache_time[v] = time;
+                    time++;
+                }
+            }
+            emitted[t] = true;
+            order.push_back(t);
+        }
+        int64_t best = -1, priority = -1;
+        for (uint32 v : candidates) {
+            if (live[v] == 0)
+                continue;
+            int64_t p = 0;
+            if (time - cache_time[v] + 2 * live[v] <= cache_size)
+                p = time - cache_time[v];
+            if (p > priority) {
+                priority = p;
+                best = v;
+            }
+        }
+        if (best < 0) {
+            while (!dead_end.empty()) {
+                uint32 d = dead_end.back();
+                dead_end.pop_back();
+                if (live[d] > 0) {
+                    best = d;
+                    break;
+                }
+            }
+            while (best < 0 && cursor < vertex_count) {
+                if (live[cursor] > 0)
+                    best = cursor;
+                cursor++;
+            }
+        }
+        fan = best;
+    }
+    return order;
+}
+void EmitCluster(const std::vector<float>& soup,
+                 const StreamImportArg& arg,
+                 std::ofstream& out,
+                 StreamImportStat& stat) {
+    size_t tri_count = soup.size() / 9;
+    std::unordered_map<WeldKey, uint32, WeldKeyHash> weld;
+    weld.reserve(tri_count);
+    std::vector<float> positions;
+    std::vector<uint32> indices;
+    indices.reserve(tri_count * 3);
+    float inv_eps = arg.weld_epsilon > 0.0f ? 1.0f / arg.weld_epsilon : 0.0f;
+    for (size_t t = 0; t < tri_count; t++) {
+        uint32 tri[3];
+        for (int k = 0; k < 3; k++) {
+            const float* p = &soup[t * 9 + k * 3];
+            WeldKey key;
+            for (int c = 0; c < 3; c++) {
+                if (inv_eps > 0.0f)
+                    key.v[c] = static_cast<int32>(std::floor(p[c] * inv_eps + 0.5f));
+                else
+                    std::memcpy(&key.v[c], &p[c], sizeof(float));
+            }
+            auto [it, inserted] = weld.try_emplace(
+                key, static_cast<uint32>(positions.size() / 3));
+            if (inserted)
+                positions.insert(positions.end(), p, p + 3);
+            tri[k] = it->second;
+        }
+        if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2])
+            continue;  // 焊接后退化的三角形
+        indices.insert(indices.end(), tri, tri + 3);
+    }
+    std::unordered_map<WeldKey, uint32, WeldKeyHash>().swap(weld);
+    if (indices.empty())
+        return;
+    uint32 vertex_count = static_cast<uint32>(positions.size() / 3);
+
+    // 三角形按顶点缓存顺序排列, 顶点按首次使用顺序排列
+    std::vector<uint32> order =
+        Tipsify(indices, vertex_count, arg.vertex_cache_size);
+    std::vector<uint32> remap(vertex_count, UINT32_MAX), sorted(indices.size());
+    uint32 next = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+        for (int k = 0; k < 3; k++) {
+            uint32 v = indices[order[i] * 3 + k];
+            if (remap[v] == UINT32_MAX)
+                remap[v] = next++;
+            sorted[i * 3 + k] = remap[v];
+        }
+    }
+    // 顶点数据: 位置 + 面积加权法向量
+    std::vector<float> vertices(vertex_count * 6, 0.0f);
+    for (uint32 v = 0; v < vertex_count; v++) {
+        if (remap[v] != UINT32_MAX)
+            std::memcpy(&vertices[remap[v] * 6], &positions[v * 3],
+                        sizeof(float) * 3);
+    }
+    for (size_t t = 0; t < sorted.size(); t += 3) {
+        Eigen::Map<const Vector3f> a(&vertices[sorted[t] * 6]),
+            b(&vertices[sorted[t + 1] * 6]), c(&vertices[sorted[t + 2] * 6]);
+        Vector3f n = (b - a).cross(c - a);
+        for (int k = 0; k < 3; k++) {
+            Eigen::Map<Vector3f>(&vertices[sorted[t + k] * 6 + 3]) += n;
+        }
+    }
+    for (uint32 v = 0; v < vertex_count; v++) {
+        Eigen::Map<Vector3f> n(&vertices[v * 6 + 3]);
+        float len = n.norm();
+        if (len > 0.0f)
+            n /= len;
+    }
+
+    MeshFile head;
+    head.primitive_type = GL_TRIANGLES;
+    head.index_type = GL_UNSIGNED_INT;
+    head.index_status = IndexStatus::ONLY_INDEX;
+    head.restart_index = UINT32_MAX;
+    head.buffer_count = 0;
+    head.mesh_count = static_cast<uint32>(sorted.size());
+    head.vbo.start = sizeof(MeshFile);
+    head.vbo.length = sizeof(float) * vertices.size();
+    head.ibo.start = head.vbo.start + head.vbo.length;
+    head.ibo.length = sizeof(uint32) * sorted.size();
+    size_t length = sizeof(MeshFile) + head.vbo.length + head.ibo.length;
+    Byte* mesh_data = (Byte*)MemoryTracker::Allocate(length,
+                                                     MemoryTag::Streaming);
+    if (mesh_data == nullptr) {
+        throw std::bad_alloc();
+    }
+    std::memcpy(mesh_data, &head, sizeof(MeshFile));
+    std::memcpy(mesh_data + head.vbo.start, vertices.data(), head.vbo.length);
+    std::memcpy(mesh_data + head.ibo.start, sorted.data(), head.ibo.length);
+    Byte* data = CompressData(mesh_data, &length, sizeof(uint64));
+    MemoryTracker::Free(mesh_data);
+    *(uint64*)data = MESH_HEADER;
+    out.write((char*)data, length);
+    MemoryTracker::Free(data);
+    stat.cluster_count++;
+    stat.output_vertex_count += vertex_count;
+    stat.output_triangle_count += sorted.size() / 3;
+}
+}  // namespace
+
+StreamImportStat MeshStreamImporter::Import(const std::string& path,
+                                            const std::string& save_path,
+                                            const StreamImportArg& arg) {
+    StreamImportStat stat = {};
+    const std::string vertex_tmp = save_path + ".vertex.tmp";
+    const std::string face_tmp = save_path + ".face.tmp";
+    const std::string bucket_tmp = save_path + ".bucket.tmp";
+    const size_t io_buffer = std::max<size_t>(1 << 16, arg.memory_budget / 16);
+    // 预算划分: 分桶阶段页缓存与桶缓冲各占1/4, 单个簇处理占1/2
+    const size_t cache_budget = arg.memory_budget / 4;
+    const size_t bucket_budget = arg.memory_budget / 4;
+    const size_t bytes_per_triangle = 256;  // 三角形坐标+焊接表+输出数据的估计
+    const size_t cluster_triangles =
+        std::max<size_t>(1024, arg.memory_budget / 2 / bytes_per_triangle);
+
+    float bmin[3], bmax[3];
+    {
+        BufferedWriter vw(vertex_tmp, io_buffer), fw(face_tmp, io_buffer);
+        ParseSink sink{vw, fw};
+        std::string ext = path.substr(path.find_last_of('.') + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext == "ply") {
+            ParsePLY(path, sink, io_buffer);
+        } else if (ext == "obj") {
+            ParseOBJ(path, sink, io_buffer);
+        } else {
+            throw std::runtime_error("Unsupported stream mesh format:" + path);
+        }
+        vw.close();
+        fw.close();
+        stat.vertex_count = sink.vertex_count;
+        stat.face_count = sink.face_count;
+        std::memcpy(bmin, sink.bmin, sizeof(bmin));
+        std::memcpy(bmax, sink.bmax, sizeof(bmax));
+    }
+    std::cout << "File:" << path << "\nVertices:" << stat.vertex_count
+              << "\tTriangles:" << stat.face_count << std::endl;
+
+    // 网格分辨率: 使平均每桶的三角形数约为一个簇,
+    // 桶数不超过桶缓冲预算能容纳的最小块数
+    uint64 bucket_target = stat.face_count / cluster_triangles + 1;
+    uint64 bucket_max = std::max<uint64>(1, bucket_budget / bucket_min_block);
+    uint32 grid = 1;
+    while (static_cast<uint64>(grid) * grid * grid < bucket_target &&
+           static_cast<uint64>(grid + 1) * (grid + 1) * (grid + 1) <= bucket_max &&
+           grid < 64)
+        grid++;
+    size_t bucket_count = static_cast<size_t>(grid) * grid * grid;
+    float scale[3];
+    for (int k = 0; k < 3; k++) {
+        float ext = bmax[k] - bmin[k];
+        scale[k] = ext > 0.0f ? grid / ext : 0.0f;
+    }
+    BucketWriter buckets(bucket_tmp, bucket_count, bucket_budget);
+    {
+        VertexPageCache cache(vertex_tmp, cache_budget);
+        BufferedReader fr(face_tmp, io_buffer);
+        uint32 tri[3];
+        float soup[9];
+        while (fr.read(tri, sizeof(tri))) {
+            float centroid[3] = {0.0f, 0.0f, 0.0f};
+            bool valid = true;
+            for (int k = 0; k < 3; k++) {
+                if (tri[k] >= stat.vertex_count) {
+                    valid = false;
+                    break;
+                }
+                const float* p = cache.get(tri[k]);
+                for (int c = 0; c < 3; c++) {
+                    soup[k * 3 + c] = p[c];
+                    centroid[c] += p[c] / 3.0f;
+                }
+            }
+            if (!valid)
+                continue;
+            size_t cell[3];
+            for (int c = 0; c < 3; c++) {
+                int64_t i = static_cast<int64_t>((centroid[c] - bmin[c]) * scale[c]);
+                cell[c] = static_cast<size_t>(i < 0 ? 0 : (i >= grid ? grid - 1 : i));
+            }
+            buckets.write((cell[2] * grid + cell[1]) * grid + cell[0], soup);
+        }
+    }
+    buckets.close();
+    std::remove(vertex_tmp.c_str());
+    std::remove(face_tmp.c_str());
+
+    std::ofstream out(save_path,
+                      std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Cannot open file:" + save_path);
+    }
+    uint64 headcode = MUTI_MESH_HEADER;
+    uint32 cluster_count = 0;
+    out.write((char*)&headcode, sizeof(uint64));
+    out.write((char*)&cluster_count, sizeof(uint32));
+    {
+        std::ifstream in(bucket_tmp, std::ios::in | std::ios::binary);
+        std::vector<float> soup;
+        for (size_t b = 0; b < bucket_count; b++) {
+            soup.clear();
+            for (const DataRange& block : buckets.blocks[b]) {
+                size_t base = soup.size();
+                soup.resize(base + block.length / sizeof(float));
+                in.seekg(block.start);
+                in.read((char*)(soup.data() + base), block.length);
+                // 分布不均时一个桶可能超过预算, 拆分为多个簇
+                if (soup.size() / 9 >= cluster_triangles) {
+                    EmitCluster(soup, arg, out, stat);
+                    soup.clear();
+                }
+            }
+            if (!soup.empty())
+                EmitCluster(soup, arg, out, stat);
+        }
+    }
+    std::remove(bucket_tmp.c_str());
+    cluster_count = static_cast<uint32>(stat.cluster_count);
+    out.seekp(sizeof(uint64));
+    out.write((char*)&cluster_count, sizeof(uint32));
+    out.close();
+    std::cout << "Clusters:" << stat.cluster_count
+              << "\tOutput Vertices:" << stat.output_vertex_count
+              << "\tOutput Triangles:" << stat.output_triangle_count
+              << "\nEND;" << std::endl;
+    return stat;
+}
+}  // namespace Boundless
@@ -0,0 +1,35 @@
+#ifndef _BOUNDLESS_MESH_STREAM_HPP_FILE_
+#define _BOUNDLESS_MESH_STREAM_HPP_FILE_
+#include "bl_resource.hpp"
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 超大网格流式导入
+//
+// 处理无法整体放入内存的PLY/OBJ网格, 分为三个阶段:
+// 1. 流式解析: 顶点位置与三角化后的面写入临时文件, 统计包围盒
+// 2. 空间分桶: 按三角形质心把三角形(展开为坐标)分入规则网格桶
+// 3. 逐桶处理: 焊接顶点, 计算法向量, 优化顶点缓存顺序, 每个簇单独压缩写出
+// 输出为多重Mesh文件(MUTI_MESH_HEADER), 每个簇的顶点格式为 位置vec3 + 法向量vec3
+//
+struct StreamImportArg {
+    size_t memory_budget = 512ULL << 20;  // 峰值内存预算(字节)
+    float weld_epsilon = 0.0f;  // 焊接容差, 0表示坐标完全相同才焊接
+    uint32 vertex_cache_size = 16;  // 顶点缓存优化使用的缓存大小
+};
+struct StreamImportStat {
+    uint64 vertex_count;   // 输入顶点数
+    uint64 face_count;     // 三角化后的输入三角形数
+    uint64 cluster_count;  // 输出簇数
+    uint64 output_vertex_count;
+    uint64 output_triangle_count;
+};
+class MeshStreamImporter {
+   public:
+    // 根据扩展名(.ply/.obj)选择解析器, 结果写入save_path
+    static StreamImportStat Import(const std::string& path,
+                                   const std::string& save_path,
+                                   const StreamImportArg& arg = {});
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_MESH_STREAM_HPP_FILE_
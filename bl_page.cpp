@@ -0,0 +1,447 @@
+#include "bl_page.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+#include "bl_data_struct.hpp"
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX  // windows.h的min/max宏会破坏std::min/std::max
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__linux__) || defined(__APPLE__) || defined(__unix__)
+#include <sys/mman.h>
+#define BL_PAGE_MMAP
+#endif
+
+namespace Boundless {
+namespace {
+enum struct page_kind : uint8_t { hugetlb, thp, small, heap };
+
+struct slab_info {
+    page_kind kind;
+    bool listed;        // 是否在所属级别的available中
+    uint32_t level;     // 块大小为page_min_block << level
+    uint32_t live;      // 已分出的块数
+    uint32_t carved;    // 已切分过的块数, 之后的块从未使用
+    void* free_head;    // 释放的块组成的链表, 指针存放在块的开头
+};
+struct large_info {
+    page_kind kind;
+    size_t size;   // 映射的大小
+    size_t align;
+    void* base;    // 映射的起点(为对齐多映射时与返回的地址不同)
+};
+const uint32_t level_count = 9;  // 4KB ... 1MB, 更大的请求单独映射
+struct level_state {
+    std::vector<uintptr_t> available;  // 有空闲块的slab
+    uint32_t empty_slabs;
+};
+
+class provider {
+    std::mutex mut;
+    char* reserve_base;
+    size_t reserve_size;
+    size_t reserve_used;               // 已从预留区切出的slab
+    std::vector<uintptr_t> free_reserve;  // 已归还, 可重新提交的预留slab
+    flat_hash_map<uintptr_t, slab_info> slabs;
+    flat_hash_map<uintptr_t, large_info> larges;
+    level_state levels[level_count];
+    bool huge_pages;
+    size_t hugetlb_skip;  // 剩余跳过显式大页的次数, 归还显式大页时清零
+    page_stats stats;
+
+    void account(page_kind kind, size_t bytes, bool add) {
+        size_t* target = kind == page_kind::hugetlb ? &stats.hugetlb_bytes
+                         : kind == page_kind::thp   ? &stats.thp_bytes
+                                                    : &stats.small_page_bytes;
+        if (add)
+            *target += bytes;
+        else
+            *target -= bytes;
+    }
+    void reserve() {
+#if defined(BL_PAGE_MMAP)
+        for (size_t size = page_default_reserve; size >= 64 * page_slab_size;
+             size /= 2) {
+            void* p = mmap(nullptr, size + page_slab_size, PROT_NONE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (p == MAP_FAILED)
+                continue;
+            // 对齐到page_slab_size, 裁掉两端多余的部分
+            uintptr_t start = reinterpret_cast<uintptr_t>(p);
+            uintptr_t aligned =
+                (start + page_slab_size - 1) & ~(uintptr_t)(page_slab_size - 1);
+            if (aligned > start)
+                munmap(p, aligned - start);
+            size_t tail = page_slab_size - (aligned - start);
+            if (tail > 0)
+                munmap(reinterpret_cast<void*>(aligned + size), tail);
+            reserve_base = reinterpret_cast<char*>(aligned);
+            reserve_size = size;
+            return;
+        }
+#elif defined(_WIN32)
+        for (size_t size = page_default_reserve; size >= 64 * page_slab_size;
+             size /= 2) {
+            // 先预留再释放, 在得到的范围内重新预留对齐的地址
+            void* p = VirtualAlloc(nullptr, size + page_slab_size, MEM_RESERVE,
+                                   PAGE_NOACCESS);
+            if (p == nullptr)
+                continue;
+            uintptr_t aligned = (reinterpret_cast<uintptr_t>(p) +
+                                 page_slab_size - 1) &
+                                ~(uintptr_t)(page_slab_size - 1);
+            VirtualFree(p, 0, MEM_RELEASE);
+            p = VirtualAlloc(reinterpret_cast<void*>(aligned), size,
+                             MEM_RESERVE, PAGE_NOACCESS);
+            if (p == nullptr)
+                continue;
+            reserve_base = static_cast<char*>(p);
+            reserve_size = size;
+            return;
+        }
+#endif
+    }
+    // 显式大页映射, 失败返回nullptr
+    void* map_hugetlb(size_t size) {
+        if (!huge_pages)
+            return nullptr;
+        if (hugetlb_skip > 0) {
+            hugetlb_skip--;
+            return nullptr;
+        }
+#if defined(BL_PAGE_MMAP) && defined(MAP_HUGETLB)
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+            return p;
+#elif defined(_WIN32)
+        // 需要SeLockMemoryPrivilege, 没有时失败
+        if (GetLargePageMinimum() == page_slab_size) {
+            void* p = VirtualAlloc(nullptr, size,
+                                   MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                                   PAGE_READWRITE);
+            if (p)
+                return p;
+        }
+#endif
+        hugetlb_skip = page_hugetlb_retry;
+        return nullptr;
+    }
+    void unmap_hugetlb(void* p, size_t size) {
+#if defined(BL_PAGE_MMAP)
+        munmap(p, size);
+#elif defined(_WIN32)
+        static_cast<void>(size);
+        VirtualFree(p, 0, MEM_RELEASE);
+#else
+        static_cast<void>(p);
+        static_cast<void>(size);
+#endif
+    }
+    // 对已可读写的内存请求透明大页
+    page_kind advise(void* p, size_t size) {
+#if defined(BL_PAGE_MMAP) && defined(MADV_HUGEPAGE)
+        if (huge_pages && madvise(p, size, MADV_HUGEPAGE) == 0)
+            return page_kind::thp;
+#else
+        static_cast<void>(p);
+        static_cast<void>(size);
+#endif
+        return page_kind::small;
+    }
+    // 从预留区提交一个slab, 失败返回nullptr
+    void* commit_reserved(page_kind& kind) {
+        char* p;
+        if (!free_reserve.empty()) {
+            p = reinterpret_cast<char*>(free_reserve.back());
+        } else if (reserve_used + page_slab_size <= reserve_size) {
+            p = reserve_base + reserve_used;
+        } else {
+            return nullptr;
+        }
+#if defined(BL_PAGE_MMAP)
+        if (mprotect(p, page_slab_size, PROT_READ | PROT_WRITE) != 0)
+            return nullptr;
+#elif defined(_WIN32)
+        if (!VirtualAlloc(p, page_slab_size, MEM_COMMIT, PAGE_READWRITE))
+            return nullptr;
+#else
+        return nullptr;
+#endif
+        if (!free_reserve.empty())
+            free_reserve.pop_back();
+        else
+            reserve_used += page_slab_size;
+        kind = advise(p, page_slab_size);
+        return p;
+    }
+    void decommit_reserved(void* p) {
+#if defined(BL_PAGE_MMAP)
+        madvise(p, page_slab_size, MADV_DONTNEED);
+        mprotect(p, page_slab_size, PROT_NONE);
+#elif defined(_WIN32)
+        VirtualFree(p, page_slab_size, MEM_DECOMMIT);
+#endif
+        free_reserve.push_back(reinterpret_cast<uintptr_t>(p));
+    }
+    bool in_reserve(uintptr_t p) const {
+        uintptr_t base = reinterpret_cast<uintptr_t>(reserve_base);
+        return reserve_base && p >= base && p < base + reserve_size;
+    }
+    uintptr_t new_slab(uint32_t level) {
+        page_kind kind = page_kind::hugetlb;
+        void* p = map_hugetlb(page_slab_size);
+        if (!p)
+            p = commit_reserved(kind);
+        if (!p) {
+            p = ::operator new(page_slab_size, std::align_val_t(page_slab_size),
+                               std::nothrow);
+            kind = page_kind::heap;
+        }
+        if (!p)
+            return 0;
+        uintptr_t key = reinterpret_cast<uintptr_t>(p);
+        slabs.try_emplace(key, slab_info{kind, true, level, 0, 0, nullptr});
+        levels[level].available.push_back(key);
+        levels[level].empty_slabs++;
+        account(kind, page_slab_size, true);
+        stats.slab_count++;
+        return key;
+    }
+    void release_slab(uintptr_t key, const slab_info& s) {
+        void* p = reinterpret_cast<void*>(key);
+        account(s.kind, page_slab_size, false);
+        if (s.kind == page_kind::hugetlb)
+            hugetlb_skip = 0;  // 大页池有了空闲, 下次重新尝试
+        stats.slab_count--;
+        if (s.kind == page_kind::heap) {
+            ::operator delete(p, std::align_val_t(page_slab_size));
+        } else if (in_reserve(key)) {
+            decommit_reserved(p);
+        } else {
+            unmap_hugetlb(p, page_slab_size);
+        }
+        slabs.erase(key);
+    }
+    void* allocate_block(uint32_t level) {
+        const size_t block = page_min_block << level;
+        level_state& ls = levels[level];
+        slab_info* s = nullptr;
+        uintptr_t key = 0;
+        while (!ls.available.empty()) {
+            key = ls.available.back();
+            s = &slabs.find(key)->second;
+            if (s->free_head || s->carved < page_slab_size / block)
+                break;
+            ls.available.pop_back();  // 已满
+            s->listed = false;
+            s = nullptr;
+        }
+        if (!s) {
+            key = new_slab(level);
+            if (!key)
+                return nullptr;
+            s = &slabs.find(key)->second;
+        }
+        void* p;
+        if (s->free_head) {
+            p = s->free_head;
+            s->free_head = *static_cast<void**>(p);
+        } else {
+            p = reinterpret_cast<char*>(key) + block * s->carved++;
+        }
+        if (s->live++ == 0)
+            ls.empty_slabs--;
+        stats.block_bytes += block;
+        return p;
+    }
+    void deallocate_block(void* p, uint32_t level) {
+        const size_t block = page_min_block << level;
+        level_state& ls = levels[level];
+        uintptr_t key =
+            reinterpret_cast<uintptr_t>(p) & ~(uintptr_t)(page_slab_size - 1);
+        slab_info& s = slabs.find(key)->second;
+        *static_cast<void**>(p) = s.free_head;
+        s.free_head = p;
+        stats.block_bytes -= block;
+        if (!s.listed) {
+            ls.available.push_back(key);
+            s.listed = true;
+        }
+        if (--s.live == 0) {
+            // 每个级别保留一个空slab, 避免在边界上反复映射
+            if (ls.empty_slabs > 0) {
+                ls.available.erase(std::find(ls.available.begin(),
+                                             ls.available.end(), key));
+                release_slab(key, s);
+            } else {
+                ls.empty_slabs++;
+            }
+        }
+    }
+    void* allocate_large(size_t size, size_t alignment) {
+        size_t mapped = (size + page_slab_size - 1) & ~(page_slab_size - 1);
+        large_info info{page_kind::hugetlb, mapped, page_slab_size, nullptr};
+        void* p = nullptr;
+        if (alignment <= page_slab_size)
+            p = info.base = map_hugetlb(mapped);
+        if (!p) {
+            const size_t align = info.align =
+                std::max(alignment, page_slab_size);
+#if defined(BL_PAGE_MMAP)
+            // 多映射align字节以便对齐, 裁掉两端
+            void* raw = mmap(nullptr, mapped + align, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (raw == MAP_FAILED)
+                return nullptr;
+            uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+            uintptr_t aligned = (start + align - 1) & ~(uintptr_t)(align - 1);
+            if (aligned > start)
+                munmap(raw, aligned - start);
+            if (start + mapped + align > aligned + mapped)
+                munmap(reinterpret_cast<void*>(aligned + mapped),
+                       start + mapped + align - aligned - mapped);
+            p = info.base = reinterpret_cast<void*>(aligned);
+            info.kind = advise(p, mapped);
+#elif defined(_WIN32)
+            void* raw = VirtualAlloc(nullptr, mapped + align, MEM_RESERVE,
+                                     PAGE_NOACCESS);
+            if (!raw)
+                return nullptr;
+            uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + align - 1) &
+                                ~(uintptr_t)(align - 1);
+            p = VirtualAlloc(reinterpret_cast<void*>(aligned), mapped,
+                             MEM_COMMIT, PAGE_READWRITE);
+            if (!p) {
+                VirtualFree(raw, 0, MEM_RELEASE);
+                return nullptr;
+            }
+            info.base = raw;
+            info.kind = page_kind::small;
+#else
+            p = info.base =
+                ::operator new(mapped, std::align_val_t(align), std::nothrow);
+            if (!p)
+                return nullptr;
+            info.kind = page_kind::heap;
+#endif
+        }
+        larges.try_emplace(reinterpret_cast<uintptr_t>(p), info);
+        account(info.kind, mapped, true);
+        stats.large_count++;
+        stats.block_bytes += mapped;
+        return p;
+    }
+    void deallocate_large(void* p) {
+        auto it = larges.find(reinterpret_cast<uintptr_t>(p));
+        const large_info info = it->second;
+        larges.erase(it);
+        account(info.kind, info.size, false);
+        if (info.kind == page_kind::hugetlb)
+            hugetlb_skip = 0;
+        stats.large_count--;
+        stats.block_bytes -= info.size;
+#if defined(BL_PAGE_MMAP)
+        munmap(info.base, info.size);
+#elif defined(_WIN32)
+        VirtualFree(info.base, 0, MEM_RELEASE);
+#else
+        ::operator delete(info.base, std::align_val_t(info.align));
+#endif
+    }
+    static uint32_t level_of(size_t size) {
+        uint32_t level = 0;
+        while ((page_min_block << level) < size)
+            level++;
+        return level;
+    }
+
+   public:
+    provider()
+        : reserve_base(nullptr),
+          reserve_size(0),
+          reserve_used(0),
+          levels(),
+          huge_pages(true),
+          hugetlb_skip(0),
+          stats() {
+        reserve();
+        stats.reserved = reserve_size;
+    }
+    void* allocate(size_t size, size_t alignment) {
+        size_t need = std::max(size, alignment);
+        if (need < page_min_block) {
+            return ::operator new(size, std::align_val_t(alignment),
+                                  std::nothrow);
+        }
+        std::lock_guard<std::mutex> lock(mut);
+        if (need > page_slab_size / 2)
+            return allocate_large(size, alignment);
+        return allocate_block(level_of(need));
+    }
+    void deallocate(void* p, size_t size, size_t alignment) {
+        if (p == nullptr)
+            return;
+        size_t need = std::max(size, alignment);
+        if (need < page_min_block) {
+            ::operator delete(p, std::align_val_t(alignment));
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mut);
+        if (need > page_slab_size / 2)
+            deallocate_large(p);
+        else
+            deallocate_block(p, level_of(need));
+    }
+    page_stats get_stats() {
+        std::lock_guard<std::mutex> lock(mut);
+        page_stats s = stats;
+#if defined(__linux__)
+        if (FILE* f = std::fopen("/proc/self/smaps_rollup", "r")) {
+            char line[256];
+            while (std::fgets(line, sizeof(line), f)) {
+                unsigned long long kb;
+                if (std::sscanf(line, "AnonHugePages: %llu kB", &kb) == 1)
+                    s.thp_resident = static_cast<size_t>(kb) << 10;
+            }
+            std::fclose(f);
+        }
+#endif
+        size_t thp_backed = std::min(s.thp_resident, s.thp_bytes);
+        s.tlb_entries = (s.hugetlb_bytes + thp_backed) / page_slab_size +
+                        (s.thp_bytes - thp_backed + s.small_page_bytes) / 4096;
+        return s;
+    }
+    void use_huge_pages(bool enable) {
+        std::lock_guard<std::mutex> lock(mut);
+        huge_pages = enable;
+        hugetlb_skip = 0;
+    }
+};
+// 不析构: 其他静态对象析构时可能仍在释放内存
+provider& instance() {
+    static provider* p = new provider;
+    return *p;
+}
+}  // namespace
+
+void* page_allocate(size_t size, size_t alignment) {
+    return instance().allocate(size, alignment);
+}
+void page_deallocate(void* ptr, size_t size, size_t alignment) {
+    instance().deallocate(ptr, size, alignment);
+}
+page_stats get_page_stats() {
+    return instance().get_stats();
+}
+void page_use_huge_pages(bool enable) {
+    instance().use_huge_pages(enable);
+}
+}  // namespace Boundless
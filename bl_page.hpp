@@ -0,0 +1,45 @@
+#ifndef _BOUNDLESS_PAGE_HPP_FILE_
+#define _BOUNDLESS_PAGE_HPP_FILE_
+#include <cstddef>
+namespace Boundless {
+///////////////////////////////////////////////
+// 大页内存提供者
+//
+// 为对象池块组, 逐帧内存块和大块缓冲区提供以大页为后备的内存, 减少TLB缺失.
+// 不超过page_slab_size/2的请求按2的幂分级, 从2MB对齐的slab中切分, 块按自身大小对齐:
+// slab优先使用显式大页(MAP_HUGETLB/MEM_LARGE_PAGES), 失败后从启动时预留的
+// 地址空间中提交, 并以madvise(MADV_HUGEPAGE)请求透明大页; 都不可用时退回堆.
+// 更大的请求单独映射, 同样先尝试显式大页, 大小取整到page_slab_size.
+// 显式大页失败(大页池耗尽或未配置)后, 之后的page_hugetlb_retry次映射不再尝试;
+// 本提供者归还显式大页时立即恢复尝试.
+// slab全部空闲时(每个级别保留一个)归还给系统.
+// 小于page_min_block的请求直接从堆上分配. 释放时需要给出分配时的大小和对齐.
+// 线程安全.
+//
+const size_t page_slab_size = 2ULL << 20;  // 2MB, 与x86-64/ARM64的大页一致
+const size_t page_min_block = 4096;
+const size_t page_default_reserve = 64ULL << 30;  // 预留64GB地址空间
+const size_t page_hugetlb_retry = 64;
+
+struct page_stats {
+    size_t reserved;          // 预留的地址空间
+    size_t hugetlb_bytes;     // 显式大页
+    size_t thp_bytes;         // 请求了透明大页的内存
+    size_t small_page_bytes;  // 只能使用普通页的内存(含退回堆的部分)
+    size_t slab_count;
+    size_t large_count;       // 单独映射的大块
+    size_t block_bytes;       // 已分出的块的总字节数
+    size_t thp_resident;      // 实际由透明大页支持的匿名内存(全进程, 仅Linux)
+    size_t tlb_entries;       // 估算覆盖以上内存所需的TLB项数
+};
+
+// 失败时返回nullptr; alignment不能超过max(size取整后的大小, page_slab_size)
+void* page_allocate(size_t size, size_t alignment = page_min_block);
+void page_deallocate(void* ptr,
+                     size_t size,
+                     size_t alignment = page_min_block);
+page_stats get_page_stats();
+// 关闭后新的slab和大块不再尝试显式大页和透明大页(用于对比测试)
+void page_use_huge_pages(bool enable);
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_PAGE_HPP_FILE_
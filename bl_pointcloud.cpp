@@ -0,0 +1,443 @@
+#include "bl_pointcloud.hpp"
+
+#include <queue>
+#include <unordered_set>
+
+namespace Boundless {
+///////////////////////////////////////////////
+// 点云八叉树烘焙
+//
+namespace {
+struct CookNode {
+    float bmin[3];
+    float size;
+    uint32 level;
+    int32 children[8];
+    std::vector<CloudPoint> points;
+};
+// 网格子采样: 每个网格单元只保留第一个落入的点, 其余点下放到对应的八分体
+void BuildCookNode(std::vector<CookNode>& nodes,
+                   uint32 index,
+                   std::vector<CloudPoint>&& points,
+                   const PointCloudCookArg& arg) {
+    for (int i = 0; i < 8; i++)
+        nodes[index].children[i] = -1;
+    if (points.size() <= arg.max_node_points ||
+        nodes[index].level >= arg.max_depth) {
+        nodes[index].points = std::move(points);
+        return;
+    }
+    const float bmin[3] = {nodes[index].bmin[0], nodes[index].bmin[1],
+                           nodes[index].bmin[2]};
+    const float size = nodes[index].size;
+    const float half = size * 0.5f;
+    const float scale = arg.grid_size / size;
+    std::unordered_set<uint64> occupied;
+    occupied.reserve(points.size() / 2);
+    std::vector<CloudPoint> kept, octants[8];
+    for (const CloudPoint& p : points) {
+        uint64 cell[3];
+        int octant = 0;
+        for (int k = 0; k < 3; k++) {
+            float rel = p.position[k] - bmin[k];
+            int64_t c = static_cast<int64_t>(rel * scale);
+            c = c < 0 ? 0 : (c >= arg.grid_size ? arg.grid_size - 1 : c);
+            cell[k] = static_cast<uint64>(c);
+            octant |= (rel >= half) << k;
+        }
+        uint64 key = (cell[0] << 42) | (cell[1] << 21) | cell[2];
+        if (occupied.insert(key).second) {
+            kept.push_back(p);
+        } else {
+            octants[octant].push_back(p);
+        }
+    }
+    std::vector<CloudPoint>().swap(points);
+    nodes[index].points = std::move(kept);
+    for (int o = 0; o < 8; o++) {
+        if (octants[o].empty())
+            continue;
+        CookNode child;
+        for (int k = 0; k < 3; k++)
+            child.bmin[k] = bmin[k] + ((o >> k & 1) ? half : 0.0f);
+        child.size = half;
+        child.level = nodes[index].level + 1;
+        uint32 ci = static_cast<uint32>(nodes.size());
+        nodes.push_back(std::move(child));
+        nodes[index].children[o] = static_cast<int32>(ci);
+        BuildCookNode(nodes, ci, std::move(octants[o]), arg);
+    }
+}
+}  // namespace
+
+void PointCloud::GenPointCloudFile(const CloudPoint* points,
+                                   size_t count,
+                                   const std::string& save_path,
+                                   const PointCloudCookArg& arg) {
+    if (count == 0) {
+        throw std::runtime_error("Point cloud is empty.");
+    }
+    float bmin[3], bmax[3];
+    for (int k = 0; k < 3; k++) {
+        bmin[k] = bmax[k] = points[0].position[k];
+    }
+    for (size_t i = 1; i < count; i++) {
+        for (int k = 0; k < 3; k++) {
+            bmin[k] = std::min(bmin[k], points[i].position[k]);
+            bmax[k] = std::max(bmax[k], points[i].position[k]);
+        }
+    }
+    std::vector<CookNode> nodes(1);
+    float size = std::max({bmax[0] - bmin[0], bmax[1] - bmin[1],
+                           bmax[2] - bmin[2], 1e-6f}) *
+                 1.0001f;
+    for (int k = 0; k < 3; k++)
+        nodes[0].bmin[k] = bmin[k];
+    nodes[0].size = size;
+    nodes[0].level = 0;
+    BuildCookNode(nodes, 0, std::vector<CloudPoint>(points, points + count),
+                  arg);
+
+    // 按层序重新排列节点, 使同一节点的子节点连续
+    std::vector<uint32> order;
+    std::vector<PointNodeFile> table;
+    order.reserve(nodes.size());
+    table.resize(nodes.size());
+    std::queue<uint32> bfs;
+    bfs.push(0);
+    uint32 next = 1;
+    while (!bfs.empty()) {
+        uint32 i = bfs.front();
+        bfs.pop();
+        PointNodeFile& nf = table[order.size()];
+        const CookNode& cn = nodes[i];
+        for (int k = 0; k < 3; k++)
+            nf.bmin[k] = cn.bmin[k];
+        nf.size = cn.size;
+        nf.spacing = cn.size / arg.grid_size;
+        nf.level = cn.level;
+        nf.point_count = static_cast<uint32>(cn.points.size());
+        nf.first_child = next;
+        nf.child_mask = 0;
+        nf.reserved = 0;
+        for (int o = 0; o < 8; o++) {
+            if (cn.children[o] >= 0) {
+                nf.child_mask |= 1u << o;
+                bfs.push(static_cast<uint32>(cn.children[o]));
+                next++;
+            }
+        }
+        order.push_back(i);
+    }
+
+    std::ofstream fout(save_path, std::ios_base::out | std::ios_base::binary |
+                                      std::ios_base::trunc);
+    if (!fout.is_open()) {
+        throw std::runtime_error("Cannot open file:" + save_path);
+    }
+    uint64 headcode = POINTCLOUD_HEADER;
+    PointCloudFile head;
+    head.point_count = count;
+    head.node_count = static_cast<uint32>(table.size());
+    head.reserved = 0;
+    fout.write((char*)&headcode, sizeof(uint64));
+    fout.write((char*)&head, sizeof(PointCloudFile));
+    std::streampos table_pos = fout.tellp();
+    fout.write((char*)table.data(), sizeof(PointNodeFile) * table.size());
+    // 每个节点单独压缩, 运行时可按节点随机读取
+    for (size_t i = 0; i < order.size(); i++) {
+        std::vector<CloudPoint>& pts = nodes[order[i]].points;
+        size_t length = sizeof(CloudPoint) * pts.size();
+        Byte* data = CompressData((const Byte*)pts.data(), &length);
+        table[i].chunk.start = static_cast<size_t>(fout.tellp());
+        table[i].chunk.length = length;
+        fout.write((char*)data, length);
+        MemoryTracker::Free(data);
+        std::vector<CloudPoint>().swap(pts);
+    }
+    fout.seekp(table_pos);
+    fout.write((char*)table.data(), sizeof(PointNodeFile) * table.size());
+    fout.close();
+    std::cout << "File:" << save_path << "\nPoints:" << count
+              << "\tNodes:" << table.size() << std::endl;
+}
+void PointCloud::GenPointCloudFile(const std::string& path,
+                                   const PointCloudCookArg& arg) {
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, 0);
+    if (!scene || !scene->mRootNode) {
+        throw std::runtime_error(importer.GetErrorString());
+    }
+    aiMemoryInfo scene_memory;
+    importer.GetMemoryRequirements(scene_memory);
+    ExternalMemoryScope assimp_memory(MemoryTag::Assimp, scene_memory.total);
+    std::vector<CloudPoint> points;
+    for (size_t i = 0; i < scene->mNumMeshes; i++) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        if (mesh->HasFaces())
+            continue;
+        points.reserve(points.size() + mesh->mNumVertices);
+        for (size_t j = 0; j < mesh->mNumVertices; j++) {
+            CloudPoint p;
+            p.position[0] = mesh->mVertices[j].x;
+            p.position[1] = mesh->mVertices[j].y;
+            p.position[2] = mesh->mVertices[j].z;
+            if (mesh->HasVertexColors(0)) {
+                const aiColor4D& c = mesh->mColors[0][j];
+                p.color[0] = static_cast<Byte>(std::clamp(c.r, 0.0f, 1.0f) * 255.0f);
+                p.color[1] = static_cast<Byte>(std::clamp(c.g, 0.0f, 1.0f) * 255.0f);
+                p.color[2] = static_cast<Byte>(std::clamp(c.b, 0.0f, 1.0f) * 255.0f);
+                p.color[3] = static_cast<Byte>(std::clamp(c.a, 0.0f, 1.0f) * 255.0f);
+            } else {
+                p.color[0] = p.color[1] = p.color[2] = p.color[3] = 255;
+            }
+            points.push_back(p);
+        }
+    }
+    if (points.empty()) {
+        throw std::runtime_error("No point cloud (vertex only mesh) in file:" +
+                                 path);
+    }
+    GenPointCloudFile(points.data(), points.size(), path + ".pointcloud", arg);
+}
+
+///////////////////////////////////////////////
+// 点云运行时
+//
+Program PointCloud::shader;
+
+PointCloud::PointCloud()
+    : pending_loads(0),
+      resident_bytes(0),
+      frame(0),
+      point_count(0),
+      vertex_array(0) {}
+PointCloud::~PointCloud() {
+    // 等待后台加载任务结束, 它们持有this指针
+    while (pending_loads.load() > 0) {
+        std::this_thread::yield();
+    }
+    uint32 index;
+    while (loaded_queue.try_pop(index)) {
+        MemoryTracker::Free(nodes[index].cpu_data);
+    }
+    for (Node& n : nodes) {
+        if (n.state == NodeState::RESIDENT)
+            MemoryTracker::DeleteBuffers(1, &n.buffer);
+    }
+    glDeleteVertexArrays(1, &vertex_array);
+}
+void PointCloud::InitShader() {
+    shader.Init({{pointcloud_vertshader_path, GL_VERTEX_SHADER},
+                 {pointcloud_fragshader_path, GL_FRAGMENT_SHADER}});
+}
+void PointCloud::Open(const std::string& file_path) {
+    std::ifstream fin(file_path, std::ios_base::in | std::ios_base::binary);
+    if (!fin.is_open()) {
+        throw std::runtime_error("Cannot open file:" + file_path);
+    }
+    uint64 headcode;
+    fin.read((char*)&headcode, sizeof(uint64));
+    if (headcode != POINTCLOUD_HEADER) {
+        throw std::runtime_error("Point cloud head code error.");
+    }
+    PointCloudFile head;
+    fin.read((char*)&head, sizeof(PointCloudFile));
+    std::vector<PointNodeFile> table(head.node_count);
+    fin.read((char*)table.data(), sizeof(PointNodeFile) * head.node_count);
+    fin.close();
+
+    path = file_path;
+    point_count = head.point_count;
+    nodes.resize(head.node_count);
+    for (size_t i = 0; i < table.size(); i++) {
+        nodes[i].info = table[i];
+        nodes[i].state = NodeState::UNLOADED;
+        nodes[i].buffer = 0;
+        nodes[i].cpu_data = nullptr;
+        nodes[i].last_visible = 0;
+    }
+    glCreateVertexArrays(1, &vertex_array);
+    glEnableVertexArrayAttrib(vertex_array, pointcloud_position_attrib);
+    glEnableVertexArrayAttrib(vertex_array, pointcloud_color_attrib);
+    glVertexArrayAttribFormat(vertex_array, pointcloud_position_attrib, 3,
+                              GL_FLOAT, GL_FALSE, 0);
+    glVertexArrayAttribFormat(vertex_array, pointcloud_color_attrib, 4,
+                              GL_UNSIGNED_BYTE, GL_TRUE, 12);
+    glVertexArrayAttribBinding(vertex_array, pointcloud_position_attrib, 0);
+    glVertexArrayAttribBinding(vertex_array, pointcloud_color_attrib, 0);
+}
+void PointCloud::RequestLoad(uint32 index) {
+    nodes[index].state = NodeState::LOADING;
+    pending_loads++;
+    DataRange chunk = nodes[index].info.chunk;
+    DefaultThreadPool().submit([this, index, chunk]() {
+        Byte* result = nullptr;
+        try {
+            std::ifstream fin(path, std::ios_base::in | std::ios_base::binary);
+            if (fin.is_open()) {
+                Byte* data = (Byte*)MemoryTracker::Allocate(
+                    chunk.length, MemoryTag::Streaming);
+                if (data) {
+                    fin.seekg(chunk.start);
+                    fin.read((char*)data, chunk.length);
+                    size_t length;
+                    try {
+                        result = UncompressData(data, &length);
+                    } catch (...) {
+                        result = nullptr;
+                    }
+                    MemoryTracker::Free(data);
+                }
+            }
+        } catch (...) {
+            result = nullptr;
+        }
+        nodes[index].cpu_data = result;
+        loaded_queue.push(index);
+        pending_loads--;
+    });
+}
+void PointCloud::UploadLoaded() {
+    uint32 index;
+    for (uint32 i = 0; i < settings.max_uploads_per_frame; i++) {
+        if (!loaded_queue.try_pop(index))
+            break;
+        Node& n = nodes[index];
+        if (!n.cpu_data) {
+            WARNING("PointCloud", "节点数据加载失败:", index);
+            n.state = NodeState::UNLOADED;
+            continue;
+        }
+        size_t bytes = sizeof(CloudPoint) * n.info.point_count;
+        glCreateBuffers(1, &n.buffer);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, n.buffer, bytes,
+                                     n.cpu_data, 0);
+        MemoryTracker::Free(n.cpu_data);
+        n.cpu_data = nullptr;
+        n.state = NodeState::RESIDENT;
+        resident_bytes += bytes;
+    }
+}
+void PointCloud::EvictToBudget() {
+    if (resident_bytes <= settings.memory_budget)
+        return;
+    std::vector<uint32> candidates;
+    for (uint32 i = 0; i < nodes.size(); i++) {
+        if (nodes[i].state == NodeState::RESIDENT &&
+            nodes[i].last_visible < frame) {
+            candidates.push_back(i);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](uint32 a, uint32 b) {
+        return nodes[a].last_visible < nodes[b].last_visible;
+    });
+    for (uint32 i : candidates) {
+        if (resident_bytes <= settings.memory_budget)
+            break;
+        Node& n = nodes[i];
+        MemoryTracker::DeleteBuffers(1, &n.buffer);
+        n.buffer = 0;
+        n.state = NodeState::UNLOADED;
+        resident_bytes -= sizeof(CloudPoint) * n.info.point_count;
+    }
+}
+void PointCloud::Update(const Matrix4f& mvp_matrix) {
+    frame++;
+    visible.clear();
+    if (nodes.empty())
+        return;
+    UploadLoaded();
+
+    // 由MVP矩阵提取裁剪空间的6个平面
+    Vector4f planes[6];
+    for (int i = 0; i < 3; i++) {
+        planes[i * 2] = mvp_matrix.row(3).transpose() + mvp_matrix.row(i).transpose();
+        planes[i * 2 + 1] =
+            mvp_matrix.row(3).transpose() - mvp_matrix.row(i).transpose();
+    }
+    const float pixel_scale =
+        settings.projection_scale * settings.screen_height * 0.5f;
+    auto projected_spacing = [&](const PointNodeFile& info) {
+        float half = info.size * 0.5f;
+        Vector4f center(info.bmin[0] + half, info.bmin[1] + half,
+                        info.bmin[2] + half, 1.0f);
+        float w = mvp_matrix.row(3).dot(center) - half * 1.7320508f;
+        if (w <= 1e-6f)
+            return std::numeric_limits<float>::infinity();
+        return info.spacing * pixel_scale / w;
+    };
+    auto in_frustum = [&](const PointNodeFile& info) {
+        for (const Vector4f& pl : planes) {
+            // 取包围盒在平面法向上最远的角点
+            Vector4f p(info.bmin[0] + (pl.x() > 0.0f ? info.size : 0.0f),
+                       info.bmin[1] + (pl.y() > 0.0f ? info.size : 0.0f),
+                       info.bmin[2] + (pl.z() > 0.0f ? info.size : 0.0f), 1.0f);
+            if (pl.dot(p) < 0.0f)
+                return false;
+        }
+        return true;
+    };
+
+    // 按投影点间距从大到小细分, 直到满足像素阈值或达到点数预算
+    std::priority_queue<std::pair<float, uint32>> queue;
+    queue.push({projected_spacing(nodes[0].info), 0});
+    uint64 points = 0;
+    uint32 loads = 0;
+    while (!queue.empty()) {
+        auto [spacing, index] = queue.top();
+        queue.pop();
+        Node& n = nodes[index];
+        if (!in_frustum(n.info))
+            continue;
+        if (points + n.info.point_count > settings.point_budget)
+            continue;
+        points += n.info.point_count;
+        visible.push_back(index);
+        n.last_visible = frame;
+        if (n.state == NodeState::UNLOADED &&
+            loads < settings.max_uploads_per_frame) {
+            RequestLoad(index);
+            loads++;
+        }
+        if (spacing <= settings.min_pixel_spacing)
+            continue;
+        uint32 child = n.info.first_child;
+        for (int o = 0; o < 8; o++) {
+            if (n.info.child_mask >> o & 1) {
+                queue.push({projected_spacing(nodes[child].info), child});
+                child++;
+            }
+        }
+    }
+    EvictToBudget();
+}
+void PointCloud::Draw(const Matrix4f& mvp_matrix) {
+    if (visible.empty())
+        return;
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    glBindVertexArray(vertex_array);
+    Program::UseProgram(shader);
+    glProgramUniformMatrix4fv(shader.GetID(), pointcloud_mvpmatrix_uniform, 1,
+                              GL_FALSE, &mvp_matrix(0, 0));
+    glProgramUniform1f(shader.GetID(), pointcloud_pointsize_uniform,
+                       settings.point_size);
+    for (uint32 index : visible) {
+        const Node& n = nodes[index];
+        if (n.state != NodeState::RESIDENT)
+            continue;
+        glVertexArrayVertexBuffer(vertex_array, 0, n.buffer, 0,
+                                  sizeof(CloudPoint));
+        glDrawArrays(GL_POINTS, 0, n.info.point_count);
+    }
+    glDisable(GL_PROGRAM_POINT_SIZE);
+}
+void PointCloudRender::draw(const Matrix4f& mvp_matrix,
+                            const Matrix4f&,
+                            const Matrix4f&,
+                            const Vector3f&) {
+    PointCloud* cloud = (PointCloud*)data_ptr;
+    cloud->Update(mvp_matrix);
+    cloud->Draw(mvp_matrix);
+}
+}  // namespace Boundless
@@ -0,0 +1,125 @@
+#ifndef _BOUNDLESS_POINTCLOUD_HPP_FILE_
+#define _BOUNDLESS_POINTCLOUD_HPP_FILE_
+#include "bl_render.hpp"
+#include "bl_thread.hpp"
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 点云相关
+//
+
+// 单个点的存储格式: 位置vec3 + 颜色RGBA8, 共16字节
+struct CloudPoint {
+    float position[3];
+    Byte color[4];
+};
+// 八叉树节点信息, 节点按层序存储, 同一节点的子节点连续存放
+// 每个节点只存储对其父节点的补充点(子采样), 绘制时父子节点叠加
+struct PointNodeFile {
+    float bmin[3];        // 节点立方体最小角
+    float size;           // 节点立方体边长
+    float spacing;        // 节点内点的最小间距
+    uint32 level;         // 节点深度
+    uint32 point_count;   // 节点点数
+    uint32 first_child;   // 第一个子节点编号
+    uint32 child_mask;    // 子节点掩码, 第i位表示第i个八分体存在
+    uint32 reserved;
+    DataRange chunk;      // 节点数据在文件中的位置(CompressData格式)
+};
+struct PointCloudFile {
+    uint64 point_count;
+    uint32 node_count;
+    uint32 reserved;
+    // 之后为PointNodeFile[node_count], 再之后为各节点的压缩数据
+};
+const size_t POINTCLOUD_HEADER = 0xF244712355FF0005;  // 点云文件头代码
+// 点云烘焙参数
+struct PointCloudCookArg {
+    uint32 grid_size = 128;         // 每个节点的子采样网格分辨率
+    uint32 max_node_points = 20000;  // 节点点数小于该值时直接作为叶子
+    uint32 max_depth = 20;          // 最大深度
+};
+// 点云运行时参数
+struct PointCloudSettings {
+    uint64 point_budget = 10000000;         // 每帧最多绘制的点数
+    size_t memory_budget = 512ULL << 20;    // 显存中点数据最大字节数
+    float min_pixel_spacing = 1.0f;         // 节点点间距投影小于该像素数时停止细分
+    uint32 max_uploads_per_frame = 16;      // 每帧最多上传的节点数
+    float screen_height = 600.0f;           // 视口高度(像素)
+    float projection_scale = 1.0f;          // 投影矩阵(1,1)项
+    float point_size = 1.0f;                // 点的绘制大小(像素)
+};
+
+const GLuint pointcloud_mvpmatrix_uniform = 0;
+const GLuint pointcloud_pointsize_uniform = 1;
+const GLuint pointcloud_position_attrib = 0;
+const GLuint pointcloud_color_attrib = 1;
+const char* const pointcloud_vertshader_path =
+    ".\\shader\\pointcloud_shader_vertex.glsl";
+const char* const pointcloud_fragshader_path =
+    ".\\shader\\pointcloud_shader_fragment.glsl";
+
+class PointCloud {
+    enum struct NodeState : int { UNLOADED, LOADING, LOADED, RESIDENT };
+    struct Node {
+        PointNodeFile info;
+        NodeState state;
+        GLuint buffer;
+        Byte* cpu_data;  // 后台线程解压完成, 等待上传的数据
+        uint64 last_visible;
+    };
+    std::string path;
+    std::vector<Node> nodes;
+    std::vector<uint32> visible;
+    threadsafe_queue<uint32> loaded_queue;
+    std::atomic<uint32> pending_loads;
+    size_t resident_bytes;
+    uint64 frame;
+    uint64 point_count;
+    GLuint vertex_array;
+
+    void RequestLoad(uint32 index);
+    void UploadLoaded();
+    void EvictToBudget();
+
+   public:
+    PointCloudSettings settings;
+    static Program shader;
+
+    PointCloud();
+    PointCloud(const PointCloud&) = delete;
+    PointCloud& operator=(const PointCloud&) = delete;
+    ~PointCloud();
+
+    // 打开点云文件, 仅读取层级信息, 节点数据按需流式加载
+    void Open(const std::string& path);
+    // 根据视图选择可见节点, 并发起加载/上传/淘汰
+    void Update(const Matrix4f& mvp_matrix);
+    // 绘制当前可见且已上传的节点
+    void Draw(const Matrix4f& mvp_matrix);
+    uint64 GetPointCount() const { return point_count; }
+    size_t GetResidentBytes() const { return resident_bytes; }
+    size_t GetVisibleNodeCount() const { return visible.size(); }
+
+    static void InitShader();
+    // Gen~()方法 从点数据构建八叉树并写入文件
+    static void GenPointCloudFile(const CloudPoint* points,
+                                  size_t count,
+                                  const std::string& save_path,
+                                  const PointCloudCookArg& arg = {});
+    // 从外部文件中的无面网格(仅顶点)生成点云文件
+    static void GenPointCloudFile(const std::string& path,
+                                  const PointCloudCookArg& arg = {});
+};
+
+class PointCloudRender : public RenderObject {
+   public:
+    PointCloudRender(PointCloud* cloud) { this->data_ptr = cloud; }
+    void draw(const Matrix4f& mvp_matrix,
+              const Matrix4f& model_matrix,
+              const Matrix4f& normal_matrix,
+              const Vector3f& eye_dir);
+    ~PointCloudRender() {}
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_POINTCLOUD_HPP_FILE_
@@ -0,0 +1,209 @@
+#include "bl_readback.hpp"
+
+namespace Boundless {
+ReadbackService::ReadbackService() : running_callbacks(0) {}
+ReadbackService::~ReadbackService() {
+    Flush();
+    while (running_callbacks.load() > 0) {
+        std::this_thread::yield();
+    }
+    for (PackBuffer& b : buffers) {
+        glUnmapNamedBuffer(b.buffer);
+        MemoryTracker::DeleteBuffers(1, &b.buffer);
+    }
+}
+void ReadbackService::Reclaim() {
+    uint32 slot;
+    while (released.try_pop(slot)) {
+        free_slots.push_back(slot);
+    }
+}
+uint32 ReadbackService::AcquireBuffer(size_t length) {
+    Reclaim();
+    // 优先使用足够大的最小空闲缓冲区
+    size_t best = free_slots.size();
+    for (size_t i = 0; i < free_slots.size(); i++) {
+        size_t cap = buffers[free_slots[i]].capacity;
+        if (cap >= length &&
+            (best == free_slots.size() ||
+             cap < buffers[free_slots[best]].capacity)) {
+            best = i;
+        }
+    }
+    if (best < free_slots.size()) {
+        uint32 slot = free_slots[best];
+        free_slots[best] = free_slots.back();
+        free_slots.pop_back();
+        return slot;
+    }
+    size_t capacity = min_readback_buffer_size;
+    while (capacity < length) {
+        capacity *= 2;
+    }
+    const GLbitfield flags =
+        GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    PackBuffer b;
+    b.capacity = capacity;
+    glCreateBuffers(1, &b.buffer);
+    MemoryTracker::BufferStorage(MemoryTag::Render, b.buffer, capacity, nullptr,
+                                 flags | GL_CLIENT_STORAGE_BIT);
+    b.mapped = (Byte*)glMapNamedBufferRange(b.buffer, 0, capacity, flags);
+    if (b.mapped == nullptr) {
+        MemoryTracker::DeleteBuffers(1, &b.buffer);
+        throw std::runtime_error("无法映射回读缓冲区");
+    }
+    uint32 slot;
+    if (!free_slots.empty()) {
+        // 空闲的缓冲区都太小: 替换其中一个, 避免池无限增长
+        slot = free_slots.back();
+        free_slots.pop_back();
+        glUnmapNamedBuffer(buffers[slot].buffer);
+        MemoryTracker::DeleteBuffers(1, &buffers[slot].buffer);
+        buffers[slot] = b;
+    } else {
+        slot = static_cast<uint32>(buffers.size());
+        buffers.push_back(b);
+    }
+    return slot;
+}
+void ReadbackService::Submit(uint32 slot,
+                             size_t length,
+                             ReadbackCallback&& callback) {
+    Request req;
+    req.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    req.slot = slot;
+    req.length = length;
+    req.callback = std::move(callback);
+    pending.push_back(std::move(req));
+}
+void ReadbackService::Dispatch(Request& req) {
+    glDeleteSync(req.fence);
+    running_callbacks++;
+    // 工作线程只访问映射的内存, 不调用GL
+    const Byte* data = buffers[req.slot].mapped;
+    DefaultThreadPool().submit(
+        [this, data, slot = req.slot, length = req.length,
+         callback = std::move(req.callback)]() {
+            try {
+                callback(data, length);
+            } catch (const std::exception& e) {
+                WARNING("ReadbackService", "回调抛出异常:", e.what());
+            }
+            released.push(slot);
+            running_callbacks--;
+        });
+}
+void ReadbackService::Update() {
+    Reclaim();
+    // 首次检查时刷新命令队列, 保证栅栏能够到达GPU
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (!pending.empty()) {
+        GLenum res = glClientWaitSync(pending.front().fence, flags, 0);
+        if (res != GL_ALREADY_SIGNALED && res != GL_CONDITION_SATISFIED)
+            break;
+        Dispatch(pending.front());
+        pending.pop_front();
+        flags = 0;
+    }
+}
+void ReadbackService::Flush() {
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (!pending.empty()) {
+        GLenum res =
+            glClientWaitSync(pending.front().fence, flags, 1000000);  // 1ms
+        if (res == GL_TIMEOUT_EXPIRED)
+            continue;
+        if (res == GL_WAIT_FAILED) {
+            WARNING("ReadbackService", "glClientWaitSync失败");
+        }
+        Dispatch(pending.front());
+        pending.pop_front();
+        flags = 0;
+    }
+}
+void ReadbackService::ReadTexture(Texture& tex,
+                                  GLint level,
+                                  GLint x,
+                                  GLint y,
+                                  GLint z,
+                                  GLsizei width,
+                                  GLsizei height,
+                                  GLsizei depth,
+                                  GLenum format,
+                                  GLenum type,
+                                  ReadbackCallback callback) {
+    const size_t length = static_cast<size_t>(width) * height * depth *
+                          TexturePixelSize(format, type);
+    if (length == 0) {
+        throw std::runtime_error("ReadbackService: 不支持的像素格式或空区域");
+    }
+    uint32 slot = AcquireBuffer(length);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[slot].buffer);
+    glGetTextureSubImage(tex.GetID(), level, x, y, z, width, height, depth,
+                         format, type, static_cast<GLsizei>(length), nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    Submit(slot, length, std::move(callback));
+}
+void ReadbackService::ReadTexture(Texture& tex,
+                                  GLint level,
+                                  GLenum format,
+                                  GLenum type,
+                                  ReadbackCallback callback) {
+    GLint target, width, height, depth;
+    glGetTextureParameteriv(tex.GetID(), GL_TEXTURE_TARGET, &target);
+    glGetTextureLevelParameteriv(tex.GetID(), level, GL_TEXTURE_WIDTH, &width);
+    glGetTextureLevelParameteriv(tex.GetID(), level, GL_TEXTURE_HEIGHT,
+                                 &height);
+    glGetTextureLevelParameteriv(tex.GetID(), level, GL_TEXTURE_DEPTH, &depth);
+    // 立方体贴图的depth查询为0, 6个面作为6层读取
+    if (target == GL_TEXTURE_CUBE_MAP) {
+        depth = 6;
+    }
+    ReadTexture(tex, level, 0, 0, 0, width, std::max(height, 1),
+                std::max(depth, 1), format, type, std::move(callback));
+}
+void ReadbackService::ReadFramebuffer(GLuint framebuffer,
+                                      GLenum read_buffer,
+                                      GLint x,
+                                      GLint y,
+                                      GLsizei width,
+                                      GLsizei height,
+                                      GLenum format,
+                                      GLenum type,
+                                      ReadbackCallback callback) {
+    const size_t length = static_cast<size_t>(width) * height *
+                          TexturePixelSize(format, type);
+    if (length == 0) {
+        throw std::runtime_error("ReadbackService: 不支持的像素格式或空区域");
+    }
+    uint32 slot = AcquireBuffer(length);
+    GLint previous, previous_read_buffer;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    // 读缓冲是帧缓冲对象的状态, 读取后恢复, 避免影响调用者
+    glGetIntegerv(GL_READ_BUFFER, &previous_read_buffer);
+    glNamedFramebufferReadBuffer(framebuffer, read_buffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[slot].buffer);
+    glReadPixels(x, y, width, height, format, type, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glNamedFramebufferReadBuffer(framebuffer,
+                                 static_cast<GLenum>(previous_read_buffer));
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previous);
+    Submit(slot, length, std::move(callback));
+}
+void ReadbackService::ReadBuffer(GLuint buffer,
+                                 GLintptr offset,
+                                 GLsizeiptr size,
+                                 ReadbackCallback callback) {
+    if (size <= 0) {
+        throw std::runtime_error("ReadbackService: 空区域");
+    }
+    uint32 slot = AcquireBuffer(static_cast<size_t>(size));
+    glCopyNamedBufferSubData(buffer, buffers[slot].buffer, offset, 0, size);
+    Submit(slot, static_cast<size_t>(size), std::move(callback));
+}
+}  // namespace Boundless
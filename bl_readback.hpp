@@ -0,0 +1,92 @@
+#ifndef _BOUNDLESS_READBACK_HPP_FILE_
+#define _BOUNDLESS_READBACK_HPP_FILE_
+#include <deque>
+#include "bl_resource.hpp"
+#include "bl_thread.hpp"
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 异步GPU回读
+//
+// 请求把glGetTextureSubImage/glReadPixels/glCopyNamedBufferSubData写入
+// 池中一个持久映射的GL_PIXEL_PACK_BUFFER, 并插入栅栏, 渲染线程不等待.
+// 每帧调用Update()检查栅栏(不等待), 已完成的请求交给DefaultThreadPool(),
+// 回调在工作线程中直接读取映射的内存, 返回后缓冲区回到池中.
+// 回调的data只在回调期间有效. 回读的像素行按1字节对齐.
+// 除回调外只能在渲染线程使用.
+//
+typedef std::function<void(const Byte* data, size_t length)> ReadbackCallback;
+const size_t min_readback_buffer_size = 64ULL << 10;
+
+class ReadbackService {
+    struct PackBuffer {
+        GLuint buffer;
+        Byte* mapped;
+        size_t capacity;
+    };
+    struct Request {
+        GLsync fence;
+        uint32 slot;
+        size_t length;
+        ReadbackCallback callback;
+    };
+    std::vector<PackBuffer> buffers;
+    std::vector<uint32> free_slots;
+    std::deque<Request> pending;             // 按提交顺序, 栅栏尚未通过
+    threadsafe_queue<uint32> released;       // 回调执行完毕的缓冲区
+    std::atomic<uint32> running_callbacks;   // 已交给线程池的请求数
+
+    uint32 AcquireBuffer(size_t length);
+    void Submit(uint32 slot, size_t length, ReadbackCallback&& callback);
+    void Dispatch(Request& req);
+    void Reclaim();
+
+   public:
+    ReadbackService();
+    ReadbackService(const ReadbackService&) = delete;
+    ReadbackService& operator=(const ReadbackService&) = delete;
+    // 等待所有请求及其回调完成
+    ~ReadbackService();
+
+    // 回读纹理一个层级中的区域(z/depth为数组层或立方体面)
+    void ReadTexture(Texture& tex,
+                     GLint level,
+                     GLint x,
+                     GLint y,
+                     GLint z,
+                     GLsizei width,
+                     GLsizei height,
+                     GLsizei depth,
+                     GLenum format,
+                     GLenum type,
+                     ReadbackCallback callback);
+    // 回读纹理的整个层级
+    void ReadTexture(Texture& tex,
+                     GLint level,
+                     GLenum format,
+                     GLenum type,
+                     ReadbackCallback callback);
+    // 回读帧缓冲的颜色缓冲区(默认帧缓冲为0, 屏幕截图用GL_BACK或GL_FRONT)
+    void ReadFramebuffer(GLuint framebuffer,
+                         GLenum read_buffer,
+                         GLint x,
+                         GLint y,
+                         GLsizei width,
+                         GLsizei height,
+                         GLenum format,
+                         GLenum type,
+                         ReadbackCallback callback);
+    // 回读缓冲区对象的一段数据
+    void ReadBuffer(GLuint buffer,
+                    GLintptr offset,
+                    GLsizeiptr size,
+                    ReadbackCallback callback);
+    // 每帧调用: 把栅栏已通过的请求交给工作线程
+    void Update();
+    // 等待所有已提交的请求完成并交给工作线程(不等待回调结束)
+    void Flush();
+    size_t GetPendingCount() const { return pending.size(); }
+    size_t GetBufferCount() const { return buffers.size(); }
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_READBACK_HPP_FILE_
@@ -1,12 +1,14 @@
 #include "bl_render.hpp"
+#include "bl_impostor.hpp"
 
 namespace Boundless {
-inline Program::Program() {}
-inline Program::Program(size_t c) {
+Program::Program() {}
+Program::Program(size_t c, std::pmr::memory_resource* resource)
+    : program_shader(resource) {
     program_id = glCreateProgram();
     program_shader.reserve(c);
 }
-inline void Program::Init(size_t c) {
+void Program::Init(size_t c) {
     program_id = glCreateProgram();
     program_shader.reserve(c);
 }
@@ -21,10 +23,10 @@ void Program::Init(std::initializer_list<ShaderInit> list) {
     }
     Link();
 }
-inline Program::~Program() {
+Program::~Program() {
     glDeleteProgram(program_id);
 }
-inline Program::ShaderInfo& Program::operator[](size_t index) {
+Program::ShaderInfo& Program::operator[](size_t index) {
     return program_shader[index];
 };
 void Program::PrintLog() const {
@@ -33,14 +35,14 @@ void Program::PrintLog() const {
     if (success == GL_FALSE) {
         GLsizei length;
         glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &length);
-        char* log = (char*)malloc(length);
+        char* log = (char*)MemoryTracker::Allocate(length, MemoryTag::General);
         if (log == nullptr) {
             throw std::bad_alloc();
         } else {
             glGetProgramInfoLog(program_id, length, nullptr, log);
             ERROR("OpenGL", "着色器链接错误:", log,
                   "\n--------------------------------");
-            free(log);
+            MemoryTracker::Free(log);
         }
     }
 }
@@ -54,15 +56,15 @@ void Program::AddShaderByCode(const char* data, GLenum type) {
     glAttachShader(program_id, shader_id);
     program_shader.push_back({type, shader_id});
 }
-inline void Program::Link() const {
+void Program::Link() const {
     glLinkProgram(program_id);
     PrintLog();
 }
 
-inline void Program::UseProgram(Program& p) {
+void Program::UseProgram(Program& p) {
     glUseProgram(p.program_id);
 }
-inline void Program::UnUseProgram() {
+void Program::UnUseProgram() {
     glUseProgram(0);
 }
 
@@ -85,7 +87,8 @@ GLuint Program::LoadShader(const char* path, GLenum type) {
     if (success == GL_FALSE) {
         int length;
         glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &length);
-        char* log = (char*)malloc(sizeof(char) * length);
+        char* log = (char*)MemoryTracker::Allocate(sizeof(char) * length,
+                                                   MemoryTag::General);
         if (log == nullptr) {
             throw std::bad_alloc();
         } else {
@@ -93,7 +96,7 @@ GLuint Program::LoadShader(const char* path, GLenum type) {
             ERROR("OpenGL", "着色器编译错误:", shader_code,
                   "\n--------------------------------", log,
                   "\n--------------------------------");
-            free(log);
+            MemoryTracker::Free(log);
             glDeleteShader(shader_id);
             throw std::runtime_error("OpenGL:着色器编译错误:");
         }
@@ -110,7 +113,8 @@ GLuint Program::ComplieShader(const char* code, GLenum type) {
     if (success == GL_FALSE) {
         int length;
         glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &length);
-        char* log = (char*)malloc(sizeof(char) * length);
+        char* log = (char*)MemoryTracker::Allocate(sizeof(char) * length,
+                                                   MemoryTag::General);
         if (log == nullptr) {
             throw std::bad_alloc();
         } else {
@@ -118,7 +122,7 @@ GLuint Program::ComplieShader(const char* code, GLenum type) {
             ERROR("OpenGL", "着色器编译错误:", code,
                   "\n--------------------------------", log,
                   "\n--------------------------------");
-            free(log);
+            MemoryTracker::Free(log);
             glDeleteShader(shader_id);
             throw std::runtime_error("OpenGL:着色器编译错误:");
         }
@@ -156,14 +160,8 @@ const Matrix4f& Transform::model() {
     }
     return model;
 }
-inline void RenderObject::Enable() {
-    base_transform->roenble = true;
-}
-inline void RenderObject::Disable() {
-    base_transform->roenble = false;
-}
 
-inline Camera::Camera() : editedProj(true), editedView(true) {}
+Camera::Camera() : editedProj(true), editedView(true) {}
 const Matrix4f& Camera::proj() {
     if (editedProj) {
         editedProj = false;
@@ -243,140 +241,224 @@ const Matrix4f& Camera::viewproj() {
     }
     return vp_matrix;
 }
-Renderer::Renderer() : tr_pool(1), ro_pool(1), transform_head(nullptr) {}
-Transform* Renderer::AddTransformNode(const Vector3d& vp,
-                                      const Vector3d& vs,
-                                      const Quaterniond& qr) {
-    Transform* tfo = tr_pool.allocate();
-    tfo->parent = nullptr;
-    tfo->child_head = nullptr;
-    if (!transform_head) {
-        tfo->next_brother = nullptr;
-        transform_head = tfo;
-    } else {
-        tfo->next_brother = transform_head;
-        transform_head = tfo;
-    }
-
+Ray Camera::ScreenRay(double x,
+                      double y,
+                      double screen_width,
+                      double screen_height) {
+    Matrix4f inv = viewproj().inverse();
+    float nx = static_cast<float>(2.0 * x / screen_width - 1.0);
+    float ny = static_cast<float>(1.0 - 2.0 * y / screen_height);
+    Vector4f pn = inv * Vector4f(nx, ny, -1.0f, 1.0f);
+    Vector4f pf = inv * Vector4f(nx, ny, 1.0f, 1.0f);
+    Ray ray;
+    ray.origin = pn.head<3>() / pn.w();
+    ray.direction = pf.head<3>() / pf.w() - ray.origin;
+    ray.tmin = 0.0f;
+    ray.tmax = 1.0f;
+    return ray;
+}
+Renderer::Renderer()
+    : root_head(null_slot_handle),
+      world_frame(0),
+      impostor_light(0.0f, -1.0f, 0.0f) {}
+TransformHandle Renderer::NewTransform(const Vector3d& vp,
+                                       const Vector3d& vs,
+                                       const Quaterniond& qr) {
+    TransformHandle h = transforms.emplace();
+    Transform* tfo = transforms.get(h);
+    tfo->parent = null_slot_handle;
+    tfo->next_brother = null_slot_handle;
+    tfo->child_head = null_slot_handle;
+    tfo->world_frame = 0;
+    tfo->enable = true;
     tfo->roenble = false;
     tfo->edited = true;
     tfo->position = vp;
     tfo->scale = vs;
     tfo->rotate = qr;
     tfo->render_obj = nullptr;
-    return tfo;
+    return h;
 }
-Transform* Renderer::AddTransformNodeUnder(Transform* parent,
-                                           const Vector3d& vp,
+TransformHandle Renderer::AddTransformNode(const Vector3d& vp,
                                            const Vector3d& vs,
                                            const Quaterniond& qr) {
-    Transform* tfo = tr_pool.allocate();
+    TransformHandle h = NewTransform(vp, vs, qr);
+    transforms.get(h)->next_brother = root_head;
+    root_head = h;
+    return h;
+}
+TransformHandle Renderer::AddTransformNodeUnder(TransformHandle parent,
+                                                const Vector3d& vp,
+                                                const Vector3d& vs,
+                                                const Quaterniond& qr) {
+    if (!transforms.contains(parent)) {
+        throw std::runtime_error("Renderer: 无效的Transform句柄");
+    }
+    TransformHandle h = NewTransform(vp, vs, qr);
+    // NewTransform()可能移动其他节点, 之后再取指针
+    Transform* tfo = transforms.get(h);
+    Transform* p = transforms.get(parent);
     tfo->parent = parent;
-    tfo->child_head = nullptr;
-    tfo->next_brother = parent->child_head;
-    parent->child_head = tfo;
-
-    tfo->roenble = false;
-    tfo->edited = true;
-    tfo->position = vp;
-    tfo->scale = vs;
-    tfo->rotate = qr;
-    tfo->render_obj = nullptr;
-    return tfo;
+    tfo->next_brother = p->child_head;
+    p->child_head = h;
+    return h;
 }
-Transform* Renderer::AddTransformNodeRight(Transform* brother,
-                                           const Vector3d& vp,
-                                           const Vector3d& vs,
-                                           const Quaterniond& qr) {
-    Transform* tfo = tr_pool.allocate();
-    tfo->parent = brother->parent;
-    tfo->child_head = nullptr;
-    tfo->next_brother = brother->next_brother;
-    brother->next_brother = tfo;
-
-    tfo->roenble = false;
-    tfo->edited = true;
-    tfo->position = vp;
-    tfo->scale = vs;
-    tfo->rotate = qr;
-    tfo->render_obj = nullptr;
-    return tfo;
+TransformHandle Renderer::AddTransformNodeRight(TransformHandle brother,
+                                                const Vector3d& vp,
+                                                const Vector3d& vs,
+                                                const Quaterniond& qr) {
+    if (!transforms.contains(brother)) {
+        throw std::runtime_error("Renderer: 无效的Transform句柄");
+    }
+    TransformHandle h = NewTransform(vp, vs, qr);
+    Transform* tfo = transforms.get(h);
+    Transform* b = transforms.get(brother);
+    tfo->parent = b->parent;
+    tfo->next_brother = b->next_brother;
+    b->next_brother = h;
+    return h;
+}
+void Renderer::RemoveTransform(TransformHandle handle) {
+    Transform* tf = transforms.get(handle);
+    if (!tf)
+        return;
+    // 从父节点(或根链表)的子节点链表中摘除
+    TransformHandle* link = tf->parent
+                                ? &transforms.get(tf->parent)->child_head
+                                : &root_head;
+    while (*link != handle) {
+        link = &transforms.get(*link)->next_brother;
+    }
+    *link = tf->next_brother;
+    // 先收集整个子树的句柄, 删除会移动其他节点
+    std::vector<TransformHandle> subtree{handle};
+    for (size_t i = 0; i < subtree.size(); i++) {
+        for (TransformHandle c = transforms.get(subtree[i])->child_head; c;
+             c = transforms.get(c)->next_brother) {
+            subtree.push_back(c);
+        }
+    }
+    for (TransformHandle h : subtree) {
+        Transform* t = transforms.get(h);
+        if (t->render_obj)
+            DestroyObject(t->render_obj);
+        transforms.erase(h);
+    }
+}
+void Renderer::DestroyObject(RenderObject* obj) {
+    // 子类中RenderObject不一定是第一个基类, 归还的是整个对象的起始地址
+    void* p = dynamic_cast<void*>(obj);
+    size_t size = obj->object_size;
+    obj->~RenderObject();
+    ro_pool.deallocate(p, size);
+}
+void Renderer::ResolveWorld(Transform& tf) {
+    if (tf.world_frame == world_frame)
+        return;
+    Transform* p = transforms.get(tf.parent);
+    if (p) {
+        ResolveWorld(*p);
+        tf.world = p->world * tf.model();
+        tf.world_enable = p->world_enable && tf.enable;
+    } else {
+        tf.world = tf.model();
+        tf.world_enable = tf.enable;
+    }
+    tf.world_frame = world_frame;
+}
+void Renderer::UpdateWorld() {
+    world_frame++;
+    for (Transform& tf : transforms) {
+        ResolveWorld(tf);
+    }
 }
 void Renderer::DrawAll() {
-    const Matrix4f& vp = camera.get_viewproj_matrix();
-    // const Matrix4f& view = camera.get_view();
-    Transform *cur_root = transform_head, *p, *tp;
+    const Matrix4f& vp = camera.viewproj();
     Vector3f eye_dir = camera.forword.cast<float>();
-    while (!cur_root) {
-        if (cur_root->enable) {
-            mat_stack.push(cur_root->get_model());
-            if (cur_root->roenble)
-                cur_root->render_obj->draw(
-                    vp * mat_stack.top(), mat_stack.top(),
-                    mat_stack.top().inverse().transpose(), eye_dir);
-            p = cur_root->child_head;
-            if (!p) {
-                draw_ptrstack.push(nullptr);
-                do {
-                    draw_ptrstack.push(p);
-                    p = p->next_brother;
-                } while (!p);
-                do {
-                    p = draw_ptrstack.top();
-                    draw_ptrstack.pop();
-                    if (p == nullptr) {
-                        mat_stack.pop();
-                        continue;
-                    }
-                    if (!p->enable) {
-                        continue;
-                    }
-                    mat_stack.push(p->get_model() * mat_stack.top());
-                    if (cur_root->roenble)
-                        cur_root->render_obj->draw(
-                            vp * mat_stack.top(), mat_stack.top(),
-                            mat_stack.top().inverse().transpose(), eye_dir);
-                    tp = p->child_head;
-                    if (!tp) {
-                        draw_ptrstack.push(nullptr);
-                        do {
-                            draw_ptrstack.push(tp);
-                            tp = tp->next_brother;
-                        } while (!tp);
-                    } else {
-                        mat_stack.pop();
-                    }
-                } while (!draw_ptrstack.empty());
+    frame_memory.next_frame();
+    UpdateWorld();
+    // 线性遍历紧密存放的节点, 收集本帧的绘制列表(分配在逐帧内存中),
+    // 按节点存放顺序绘制
+    frame_vector<const Transform*> draws{
+        frame_allocator<const Transform*>(frame_memory)};
+    draws.reserve(transforms.size());
+    for (const Transform& tf : transforms) {
+        if (tf.world_enable && tf.roenble && tf.render_obj)
+            draws.push_back(&tf);
+    }
+    for (const Transform* tf : draws) {
+        DrawObject(*tf, vp, eye_dir);
+    }
+    // 远处物体的impostor以每种一次实例化调用绘制
+    Vector3f eye_pos = camera.position.cast<float>();
+    for (Impostor* imp : impostor_queue) {
+        imp->Flush(vp, eye_pos, impostor_light);
+        imp->queued = false;
+    }
+    impostor_queue.clear();
+}
+void Renderer::DrawObject(const Transform& tf,
+                          const Matrix4f& vp_matrix,
+                          const Vector3f& eye_dir) {
+    const Matrix4f& model_matrix = tf.world;
+    RenderObject* ro = tf.render_obj;
+    Impostor* imp = ro->impostor;
+    if (imp) {
+        Vector3f pos = model_matrix.col(3).head<3>();
+        if ((pos - camera.position.cast<float>()).norm() > imp->distance) {
+            imp->Add(model_matrix);
+            if (!imp->queued) {
+                imp->queued = true;
+                impostor_queue.push_back(imp);
             }
-            mat_stack.pop();
+            return;
         }
-        cur_root = cur_root->next_brother;
     }
+    ro->draw(vp_matrix * model_matrix, model_matrix,
+             model_matrix.inverse().transpose(), eye_dir);
 }
-Renderer::~Renderer() {
-    Transform *cur_root = transform_head, *p, *tp;
-    while (!cur_root) {
-        if (!cur_root->render_obj)
-            cur_root->render_obj->~RenderObject();
-        p = cur_root->child_head;
-        if (!p) {
-            do {
-                draw_ptrstack.push(p);
-                p = p->next_brother;
-            } while (!p);
-            do {
-                p = draw_ptrstack.top();
-                draw_ptrstack.pop();
-                if (!cur_root->render_obj)
-                    cur_root->render_obj->~RenderObject();
-                tp = p->child_head;
-                while (!tp) {
-                    draw_ptrstack.push(tp);
-                    tp = tp->next_brother;
-                }
-            } while (!draw_ptrstack.empty());
+bool Renderer::RayCast(const Ray& ray, SceneHit& hit) {
+    hit.t = ray.tmax;
+    hit.transform = null_slot_handle;
+    hit.object = nullptr;
+    UpdateWorld();
+    const Transform* all = transforms.data();
+    for (size_t i = 0; i < transforms.size(); i++) {
+        const Transform& tf = all[i];
+        RenderObject* ro = tf.render_obj;
+        if (!tf.world_enable || !tf.roenble || !ro || !ro->bvh)
+            continue;
+        // 将射线变换到模型空间, 方向不单位化以保持t的参数化不变
+        Matrix4f inv = tf.world.inverse();
+        Ray local;
+        local.origin = (inv * ray.origin.homogeneous()).head<3>();
+        local.direction = inv.topLeftCorner<3, 3>() * ray.direction;
+        local.tmin = ray.tmin;
+        local.tmax = hit.t;
+        float tnear;
+        if (!ro->bvh->GetBounds().intersect(local, &tnear))
+            continue;
+        RayHit rh;
+        rh.t = hit.t;
+        if (ro->bvh->Intersect(local, rh)) {
+            static_cast<RayHit&>(hit) = rh;
+            hit.transform = transforms.handle_at(i);
+            hit.object = ro;
         }
-        cur_root = cur_root->next_brother;
+    }
+    return hit.object != nullptr;
+}
+bool Renderer::Pick(double x,
+                    double y,
+                    double screen_width,
+                    double screen_height,
+                    SceneHit& hit) {
+    return RayCast(camera.ScreenRay(x, y, screen_width, screen_height), hit);
+}
+Renderer::~Renderer() {
+    for (Transform& tf : transforms) {
+        if (tf.render_obj)
+            DestroyObject(tf.render_obj);
     }
 }
 
@@ -393,9 +475,10 @@ void ADSBase::InitMeshADS(Mesh& mesh) { //todo: 修改参数位置为标准顺
 }
 void ADSBase::InitADS() {
     glCreateBuffers(1, &uniform_buffer);
-    glNamedBufferStorage(uniform_buffer,
-                         NUM_MAX_LIGHTS * 16 * 7 + NUM_MAX_MATERIALS * 16 * 4,
-                         nullptr, GL_DYNAMIC_STORAGE_BIT);
+    MemoryTracker::BufferStorage(
+        MemoryTag::Render, uniform_buffer,
+        NUM_MAX_LIGHTS * 16 * 7 + NUM_MAX_MATERIALS * 16 * 4, nullptr,
+        GL_DYNAMIC_STORAGE_BIT);
     glBindBufferBase(GL_UNIFORM_BUFFER, 0, uniform_buffer);
     shader.Init({
         {ads_vertshader_path, GL_VERTEX_SHADER},
@@ -1,12 +1,15 @@
 #ifndef _BOUNDLESS_RENDER_HPP_FILE_
 #define _BOUNDLESS_RENDER_HPP_FILE_
 #include <initializer_list>
+#include "bl_bvh.hpp"
+#include "bl_memory.hpp"
 #include "bl_resource.hpp"
 #include "boundless_base.hpp"
 namespace Boundless {
+class Impostor;
 class Program {
     GLuint program_id;
-    std::vector<ShaderInfo> program_shader;
+    std::pmr::vector<ShaderInfo> program_shader;
     void PrintLog() const;
 
    public:
@@ -21,7 +24,8 @@ class Program {
 
    public:
     Program();
-    Program(size_t c);
+    Program(size_t c,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     void Init(size_t c);
     void Init(std::initializer_list<ShaderInit>);
     Program(const Program& target) = delete;
@@ -42,9 +46,15 @@ class Program {
     static GLuint LoadShader(const char* path, GLenum type);
     static GLuint ComplieShader(const char* code, GLenum type);
 };
+// Transform由Renderer存放在slot_map中, 以句柄引用
+typedef slot_handle TransformHandle;
 class Transform {
     friend class RenderObject;
-    Transform *parent, *next_brother, *child_head;
+    friend class Renderer;
+    TransformHandle parent, next_brother, child_head;
+    Matrix4f world;      // 世界矩阵, 由Renderer::UpdateWorld()计算
+    uint64 world_frame;  // world对应的UpdateWorld()序号
+    bool world_enable;   // 自身及所有祖先都已启用
 
    public:
     RenderObject* render_obj;
@@ -55,18 +65,21 @@ class Transform {
     bool edited, roenble, enable;
 
     const Matrix4f& model();
+    // 上一次UpdateWorld()得到的世界矩阵
+    const Matrix4f& GetWorld() const { return world; }
 };
 
 class RenderObject {
     friend class Transform;
    public:
-    Transform* base_transform;
+    TransformHandle base_transform;
+    size_t object_size;  // 分配时的大小, 由Renderer设置
     void* data_ptr;
+    const MeshBVH* bvh;  // 射线查询使用的BVH(模型空间), 为空时不参与查询
+    Impostor* impostor;  // 远处使用的impostor, 为空时总是完整绘制
     Mesh mesh;
 
-    RenderObject() {}
-    void Enable();
-    void Disable();
+    RenderObject() : bvh(nullptr), impostor(nullptr) {}
     virtual void draw(const Matrix4f& mvp_matrix,
                       const Matrix4f& model_matrix,
                       const Matrix4f& normal_matrix,
@@ -93,122 +106,114 @@ class Camera {
     const Matrix4f& proj();
     const Matrix4f& view();
     const Matrix4f& viewproj();
+    // 由屏幕坐标(像素, 左上角为原点)生成世界空间射线, 用于鼠标拾取
+    Ray ScreenRay(double x, double y, double screen_width, double screen_height);
+};
+// 场景射线查询结果
+struct SceneHit : RayHit {
+    TransformHandle transform;
+    RenderObject* object;
 };
 
 class Renderer {
-    object_pool<Transform, 64> tr_pool;
-    object_pool<RenderObject, 64> ro_pool;
-    Transform* transform_head;
-    std::stack<Matrix4f> mat_stack;
-    std::stack<Transform*> draw_ptrstack;
+    slot_map<Transform> transforms;
+    size_class_pool<> ro_pool;  // 不同大小的RenderObject子类按大小分级存放
+    TransformHandle root_head;  // 根节点链表
+    uint64 world_frame;
+    std::pmr::vector<Impostor*> impostor_queue;
+    frame_arena frame_memory;  // 绘制列表等逐帧临时数据
+
+    TransformHandle NewTransform(const Vector3d& vp,
+                                 const Vector3d& vs,
+                                 const Quaterniond& qr);
+    void ResolveWorld(Transform& tf);
+    void DestroyObject(RenderObject* obj);
+    void DrawObject(const Transform& tf,
+                    const Matrix4f& vp_matrix,
+                    const Vector3f& eye_dir);
+    template <typename T, typename... arguments>
+    T* ConstructObject(TransformHandle handle, arguments&&... args) {
+        static_assert(std::is_base_of<RenderObject, T>::value,
+                      "Type must be derived from RenderObject.");
+        T* obj = ro_pool.construct<T>(std::forward<arguments>(args)...);
+        obj->base_transform = handle;
+        obj->object_size = sizeof(T);
+        transforms.get(handle)->render_obj = obj;
+        return obj;
+    }
 
    public:
     Camera camera;
+    Vector3f impostor_light;  // impostor光照使用的方向光方向
 
     Renderer();
-    Transform* AddTransformNode(const Vector3d& vp,
-                                const Vector3d& vs,
-                                const Quaterniond& qr);
-    Transform* AddTransformNodeUnder(Transform* parent,
-                                     const Vector3d& vp,
-                                     const Vector3d& vs,
-                                     const Quaterniond& qr);
-    Transform* AddTransformNodeRight(Transform* brother,
-                                     const Vector3d& vp,
+    TransformHandle AddTransformNode(const Vector3d& vp,
                                      const Vector3d& vs,
                                      const Quaterniond& qr);
+    TransformHandle AddTransformNodeUnder(TransformHandle parent,
+                                          const Vector3d& vp,
+                                          const Vector3d& vs,
+                                          const Quaterniond& qr);
+    TransformHandle AddTransformNodeRight(TransformHandle brother,
+                                          const Vector3d& vp,
+                                          const Vector3d& vs,
+                                          const Quaterniond& qr);
     template <typename T, typename... arguments>
-    Transform* AddObject(const Vector3d& vp,
-                         const Vector3d& vs,
-                         const Quaterniond& qr,
-                         T** retobj,
-                         arguments&&... args) {
-        static_assert(std::is_base_of<RenderObject, T>::value,
-                      "Type must be derived from RenderObject.");
-        static_assert(
-            sizeof(T) == sizeof(RenderObject),
-            "Type must have the same size compare with RenderObject.");
-        Transform* tfo = tr_pool.allocate();
-        RenderObject* rdo = ro_pool.allocate();
-        tfo->parent = nullptr;
-        tfo->child_head = nullptr;
-        if (!transform_head) {
-            tfo->next_brother = nullptr;
-            transform_head = tfo;
-        } else {
-            tfo->next_brother = transform_head;
-            transform_head = tfo;
-        }
-
-        tfo->roenble = false;
-        tfo->edited = true;
-        tfo->position = vp;
-        tfo->scale = vs;
-        tfo->rotate = qr;
-        tfo->render_obj = rdo;
-        new ((T*)rdo) T(std::forward<arguments>(args)...);
-        *retobj = (T*)rdo;
-        return tfo;
-    }
-    template <typename T, typename... arguments>
-    Transform* AddObjectUnder(Transform* parent,
-                              const Vector3d& vp,
+    TransformHandle AddObject(const Vector3d& vp,
                               const Vector3d& vs,
                               const Quaterniond& qr,
                               T** retobj,
                               arguments&&... args) {
-        static_assert(std::is_base_of<RenderObject, T>::value,
-                      "Type must be derived from RenderObject.");
-        static_assert(
-            sizeof(T) == sizeof(RenderObject),
-            "Type must have the same size compare with RenderObject.");
-        Transform* tfo = tr_pool.allocate();
-        Renderer* rdo = ro_pool.allocate();
-        tfo->parent = parent;
-        tfo->child_head = nullptr;
-        tfo->next_brother = parent->child_head;
-        parent->child_head = tfo;
-
-        tfo->roenble = false;
-        tfo->edited = true;
-        tfo->position = vp;
-        tfo->scale = vs;
-        tfo->rotate = qr;
-        tfo->render_obj = rdo;
-        new ((T*)rdo) T(std::forward<arguments>(args)...);
-        *retobj = (T*)rdo;
-        return tfo;
+        TransformHandle h = AddTransformNode(vp, vs, qr);
+        *retobj = ConstructObject<T>(h, std::forward<arguments>(args)...);
+        return h;
     }
     template <typename T, typename... arguments>
-    Transform* AddObjectRight(Transform* brother,
-                              const Vector3d& vp,
-                              const Vector3d& vs,
-                              const Quaterniond& qr,
-                              T** retobj,
-                              arguments&&... args) {
-        static_assert(std::is_base_of<RenderObject, T>::value,
-                      "Type must be derived from RenderObject.");
-        static_assert(
-            sizeof(T) == sizeof(RenderObject),
-            "Type must have the same size compare with RenderObject.");
-        Transform* tfo = tr_pool.allocate();
-        Renderer* rdo = ro_pool.allocate();
-        tfo->parent = brother->parent;
-        tfo->child_head = nullptr;
-        tfo->next_brother = brother->next_brother;
-        brother->next_brother = tfo;
-
-        tfo->roenble = false;
-        tfo->edited = true;
-        tfo->position = vp;
-        tfo->scale = vs;
-        tfo->rotate = qr;
-        tfo->render_obj = rdo;
-        new ((T*)rdo) T(std::forward<arguments>(args)...);
-        *retobj = (T*)rdo;
-        return tfo;
+    TransformHandle AddObjectUnder(TransformHandle parent,
+                                   const Vector3d& vp,
+                                   const Vector3d& vs,
+                                   const Quaterniond& qr,
+                                   T** retobj,
+                                   arguments&&... args) {
+        TransformHandle h = AddTransformNodeUnder(parent, vp, vs, qr);
+        *retobj = ConstructObject<T>(h, std::forward<arguments>(args)...);
+        return h;
+    }
+    template <typename T, typename... arguments>
+    TransformHandle AddObjectRight(TransformHandle brother,
+                                   const Vector3d& vp,
+                                   const Vector3d& vs,
+                                   const Quaterniond& qr,
+                                   T** retobj,
+                                   arguments&&... args) {
+        TransformHandle h = AddTransformNodeRight(brother, vp, vs, qr);
+        *retobj = ConstructObject<T>(h, std::forward<arguments>(args)...);
+        return h;
+    }
+    // 删除节点及其整个子树(连同其上的RenderObject), 之后这些句柄失效
+    void RemoveTransform(TransformHandle handle);
+    // 句柄已失效时返回nullptr, 返回的指针在下一次增删节点前有效
+    Transform* GetTransform(TransformHandle handle) {
+        return transforms.get(handle);
+    }
+    bool IsValid(TransformHandle handle) const {
+        return transforms.contains(handle);
     }
+    // 所有节点紧密存放, 供逐帧的线性遍历使用
+    slot_map<Transform>& GetTransforms() { return transforms; }
+    // 计算所有节点的世界矩阵: 线性遍历, 父节点按需先行计算
+    void UpdateWorld();
+    // 本帧的临时内存, DrawAll()开始时切换到下一帧
+    frame_arena& GetFrameArena() { return frame_memory; }
     void DrawAll();
+    // 场景射线查询: 遍历Transform树, 先测试物体包围盒, 再在物体BVH中求最近命中
+    bool RayCast(const Ray& ray, SceneHit& hit);
+    // 鼠标拾取, x和y为屏幕像素坐标
+    bool Pick(double x,
+              double y,
+              double screen_width,
+              double screen_height,
+              SceneHit& hit);
     ~Renderer();
 };
 
@@ -0,0 +1,121 @@
+#include "bl_residency.hpp"
+
+namespace Boundless {
+ResidencyManager::ResidencyManager(const ResidencySettings& arg)
+    : frame(0), stats{0, 0, 0, 0, 0, 0}, settings(arg) {}
+ResidentHandle ResidencyManager::Register(const std::string& path,
+                                          ResourceType type) {
+    auto it = by_path.find(path);
+    if (it != by_path.end()) {
+        if (entries[it->second].type != type) {
+            throw std::runtime_error("资源类型与已登记的不同:" + path);
+        }
+        return it->second;
+    }
+    ResidentHandle handle = static_cast<ResidentHandle>(entries.size());
+    Entry entry;
+    entry.path = path;
+    entry.type = type;
+    entry.bytes = 0;
+    entry.last_used = 0;
+    entry.resident = false;
+    entries.push_back(std::move(entry));
+    by_path.emplace(path, handle);
+    return handle;
+}
+ResidentHandle ResidencyManager::RegisterTexture(const std::string& path) {
+    return Register(path, ResourceType::TEXTURE);
+}
+ResidentHandle ResidencyManager::RegisterMesh(const std::string& path) {
+    return Register(path, ResourceType::MESH);
+}
+void ResidencyManager::Touch(ResidentHandle handle) {
+    Entry& e = entries[handle];
+    e.last_used = frame;
+    if (e.resident) {
+        stats.hits++;
+        lru.splice(lru.end(), lru, e.lru_pos);
+    } else {
+        stats.misses++;
+        MakeResident(handle);
+    }
+}
+void ResidencyManager::MakeResident(ResidentHandle handle) {
+    Entry& e = entries[handle];
+    if (e.type == ResourceType::TEXTURE) {
+        if (!e.texture)
+            e.texture = std::make_unique<Texture>();
+        Texture::LoadTexture(e.path, *e.texture);
+        e.bytes = e.texture->GetMemorySize();
+    } else {
+        if (!e.mesh)
+            e.mesh = std::make_unique<Mesh>();
+        Mesh::LoadMesh(e.path, *e.mesh);
+        e.bytes = e.mesh->GetMemorySize();
+    }
+    e.resident = true;
+    e.lru_pos = lru.insert(lru.end(), handle);
+    stats.resident_bytes += e.bytes;
+    stats.resident_count++;
+    EnforceBudget();
+}
+void ResidencyManager::Evict(ResidentHandle handle) {
+    Entry& e = entries[handle];
+    if (e.type == ResourceType::TEXTURE) {
+        e.texture->Release();
+    } else {
+        e.mesh->Release();
+    }
+    lru.erase(e.lru_pos);
+    e.resident = false;
+    stats.resident_bytes -= e.bytes;
+    stats.resident_count--;
+    stats.evicted_bytes += e.bytes;
+    stats.evictions++;
+}
+void ResidencyManager::EnforceBudget() {
+    while (stats.resident_bytes > settings.budget) {
+        // 在最久未使用的若干个候选中, 逐出闲置时间与大小乘积最大的
+        ResidentHandle victim = 0;
+        double best = -1.0;
+        uint32 examined = 0;
+        for (auto it = lru.begin();
+             it != lru.end() && examined < settings.eviction_window; ++it) {
+            const Entry& e = entries[*it];
+            if (e.last_used == frame)
+                break;  // 之后的都在本帧使用过
+            examined++;
+            double score =
+                static_cast<double>(frame - e.last_used + 1) * e.bytes;
+            if (score > best) {
+                best = score;
+                victim = *it;
+            }
+        }
+        if (best < 0.0)
+            break;  // 本帧的工作集本身超出预算
+        Evict(victim);
+    }
+}
+Texture& ResidencyManager::UseTexture(ResidentHandle handle) {
+    Touch(handle);
+    return *entries[handle].texture;
+}
+Mesh& ResidencyManager::UseMesh(ResidentHandle handle) {
+    Touch(handle);
+    return *entries[handle].mesh;
+}
+void ResidencyManager::BeginFrame() {
+    frame++;
+    EnforceBudget();
+}
+void ResidencyManager::Trim() {
+    while (!lru.empty() && entries[lru.front()].last_used != frame) {
+        Evict(lru.front());
+    }
+}
+void ResidencyManager::ResetCounters() {
+    stats.hits = stats.misses = stats.evictions = 0;
+    stats.evicted_bytes = 0;
+}
+}  // namespace Boundless
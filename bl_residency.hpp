@@ -0,0 +1,78 @@
+#ifndef _BOUNDLESS_RESIDENCY_HPP_FILE_
+#define _BOUNDLESS_RESIDENCY_HPP_FILE_
+#include <list>
+#include <memory>
+#include "bl_resource.hpp"
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 显存驻留管理
+//
+// 登记的纹理/网格按需从烘焙文件加载, 记录各自占用的显存字节数.
+// 驻留总量超过预算时, 从最久未使用的一端取eviction_window个候选,
+// 逐出 (未使用帧数+1) * 字节数 最大者(释放GL对象, 保留C++对象),
+// 直到回到预算以内. 本帧使用过的资源不会被逐出.
+// 被逐出的资源在下一次Use~()时同步重新加载(计为未命中).
+// Use~()返回的引用在资源被逐出前有效(至少到下一次BeginFrame()).
+// 只能在渲染线程使用.
+//
+typedef uint32 ResidentHandle;
+
+struct ResidencySettings {
+    size_t budget = 1ULL << 30;  // 显存预算(字节)
+    uint32 eviction_window = 32;  // 每次逐出时考察的LRU候选数
+};
+struct ResidencyStats {
+    uint64 hits, misses, evictions;
+    size_t resident_bytes, evicted_bytes;
+    uint32 resident_count;
+};
+
+class ResidencyManager {
+    enum struct ResourceType { TEXTURE, MESH };
+    struct Entry {
+        std::string path;
+        ResourceType type;
+        std::unique_ptr<Texture> texture;
+        std::unique_ptr<Mesh> mesh;
+        size_t bytes;
+        uint64 last_used;  // 最近一次使用的帧序号
+        bool resident;
+        std::list<ResidentHandle>::iterator lru_pos;  // 驻留时有效
+    };
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, ResidentHandle> by_path;
+    std::list<ResidentHandle> lru;  // 驻留的资源, 表头为最久未使用
+    uint64 frame;
+    ResidencyStats stats;
+
+    ResidentHandle Register(const std::string& path, ResourceType type);
+    void Touch(ResidentHandle handle);
+    void MakeResident(ResidentHandle handle);
+    void Evict(ResidentHandle handle);
+    void EnforceBudget();
+
+   public:
+    ResidencySettings settings;
+
+    ResidencyManager(const ResidencySettings& arg = {});
+    ResidencyManager(const ResidencyManager&) = delete;
+    ResidencyManager& operator=(const ResidencyManager&) = delete;
+
+    // 登记资源文件(不立即加载), 同一路径返回同一句柄
+    ResidentHandle RegisterTexture(const std::string& path);
+    ResidentHandle RegisterMesh(const std::string& path);
+    // 绘制前调用: 标记为本帧使用, 未驻留时同步加载
+    Texture& UseTexture(ResidentHandle handle);
+    Mesh& UseMesh(ResidentHandle handle);
+    // 每帧开始时调用: 推进帧序号, 把驻留量压回预算以内
+    void BeginFrame();
+    // 逐出所有本帧未使用的资源
+    void Trim();
+    bool IsResident(ResidentHandle handle) const { return entries[handle].resident; }
+    size_t GetBytes(ResidentHandle handle) const { return entries[handle].bytes; }
+    const ResidencyStats& GetStats() const { return stats; }
+    void ResetCounters();
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_RESIDENCY_HPP_FILE_
@@ -2,10 +2,18 @@
 #include "stb/stb_image.h"
 
 #include "bl_resource.hpp"
+#include "bl_bcn.hpp"
+#include "bl_bvh.hpp"
+#include "bl_image.hpp"
+#include "bl_mesh_codec.hpp"
+#include "bl_upload_ring.hpp"
 
 namespace Boundless {
 Mesh::Mesh() {}
-Mesh::Mesh(IndexStatus indexst, size_t bufcnt) {
+Mesh::Mesh(IndexStatus indexst,
+           size_t bufcnt,
+           std::pmr::memory_resource* resource)
+    : buffers(resource) {
     glCreateVertexArrays(1, &vertex_array);
     glCreateBuffers(1, &vertex_buffer);
     if (bufcnt > 0) {
@@ -35,7 +43,7 @@ void Mesh::InitIndexStatus(IndexStatus indexst) {
         }
     } else {
         if (index_buffer != 0) {
-            glDeleteBuffers(1, &index_buffer);
+            MemoryTracker::DeleteBuffers(1, &index_buffer);
         }
     }
 }
@@ -74,7 +82,8 @@ void Mesh::InitMesh(const MeshInitArg& args,
     size_t count = list.size();
     if (it != list.end()) {
         glCreateBuffers(1, &vertex_buffer);
-        glNamedBufferStorage(vertex_buffer, it->length, it->data, it->flags);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, vertex_buffer, it->length,
+                                     it->data, it->flags);
         glVertexArrayVertexBuffer(vertex_array, 0, vertex_buffer, it->start,
                                   it->stride);
         count--;
@@ -82,7 +91,8 @@ void Mesh::InitMesh(const MeshInitArg& args,
     ++it;
     if (it != list.end() && index_status != IndexStatus::NO_INDEX) {
         glCreateBuffers(1, &index_buffer);
-        glNamedBufferStorage(index_buffer, it->length, it->data, it->flags);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, index_buffer, it->length,
+                                     it->data, it->flags);
         glVertexArrayVertexBuffer(vertex_array, 0, index_buffer, it->start,
                                   it->stride);
         count--;
@@ -94,51 +104,27 @@ void Mesh::InitMesh(const MeshInitArg& args,
     glCreateBuffers(count, &buffers[0]);
     count = 0;
     for (; it != list.end(); ++it, ++count) {
-        glNamedBufferStorage(buffers[count], it->length, it->data, it->flags);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, buffers[count],
+                                     it->length, it->data, it->flags);
         glVertexArrayVertexBuffer(vertex_array, 0, buffers[count], it->start,
                                   it->stride);
     }
 }
-inline const std::vector<GLuint>& Mesh::getBuffer() {
-    return buffers;
-}
-inline void Mesh::setPrimitiveType(GLenum type) {
-    primitive_type = type;
-}
-inline void Mesh::getRestartIndex(GLuint index) {
-    restart_index = index;
-}
-inline GLuint Mesh::setRestartIndex() {
-    return restart_index;
-}
-inline GLenum Mesh::getIndexType() {
-    return index_type;
-}
-inline GLenum Mesh::getPrimitiveType() {
-    return primitive_type;
-}
-inline IndexStatus Mesh::getIndexStatus() {
-    return index_status;
-}
-inline GLuint Mesh::getCount() {
-    return mesh_count;
-}
-inline GLuint Mesh::getVAO() {
-    return vertex_array;
-}
-inline GLuint Mesh::getVBO() {
-    return vertex_buffer;
-}
-inline GLuint Mesh::getIBO() {
-    return index_buffer;
-}
 void Mesh::LoadMesh(const Byte* data, Mesh& mesh) {
-    if (*(uint64*)data != MESH_HEADER) {
+    size_t len;
+    Byte* dt;
+    if (*(uint64*)data == MESH_HEADER) {
+        dt = UncompressData(data + sizeof(uint64), &len);
+    } else if (*(uint64*)data == MESH_CODEC_HEADER) {
+        dt = MeshCodec::Decode(data, &len);
+    } else {
         throw std::runtime_error("Mesh head code error.");
     }
-    size_t len;
-    Byte* dt = UncompressData(data + sizeof(uint64), &len);
-    MeshFile& head = *(MeshFile*)(dt);
+    LoadMeshData(dt, mesh);
+    MemoryTracker::Free(dt);
+}
+void Mesh::LoadMeshData(const Byte* dt, Mesh& mesh) {
+    const MeshFile& head = *(const MeshFile*)(dt);
     // const Byte* dp = dt + sizeof(MeshFile) + sizeof(DataRange) *
     // head.buffer_count;
     mesh.primitive_type = head.primitive_type;
@@ -152,34 +138,39 @@ void Mesh::LoadMesh(const Byte* data, Mesh& mesh) {
         mesh.buffers.resize(head.buffer_count);
         glCreateBuffers(head.buffer_count, &mesh.buffers[0]);
     }
-    glNamedBufferStorage(mesh.vertex_buffer, head.vbo.length,
-                         dt + head.vbo.start, opengl_buffer_storage);
+    MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.vertex_buffer,
+                                 head.vbo.length, dt + head.vbo.start,
+                                 opengl_buffer_storage);
     if (mesh.index_status != IndexStatus::NO_INDEX) {
         glCreateBuffers(1, &mesh.index_buffer);
-        glNamedBufferStorage(mesh.index_buffer, head.ibo.length,
-                             dt + head.ibo.start, opengl_buffer_storage);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.index_buffer,
+                                     head.ibo.length, dt + head.ibo.start,
+                                     opengl_buffer_storage);
     }
     for (size_t i = 0; i < head.buffer_count; i++) {
-        glNamedBufferStorage(mesh.buffers[i], head.buffers[i].length,
-                             dt + head.buffers[i].start, opengl_buffer_storage);
+        MemoryTracker::BufferStorage(MemoryTag::Mesh, mesh.buffers[i],
+                                     head.buffers[i].length,
+                                     dt + head.buffers[i].start,
+                                     opengl_buffer_storage);
     }
-    free(dt);
 }
 void Mesh::LoadMesh(std::ifstream& in, Mesh& mesh) {
+    // 记录格式: 文件头代码, 压缩前长度, 压缩后长度, 压缩数据
     size_t length;
     std::streampos cur = in.tellg();
-    in.seekg(sizeof(uint64), std::ios_base::cur);
+    in.seekg(sizeof(uint64) * 2, std::ios_base::cur);
     in.read((char*)&length, sizeof(uint64));
     in.seekg(cur);
-    Byte* data = (Byte*)malloc(length);
+    length += sizeof(uint64) * 3;
+    Byte* data = (Byte*)MemoryTracker::Allocate(length, MemoryTag::Mesh);
     if (data == nullptr) {
         throw std::bad_alloc();
     }
     in.read((char*)data, length);
     LoadMesh(data, mesh);
-    free(data);
+    MemoryTracker::Free(data);
 }
-inline void Mesh::LoadMesh(const std::string& path, Mesh& mesh) {
+void Mesh::LoadMesh(const std::string& path, Mesh& mesh) {
     std::ifstream fin(path, std::ios_base::in | std::ios_base::binary);
     if (!fin.is_open()) {
         throw std::runtime_error("Cannot open file:" + path);
@@ -187,7 +178,7 @@ inline void Mesh::LoadMesh(const std::string& path, Mesh& mesh) {
     LoadMesh(fin, mesh);
     fin.close();
 }
-inline void Mesh::LoadMesh(const char* path, Mesh& mesh) {
+void Mesh::LoadMesh(const char* path, Mesh& mesh) {
     std::ifstream fin(path, std::ios_base::in | std::ios_base::binary);
     if (!fin.is_open()) {
         throw std::runtime_error(std::string("Cannot open file:") + path);
@@ -233,7 +224,8 @@ Byte* Mesh::PackMesh(size_t* ret_length, const Mesh& mesh) {
                                       &length);  // 获取每个Buffer长度
         full_size += static_cast<size_t>(length);
     }
-    Byte *data = (Byte*)malloc(full_size), *cur = data;
+    Byte* data = (Byte*)MemoryTracker::Allocate(full_size, MemoryTag::Mesh);
+    Byte* cur = data;
     if (data == nullptr) {
         throw std::bad_alloc();
     }
@@ -273,7 +265,7 @@ Byte* Mesh::PackMesh(size_t* ret_length, const Mesh& mesh) {
         glUnmapNamedBuffer(mesh.buffers[i]);
     }
     Byte* res = CompressData(data, &full_size, sizeof(uint64));
-    free(data);
+    MemoryTracker::Free(data);
     *(uint64*)res = MESH_HEADER;
     *ret_length = full_size;
     return res;
@@ -287,7 +279,7 @@ void Mesh::PackMesh(const std::string& path, const Mesh& mesh) {
         throw std::runtime_error("Cannot open file:" + path);
     }
     fout.write((char*)data, length);
-    free(data);
+    MemoryTracker::Free(data);
     fout.close();
 }
 void Mesh::GenMeshFile(const aiMesh* ptr, const std::string& save_path) {
@@ -357,7 +349,7 @@ Byte* Mesh::GenMeshFile(const aiMesh* pointer,
 
     size_t length = sizeof(MeshFile) + head.vbo.length + head.ibo.length,
            rl = length;
-    Byte *mesh_data = (Byte*)malloc(length),
+    Byte *mesh_data = (Byte*)MemoryTracker::Allocate(length, MemoryTag::Mesh),
          *curpos = mesh_data + sizeof(MeshFile);
     if (mesh_data == nullptr) {
         throw std::bad_alloc();
@@ -396,7 +388,7 @@ Byte* Mesh::GenMeshFile(const aiMesh* pointer,
         }
     }
     Byte* data = CompressData(mesh_data, &length, sizeof(uint64));
-    free(mesh_data);
+    MemoryTracker::Free(mesh_data);
     *(uint64*)data = MESH_HEADER;
     std::cout << "Vertices Count:" << pointer->mNumVertices << '\n';
     std::cout << "Indices Count:" << pointer->mNumFaces * 3 << '\n';
@@ -412,13 +404,19 @@ void Mesh::GenMeshFile(const std::string& path) {
         !scene->mRootNode) {
         throw std::runtime_error(importer.GetErrorString());
     }
+    aiMemoryInfo scene_memory;
+    importer.GetMemoryRequirements(scene_memory);
+    ExternalMemoryScope assimp_memory(MemoryTag::Assimp, scene_memory.total);
     for (size_t i = 0; i < scene->mNumMeshes; i++) {
-        GenMeshFile(scene->mMeshes[i], std::string(path) + std::to_string(i) +
-                                           scene->mMeshes[i]->mName.C_Str() +
-                                           ".mesh");
+        std::string name = std::string(path) + std::to_string(i) +
+                           scene->mMeshes[i]->mName.C_Str();
+        GenMeshFile(scene->mMeshes[i], name + ".mesh");
+        if (scene->mMeshes[i]->HasFaces()) {
+            MeshBVH::GenBVHFile(scene->mMeshes[i], name + ".bvh");
+        }
     }
 }
-inline void Mesh::GenMeshFile(const char* path) {
+void Mesh::GenMeshFile(const char* path) {
     GenMeshFile(std::string(path));
 }
 void Mesh::GenMeshFileMerged(const std::string& path) {
@@ -428,6 +426,9 @@ void Mesh::GenMeshFileMerged(const std::string& path) {
         !scene->mRootNode) {
         throw std::runtime_error(importer.GetErrorString());
     }
+    aiMemoryInfo scene_memory;
+    importer.GetMemoryRequirements(scene_memory);
+    ExternalMemoryScope assimp_memory(MemoryTag::Assimp, scene_memory.total);
     std::ofstream file(path,
                        std::ios::out | std::ios::binary | std::ios::trunc);
     if (!file.is_open()) {
@@ -445,27 +446,134 @@ void Mesh::GenMeshFileMerged(const std::string& path) {
                                scene->mMeshes[i]->mName.C_Str() + ".mesh",
                            &length);
         file.write((char*)data, length);
-        free(data);
+        MemoryTracker::Free(data);
     }
 }
-inline void Mesh::GenMeshFileMerged(const char* path) {
+void Mesh::GenMeshFileMerged(const char* path) {
     GenMeshFileMerged(std::string(path));
 }
 Mesh::~Mesh() {
     glDeleteVertexArrays(1, &vertex_array);
-    glDeleteBuffers(1, &vertex_buffer);
-    glDeleteBuffers(buffers.size(), &buffers[0]);
+    MemoryTracker::DeleteBuffers(1, &vertex_buffer);
+    MemoryTracker::DeleteBuffers(buffers.size(), buffers.data());
     if (index_status != IndexStatus::NO_INDEX) {
-        glDeleteBuffers(1, &index_buffer);
+        MemoryTracker::DeleteBuffers(1, &index_buffer);
     }
 }
+void Mesh::Release() {
+    glDeleteVertexArrays(1, &vertex_array);
+    MemoryTracker::DeleteBuffers(1, &vertex_buffer);
+    MemoryTracker::DeleteBuffers(buffers.size(), buffers.data());
+    if (index_status != IndexStatus::NO_INDEX) {
+        MemoryTracker::DeleteBuffers(1, &index_buffer);
+    }
+    vertex_array = vertex_buffer = index_buffer = 0;
+    buffers.clear();
+}
+size_t Mesh::GetMemorySize() const {
+    auto buffer_size = [](GLuint buffer) -> size_t {
+        if (buffer == 0)
+            return 0;
+        GLint64 size = 0;
+        glGetNamedBufferParameteri64v(buffer, GL_BUFFER_SIZE, &size);
+        return static_cast<size_t>(size);
+    };
+    size_t total = buffer_size(vertex_buffer);
+    if (index_status != IndexStatus::NO_INDEX) {
+        total += buffer_size(index_buffer);
+    }
+    for (GLuint b : buffers)
+        total += buffer_size(b);
+    return total;
+}
 Texture::Texture() {
     texture_id = 0;
 }
 Texture::~Texture() {
-    glDeleteTextures(1, &texture_id);
+    MemoryTracker::DeleteTextures(1, &texture_id);
+}
+void Texture::Release() {
+    MemoryTracker::DeleteTextures(1, &texture_id);
+    texture_id = 0;
 }
 
+TextureStaging::TextureStaging(const std::string& path, GLenum required_target)
+    : head_data(sizeof(TextureFileN)),
+      head_size(0),
+      pbo{nullptr, 0},
+      data(nullptr),
+      bound(false) {
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("Cannot open file:" + path);
+    }
+    in.seekg(0, std::ios::end);
+    size_t length = in.tellg();
+    in.seekg(0, std::ios::beg);
+    if (length <= sizeof(uint64)) {
+        throw std::runtime_error("Texture head code error.");
+    }
+    Byte* file_data = (Byte*)MemoryTracker::Allocate(length,
+                                                     MemoryTag::Texture);
+    in.read((char*)file_data, length);
+    in.close();
+    try {
+        if (*(uint64*)file_data != TEXTURE_HEADER) {
+            throw std::runtime_error("Texture head code error.");
+        }
+        InflateStream inflate(file_data + sizeof(uint64));
+        inflate.Read(head_data.data(), sizeof(TextureFileN));
+        const TextureFileN& head = File();
+        if (head.mipLevels < 1) {
+            throw std::runtime_error("Texture head code error.");
+        }
+        if (required_target != GL_NONE && head.target != required_target) {
+            throw std::runtime_error("Texture target error:" + path);
+        }
+        head_size =
+            sizeof(TextureFileN) + sizeof(TextureMipData) * head.mipLevels;
+        head_data.resize(head_size);
+        inflate.Read(head_data.data() + sizeof(TextureFileN),
+                     head_size - sizeof(TextureFileN));
+        length = inflate.GetRemaining();
+        pbo = DefaultUploadRing().Allocate(length);
+        if (pbo.pointer == nullptr) {
+            data = (Byte*)MemoryTracker::Allocate(length, MemoryTag::Texture);
+        }
+        inflate.Read(pbo.pointer ? pbo.pointer : data, length);
+    } catch (...) {
+        MemoryTracker::Free(file_data);
+        MemoryTracker::Free(data);
+        throw;
+    }
+    MemoryTracker::Free(file_data);
+}
+TextureStaging::~TextureStaging() {
+    if (bound) {
+        End();
+    }
+    MemoryTracker::Free(data);
+}
+const void* TextureStaging::Pixels(GLsizei level) const {
+    size_t start = File().mip[level].range.start - head_size;
+    return pbo.pointer ? (const void*)(uintptr_t)(pbo.offset + start)
+                       : (const void*)(data + start);
+}
+void TextureStaging::Begin() {
+    if (pbo.pointer) {
+        DefaultUploadRing().Bind();
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    bound = true;
+}
+void TextureStaging::End() {
+    if (pbo.pointer) {
+        UploadRing::Unbind();
+        DefaultUploadRing().Fence();
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    bound = false;
+}
 void Texture::LoadTexture(const std::string& path,
                           Texture& tex,
                           GLsizei add_mipmap_level,
@@ -474,32 +582,9 @@ void Texture::LoadTexture(const std::string& path,
     if (add_mipmap_level < 0) {
         throw std::logic_error("argument add_mipmap_level can't be negative.");
     }
-    std::ifstream in(path, std::ios::in | std::ios::binary);
-    {
-        if (!in.is_open()) {
-            throw std::runtime_error("Cannot open file:" + path);
-        }
-        uint64 head;
-        in.read((char*)&head, sizeof(uint64));
-        if (head != TEXTURE_HEADER) {
-            throw std::runtime_error("Texture head code error.");
-        }
-    }
-    size_t length, end;
-    length = in.tellg();
-    in.seekg(0, std::ios::end);
-    end = in.tellg();
-    length = end - length;
-    Byte* data = (Byte*)malloc(length);
-    if (!data) {
-        in.close();
-        throw std::bad_alloc();
-    }
-    in.seekg(sizeof(uint64), std::ios::beg);
-    in.read((char*)data, length);
-    in.close();
-
-    TextureFileN& tf = *(TextureFileN*)data;
+    TextureStaging staging(path);
+    const TextureFileN& tf = staging.File();
+    staging.Begin();
     glCreateTextures(tf.target, 1, &tex.texture_id);
     tex.target = tf.target;
     tex.width = tf.mip[0].width;
@@ -509,50 +594,84 @@ void Texture::LoadTexture(const std::string& path,
         glTextureParameteriv(tex.texture_id, GL_TEXTURE_SWIZZLE_RGBA,
                              (GLint*)tf.swizzle);
     }
+    // 块压缩格式使用glCompressedTextureSubImage*, 数据长度取自mip表
+    const bool compressed = TextureCompressedBlockSize(tf.internal_format) > 0;
+    auto upload2d = [&](GLsizei i, GLsizei height, GLsizei count) {
+        if (compressed) {
+            glCompressedTextureSubImage2D(
+                tex.texture_id, i, 0, 0, tf.mip[i].width, height,
+                tf.internal_format,
+                static_cast<GLsizei>(tf.mip[i].range.length * count),
+                staging.Pixels(i));
+        } else {
+            glTextureSubImage2D(tex.texture_id, i, 0, 0, tf.mip[i].width,
+                                height, tf.format, tf.type,
+                                staging.Pixels(i));
+        }
+    };
+    auto upload3d = [&](GLsizei i, GLsizei depth, GLsizei count) {
+        if (compressed) {
+            glCompressedTextureSubImage3D(
+                tex.texture_id, i, 0, 0, 0, tf.mip[i].width, tf.mip[i].height,
+                depth, tf.internal_format,
+                static_cast<GLsizei>(tf.mip[i].range.length * count),
+                staging.Pixels(i));
+        } else {
+            glTextureSubImage3D(tex.texture_id, i, 0, 0, 0, tf.mip[i].width,
+                                tf.mip[i].height, depth, tf.format, tf.type,
+                                staging.Pixels(i));
+        }
+    };
     if (tf.target == GL_TEXTURE_1D) {
-        glTextureStorage1D(tex.texture_id, tf.mipLevels + add_mipmap_level,
-                           tf.internal_format, tf.mip[0].width);
+        MemoryTracker::TextureStorage1D(MemoryTag::Texture, tex.texture_id,
+                                        tf.mipLevels + add_mipmap_level,
+                                        tf.internal_format, tf.mip[0].width);
         for (GLsizei i = 0; i < tf.mipLevels; i++) {
             glTextureSubImage1D(tex.texture_id, i, 0, tf.mip[i].width,
                                 tf.format, tf.type,
-                                data + tf.mip[i].range.start);
+                                staging.Pixels(i));
         }
     } else if (tf.target == GL_TEXTURE_2D) {
-        glTextureStorage2D(tex.texture_id, tf.mipLevels + add_mipmap_level,
-                           tf.internal_format, tf.mip[0].width,
-                           tf.mip[0].height);
+        MemoryTracker::TextureStorage2D(MemoryTag::Texture, tex.texture_id,
+                                        tf.mipLevels + add_mipmap_level,
+                                        tf.internal_format, tf.mip[0].width,
+                                        tf.mip[0].height);
         for (GLsizei i = 0; i < tf.mipLevels; i++) {
-            glTextureSubImage2D(tex.texture_id, i, 0, 0, tf.mip[i].width,
-                                tf.mip[i].height, tf.format, tf.type,
-                                data + tf.mip[i].range.start);
+            upload2d(i, tf.mip[i].height, 1);
         }
     } else if (tf.target == GL_TEXTURE_3D) {
-        glTextureStorage3D(tex.texture_id, tf.mipLevels + add_mipmap_level,
-                           tf.internal_format, tf.mip[0].width,
-                           tf.mip[0].height, tf.mip[0].depth);
+        MemoryTracker::TextureStorage3D(MemoryTag::Texture, tex.texture_id,
+                                        tf.mipLevels + add_mipmap_level,
+                                        tf.internal_format, tf.mip[0].width,
+                                        tf.mip[0].height, tf.mip[0].depth);
         for (GLsizei i = 0; i < tf.mipLevels; i++) {
-            glTextureSubImage3D(tex.texture_id, i, 0, 0, 0, tf.mip[i].width,
-                                tf.mip[i].height, tf.mip[i].depth, tf.format,
-                                tf.type, data + tf.mip[i].range.start);
+            upload3d(i, tf.mip[i].depth, 1);
         }
     } else if (tf.target == GL_TEXTURE_1D_ARRAY) {
-        glTextureStorage2D(tex.texture_id, tf.mipLevels + add_mipmap_level,
-                           tf.internal_format, tf.mip[0].width, tf.slices);
+        MemoryTracker::TextureStorage2D(MemoryTag::Texture, tex.texture_id,
+                                        tf.mipLevels + add_mipmap_level,
+                                        tf.internal_format, tf.mip[0].width,
+                                        tf.slices);
         for (GLsizei i = 0; i < tf.mipLevels; i++) {
-            glTextureSubImage2D(tex.texture_id, i, 0, 0, tf.mip[i].width,
-                                tf.slices, tf.format, tf.type,
-                                data + tf.mip[i].range.start);
+            upload2d(i, tf.slices, tf.slices);
+        }
+    } else if (tf.target == GL_TEXTURE_CUBE_MAP) {
+        // 立方体贴图以2D分配存储, 以zoffset为面序号上传6个面
+        MemoryTracker::TextureStorage2D(MemoryTag::Texture, tex.texture_id,
+                                        tf.mipLevels + add_mipmap_level,
+                                        tf.internal_format, tf.mip[0].width,
+                                        tf.mip[0].height);
+        for (GLsizei i = 0; i < tf.mipLevels; i++) {
+            upload3d(i, 6, 6);
         }
     } else if (tf.target == GL_TEXTURE_2D_ARRAY ||
-               tf.target == GL_TEXTURE_CUBE_MAP ||
                tf.target == GL_TEXTURE_CUBE_MAP_ARRAY) {
-        glTextureStorage3D(tex.texture_id, tf.mipLevels + add_mipmap_level,
-                           tf.internal_format, tf.mip[0].width,
-                           tf.mip[0].height, tf.slices);
+        MemoryTracker::TextureStorage3D(MemoryTag::Texture, tex.texture_id,
+                                        tf.mipLevels + add_mipmap_level,
+                                        tf.internal_format, tf.mip[0].width,
+                                        tf.mip[0].height, tf.slices);
         for (GLsizei i = 0; i < tf.mipLevels; i++) {
-            glTextureSubImage3D(tex.texture_id, i, 0, 0, 0, tf.mip[i].width,
-                                tf.mip[i].height, tf.slices, tf.format, tf.type,
-                                data + tf.mip[i].range.start);
+            upload3d(i, tf.slices, tf.slices);
         }
     } else if (tf.target == GL_TEXTURE_2D_MULTISAMPLE) {
         glTexStorage2DMultisample(tex.texture_id, samples, tf.internal_format,
@@ -560,7 +679,7 @@ void Texture::LoadTexture(const std::string& path,
                                   fixedsample);
         glTextureSubImage2D(tex.texture_id, 0, 0, 0, tf.mip[0].width,
                             tf.mip[0].height, tf.format, tf.type,
-                            data + tf.mip[0].range.start);
+                            staging.Pixels(0));
         if (tf.mipLevels > 1) {
             WARNING("OpenGL", "多重采样纹理不应含有mipmap");
         }
@@ -570,17 +689,18 @@ void Texture::LoadTexture(const std::string& path,
                                   fixedsample);
         glTextureSubImage3D(tex.texture_id, 0, 0, 0, 0, tf.mip[0].width,
                             tf.mip[0].height, tf.slices, tf.format, tf.type,
-                            data + tf.mip[0].range.start);
+                            staging.Pixels(0));
         if (tf.mipLevels > 1) {
             WARNING("OpenGL", "多重采样纹理不应含有mipmap");
         }
     }
+    staging.End();
 }
-inline void Texture::LoadTexture(const char* path,
-                                 Texture& tex,
-                                 GLsizei add_mipmap_level,
-                                 GLsizei samples,
-                                 GLboolean fixedsample) {
+void Texture::LoadTexture(const char* path,
+                          Texture& tex,
+                          GLsizei add_mipmap_level,
+                          GLsizei samples,
+                          GLboolean fixedsample) {
     LoadTexture(std::string(path), tex, add_mipmap_level, samples, fixedsample);
 }
 void Texture::PackTexture(const std::string& save_path,
@@ -597,7 +717,7 @@ void Texture::PackTexture(const std::string& save_path,
     }
     out.write((char*)data, length);
     out.close();
-    free(data);
+    MemoryTracker::Free(data);
 }
 constexpr size_t TextureInternalFormatSize(GLenum type) {
     if (type == GL_R3_G3_B2 || type == GL_R8 || type == GL_R8_SNORM ||
@@ -712,7 +832,7 @@ constexpr size_t TypeSize(GLenum type) {
     }
 }
 constexpr size_t TextureExternalFormatSize(GLenum format, GLenum type) {
-    size_t res;
+    size_t res = 0;
     if (format == GL_RED || format == GL_GREEN || format == GL_BLUE ||
         format == GL_RED_INTEGER || format == GL_GREEN_INTEGER ||
         format == GL_BLUE_INTEGER) {
@@ -727,14 +847,68 @@ constexpr size_t TextureExternalFormatSize(GLenum format, GLenum type) {
     res *= TypeSize(type);
     return res;
 }
+size_t TexturePixelSize(GLenum format, GLenum type) {
+    return TextureExternalFormatSize(format, type);
+}
+size_t TextureStorageSize(GLenum internal_format,
+                          GLsizei levels,
+                          GLsizei width,
+                          GLsizei height,
+                          GLsizei depth,
+                          bool array) {
+    const size_t block = TextureCompressedBlockSize(internal_format);
+    const size_t texel = TextureInternalFormatSize(internal_format);
+    size_t total = 0;
+    GLsizei w = std::max(width, 1), h = std::max(height, 1),
+            d = std::max(depth, 1);
+    for (GLsizei i = 0; i < levels; i++) {
+        if (block > 0) {
+            total +=
+                static_cast<size_t>((w + 3) / 4) * ((h + 3) / 4) * block * d;
+        } else {
+            total += static_cast<size_t>(w) * h * d * texel;
+        }
+        w = std::max(w / 2, 1);
+        h = std::max(h / 2, 1);
+        if (!array)  // 数组纹理的层数不随层级减半
+            d = std::max(d / 2, 1);
+    }
+    return total;
+}
+size_t Texture::GetMemorySize() const {
+    if (texture_id == 0)
+        return 0;
+    GLint levels = 0, internal_format = 0;
+    glGetTextureParameteriv(texture_id, GL_TEXTURE_IMMUTABLE_LEVELS, &levels);
+    glGetTextureLevelParameteriv(texture_id, 0, GL_TEXTURE_INTERNAL_FORMAT,
+                                 &internal_format);
+    const size_t block = TextureCompressedBlockSize(internal_format);
+    const size_t texel = TextureInternalFormatSize(internal_format);
+    // 立方体贴图的depth查询为0, 每层有6个面
+    const size_t faces = target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+    size_t total = 0;
+    for (GLint i = 0; i < std::max(levels, 1); i++) {
+        GLint w = 0, h = 0, d = 0;
+        glGetTextureLevelParameteriv(texture_id, i, GL_TEXTURE_WIDTH, &w);
+        glGetTextureLevelParameteriv(texture_id, i, GL_TEXTURE_HEIGHT, &h);
+        glGetTextureLevelParameteriv(texture_id, i, GL_TEXTURE_DEPTH, &d);
+        size_t slices = static_cast<size_t>(std::max(d, 1)) * faces;
+        if (block > 0) {
+            total += static_cast<size_t>((w + 3) / 4) * ((h + 3) / 4) * block *
+                     slices;
+        } else {
+            total += static_cast<size_t>(w) * std::max(h, 1) * texel * slices;
+        }
+    }
+    return total;
+}
 Byte* Texture::PackTexture(size_t* ret_length,
                            Texture& tex,
                            GLsizei level,
                            GLenum format,
                            GLenum type) {
     // 统计纹理文件数据的长度
-    size_t length = sizeof(TextureFileN) + sizeof(TextureMipData) * level,
-           maxlen = 0;
+    size_t length = sizeof(TextureFileN) + sizeof(TextureMipData) * level;
     TextureMipData mips[level];  // 暂存mipmap数据
     size_t format_size, cnt;
     format_size =
@@ -758,33 +932,39 @@ Byte* Texture::PackTexture(size_t* ret_length,
             cnt *= mips[i].depth;
         }
         mips[i].range.length = cnt * format_size;
-        if (mips[i].range.length > maxlen) {
-            maxlen = mips[i].range.length;
-        }
         length += mips[i].range.length;
     }
-    Byte *data = (Byte*)malloc(length), *cur = data;
+    Byte* data = (Byte*)MemoryTracker::Allocate(length, MemoryTag::Texture);
+    Byte* cur = data;
     if (!data) {
         throw std::bad_alloc();
     }
     TextureFileN& head = *(TextureFileN*)data;
     cur += sizeof(TextureFileN) + sizeof(TextureMipData) * level;
 
+    // 先发出所有层级的读取, 最后只映射一次, 只等待GPU一次
+    const size_t pixel_length =
+        length - sizeof(TextureFileN) - sizeof(TextureMipData) * level;
     GLuint ppb;
     glCreateBuffers(1, &ppb);
     glBindBuffer(GL_PIXEL_PACK_BUFFER, ppb);
-    glNamedBufferStorage(ppb, maxlen, nullptr, GL_MAP_READ_BIT);
-    // 读取纹理数据
+    MemoryTracker::BufferStorage(MemoryTag::Texture, ppb, pixel_length, nullptr,
+                                 GL_MAP_READ_BIT);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);  // 与range.length的计算一致
+    size_t offset = 0;
     for (GLsizei i = 0; i < level; i++) {
-        glGetTextureImage(tex.texture_id, i, format, type, maxlen, 0);
-        void* map = glMapNamedBuffer(ppb, GL_READ_ONLY);
-        memcpy(cur, map, mips[i].range.length);
-        glUnmapNamedBuffer(ppb);
-        head.mip[i].range.start = cur - data;
-        cur += head.mip[i].range.length;
+        glGetTextureImage(tex.texture_id, i, format, type,
+                          static_cast<GLsizei>(mips[i].range.length),
+                          (void*)(uintptr_t)offset);
+        mips[i].range.start = cur - data + offset;
+        offset += mips[i].range.length;
     }
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    void* map = glMapNamedBufferRange(ppb, 0, pixel_length, GL_MAP_READ_BIT);
+    memcpy(cur, map, pixel_length);
+    glUnmapNamedBuffer(ppb);
     glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-    glDeleteBuffers(1, &ppb);
+    MemoryTracker::DeleteBuffers(1, &ppb);
     // 生成TextureFile头数据
     memcpy(head.mip, mips, sizeof(TextureMipData) * level);
     head.target = tex.target;
@@ -822,37 +1002,157 @@ Byte* Texture::PackTexture(size_t* ret_length,
     // 压缩
     Byte* compress = CompressData(data, &length, sizeof(uint64));
     *ret_length = length;
-    free(data);
+    MemoryTracker::Free(data);
     *(uint64*)compress = TEXTURE_HEADER;
     return compress;
 }
-inline void Texture::PackTexture(const char* save_path,
-                                 Texture& tex,
-                                 GLsizei level,
-                                 GLenum format,
-                                 GLenum type) {
+void Texture::PackTexture(const char* save_path,
+                          Texture& tex,
+                          GLsizei level,
+                          GLenum format,
+                          GLenum type) {
     PackTexture(std::string(save_path), tex, level, format, type);
 }
-inline void Texture::GenTextureFile(const std::string& path) {
-    TextureFile<1> tf;
-    tf.target = GL_TEXTURE_2D;
+namespace {
+// 烘焙时RGB(A)数据是否按sRGB处理
+bool CookAsSRGB(const TextureCookArg& arg, int channels) {
+    return arg.srgb && channels >= 3 &&
+           (arg.usage == TextureUsage::COLOR || arg.usage == TextureUsage::UI);
+}
+// 预处理并生成mip链: 按尺寸上限缩小, 法线贴图每层重新归一化
+std::vector<ImageF> PrepareCookChain(ImageF&& base,
+                                     const TextureCookArg& arg,
+                                     int channels) {
+    GLsizei max_size = arg.max_size >= 0
+                           ? arg.max_size
+                           : texture_usage_max_size[static_cast<int>(arg.usage)];
+    std::vector<ImageF> chain =
+        GenMipChain(LimitImageSize(std::move(base), max_size), arg.mip_filter,
+                    arg.mip_levels);
+    if (arg.usage == TextureUsage::NORMAL) {
+        for (ImageF& level : chain)
+            RenormalizeNormals(level, channels);
+    }
+    return chain;
+}
+// 读取源图像并生成mip链; channels为0时使用图像自身的通道数, 否则转换为该通道数
+// HDR图像(stbi_is_hdr)以线性float读取, hdr返回其打包格式
+std::vector<ImageF> LoadCookSource(const std::string& path,
+                                   const TextureCookArg& arg,
+                                   int* channels,
+                                   TextureHDRFormat* hdr) {
+    int width, height, n;
+    ImageF base;
+    *hdr = TextureHDRFormat::NONE;
+    if (stbi_is_hdr(path.c_str())) {
+        // HDR图像: stbi_loadf返回线性float数据
+        float* image = stbi_loadf(path.c_str(), &width, &height, &n, *channels);
+        if (image == nullptr) {
+            throw std::runtime_error("STB_IMAGE:无法加载图像:" + path);
+        }
+        n = *channels > 0 ? *channels : n;
+        base = ImageFromFloats(image, width, height, n);
+        stbi_image_free(image);
+        *hdr = arg.hdr_format == TextureHDRFormat::NONE ? TextureHDRFormat::HALF
+                                                         : arg.hdr_format;
+    } else {
+        Byte* image =
+            (Byte*)stbi_load(path.c_str(), &width, &height, &n, *channels);
+        if (image == nullptr) {
+            throw std::runtime_error("STB_IMAGE:无法加载图像:" + path);
+        }
+        n = *channels > 0 ? *channels : n;
+        base = ImageFromBytes(image, width, height, n, CookAsSRGB(arg, n));
+        stbi_image_free(image);
+    }
+    *channels = n;
+    return PrepareCookChain(std::move(base), arg, n);
+}
+void WriteCookedTexture(const std::string& path, Byte* data, size_t size) {
+    std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        MemoryTracker::Free(data);
+        throw std::runtime_error("Cannot open file:" + path);
+    }
+    out.write((char*)data, size);
+    out.close();
+    MemoryTracker::Free(data);
+}
+}  // namespace
+Byte* Texture::GenTextureData(size_t* ret_length,
+                              const std::vector<std::vector<ImageF>>& layers,
+                              int n,
+                              const TextureCookArg& arg,
+                              TextureHDRFormat hdr,
+                              GLenum target) {
+    if (layers.empty() || layers[0].empty()) {
+        throw std::runtime_error("纹理数据为空");
+    }
+    const std::vector<ImageF>& chain = layers[0];
+    for (const std::vector<ImageF>& layer : layers) {
+        if (layer.size() != chain.size() ||
+            layer[0].width != chain[0].width ||
+            layer[0].height != chain[0].height) {
+            throw std::runtime_error("纹理数组切片尺寸不一致");
+        }
+    }
+    bool srgb = CookAsSRGB(arg, n) && hdr == TextureHDRFormat::NONE;
+    GLsizei slices = static_cast<GLsizei>(layers.size());
+    if (target == GL_NONE) {
+        target = slices > 1 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+    }
+    if ((target == GL_TEXTURE_2D && slices != 1) ||
+        (target == GL_TEXTURE_CUBE_MAP && slices != 6) ||
+        (target == GL_TEXTURE_CUBE_MAP_ARRAY && slices % 6 != 0)) {
+        throw std::runtime_error("纹理切片数与类型不符");
+    }
+    if ((target == GL_TEXTURE_CUBE_MAP || target == GL_TEXTURE_CUBE_MAP_ARRAY) &&
+        chain[0].width != chain[0].height) {
+        throw std::runtime_error("立方体贴图的面必须为正方形");
+    }
+    TextureCompression compression = arg.compression;
+    if (hdr != TextureHDRFormat::NONE) {
+        if (compression != TextureCompression::NONE) {
+            WARNING("Texture", "HDR纹理不支持块压缩, 已忽略");
+        }
+        compression = TextureCompression::NONE;
+    }
+    // 每像素字节数
+    size_t texel_size = n;
+    if (hdr == TextureHDRFormat::RGB9E5 || hdr == TextureHDRFormat::R11G11B10F) {
+        texel_size = sizeof(uint32);
+    } else if (hdr == TextureHDRFormat::HALF) {
+        texel_size = sizeof(uint16) * n;
+    }
+    if (compression == TextureCompression::AUTO) {
+        const TextureCompression by_channels[4] = {
+            TextureCompression::BC4, TextureCompression::BC5,
+            TextureCompression::BC1, TextureCompression::BC3};
+        compression = by_channels[n - 1];
+    }
+    auto level_size = [&](const ImageF& level) {
+        return compression == TextureCompression::NONE
+                   ? static_cast<size_t>(level.width) * level.height * texel_size
+                   : BCnEncodedSize(compression, level.width, level.height);
+    };
+    GLsizei levels = static_cast<GLsizei>(chain.size());
+    size_t head_size = sizeof(TextureFileN) + sizeof(TextureMipData) * levels;
+    size_t total = 0;
+    for (const ImageF& level : chain) {
+        total += level_size(level) * slices;
+    }
+    Byte* data = (Byte*)MemoryTracker::Allocate(head_size + total,
+                                                MemoryTag::Texture);
+    if (!data) {
+        throw std::bad_alloc();
+    }
+    TextureFileN& tf = *(TextureFileN*)data;
+    tf.target = target;
     tf.type = GL_UNSIGNED_BYTE;
     tf.enable_swizzle = GL_FALSE;
-    tf.mipLevels = 1;
-    tf.slices = 0;
-    int n;
-    Byte *data = (Byte*)stbi_load(path.c_str(), &tf.mip[0].width,
-                                  &tf.mip[0].height, &n, 0),
-         *copy;
-    if (data == nullptr) {
-        throw std::runtime_error("STB_IMAGE:无法加载图像");
-    }
-    tf.totalSize = tf.mip[0].range.length =
-        tf.mip[0].width * tf.mip[0].height * n * sizeof(uint8_t);
-    tf.mip[0].depth = 0;
-    tf.mip[0].range.start = sizeof(tf);
-    std::cout << "File:\t" << path << '\n';
-    std::cout << "Image Data Size:\t" << tf.totalSize << "Bytes\n";
+    tf.mipLevels = levels;
+    tf.slices = target == GL_TEXTURE_2D ? 0 : slices;
+    tf.totalSize = total;
     switch (n) {
         case 1:
             tf.internal_format = GL_R8;
@@ -871,7 +1171,7 @@ inline void Texture::GenTextureFile(const std::string& path) {
             tf.swizzle[3] = GL_ZERO;
             break;
         case 3:
-            tf.internal_format = GL_RGB8;
+            tf.internal_format = srgb ? GL_SRGB8 : GL_RGB8;
             tf.format = GL_RGB;
             tf.swizzle[0] = GL_RED;
             tf.swizzle[1] = GL_GREEN;
@@ -879,7 +1179,7 @@ inline void Texture::GenTextureFile(const std::string& path) {
             tf.swizzle[3] = GL_ZERO;
             break;
         case 4:
-            tf.internal_format = GL_RGBA8;
+            tf.internal_format = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
             tf.format = GL_RGBA;
             tf.swizzle[0] = GL_RED;
             tf.swizzle[1] = GL_GREEN;
@@ -887,23 +1187,158 @@ inline void Texture::GenTextureFile(const std::string& path) {
             tf.swizzle[3] = GL_ALPHA;
             break;
         default:
+            MemoryTracker::Free(data);
             throw std::runtime_error("图像通道数错误");
     }
-    copy = (Byte*)malloc(sizeof(tf) + tf.totalSize);
-    if (!copy) {
-        throw std::bad_alloc();
+    if (hdr == TextureHDRFormat::RGB9E5 || hdr == TextureHDRFormat::R11G11B10F) {
+        // 没有alpha通道, 少于3通道的图像其余分量为0
+        tf.internal_format =
+            hdr == TextureHDRFormat::RGB9E5 ? GL_RGB9_E5 : GL_R11F_G11F_B10F;
+        tf.format = GL_RGB;
+        tf.type = hdr == TextureHDRFormat::RGB9E5
+                      ? GL_UNSIGNED_INT_5_9_9_9_REV
+                      : GL_UNSIGNED_INT_10F_11F_11F_REV;
+    } else if (hdr == TextureHDRFormat::HALF) {
+        const GLenum half_formats[4] = {GL_R16F, GL_RG16F, GL_RGB16F,
+                                        GL_RGBA16F};
+        tf.internal_format = half_formats[n - 1];
+        tf.type = GL_HALF_FLOAT;
+    }
+    std::vector<Byte> pixels;
+    if (compression != TextureCompression::NONE) {
+        // 块压缩数据自带通道语义, format/type不再使用
+        tf.internal_format = BCnInternalFormat(compression, srgb);
+        tf.format = GL_NONE;
+        tf.type = GL_NONE;
+        pixels.resize(static_cast<size_t>(chain[0].width) * chain[0].height * n);
+    }
+    // 同一层级的所有切片连续存放, range.length为单个切片的长度
+    size_t start = head_size;
+    for (GLsizei i = 0; i < levels; i++) {
+        tf.mip[i].width = chain[i].width;
+        tf.mip[i].height = chain[i].height;
+        tf.mip[i].depth = tf.slices;
+        tf.mip[i].range.start = start;
+        tf.mip[i].range.length = level_size(chain[i]);
+        for (const std::vector<ImageF>& layer : layers) {
+            if (hdr == TextureHDRFormat::RGB9E5) {
+                ImageToRGB9E5(layer[i], data + start);
+            } else if (hdr == TextureHDRFormat::R11G11B10F) {
+                ImageToR11G11B10F(layer[i], data + start);
+            } else if (hdr == TextureHDRFormat::HALF) {
+                ImageToHalf(layer[i], n, data + start);
+            } else if (compression == TextureCompression::NONE) {
+                ImageToBytes(layer[i], n, srgb, data + start);
+            } else {
+                ImageToBytes(layer[i], n, srgb, pixels.data());
+                EncodeBCn(pixels.data(), chain[i].width, chain[i].height, n,
+                          compression, data + start);
+            }
+            start += tf.mip[i].range.length;
+        }
     }
-    memcpy(copy, &tf, sizeof(tf));
-    memcpy(copy + sizeof(tf), data, tf.totalSize);
-    stbi_image_free(data);
-    size_t size = tf.totalSize;
-    Byte* compress = CompressData(copy, &size, sizeof(uint64));
-    free(copy);
+    std::cout << "Mipmap Levels:\t" << levels << '\n';
+    std::cout << "Slices:\t" << slices << '\n';
+    std::cout << "Internal Format:\t0x" << std::hex << tf.internal_format
+              << std::dec << '\n';
+    std::cout << "Image Data Size:\t" << tf.totalSize << "Bytes\n";
+    size_t size = head_size + total;
+    Byte* compress = CompressData(data, &size, sizeof(uint64));
+    MemoryTracker::Free(data);
     *(uint64*)compress = TEXTURE_HEADER;
-    std::ofstream out(std::string(path) + ".out.texture",
-                      std::ios::out | std::ios::binary | std::ios::trunc);
-    out.write((char*)compress, size);
-    out.close();
+    *ret_length = size;
+    return compress;
+}
+void Texture::GenTextureFile(const std::string& path,
+                             const TextureCookArg& arg) {
+    int n = 0;
+    TextureHDRFormat hdr;
+    std::vector<std::vector<ImageF>> layers(1);
+    layers[0] = LoadCookSource(path, arg, &n, &hdr);
+    std::cout << "File:\t" << path << '\n';
+    size_t size;
+    Byte* compress = GenTextureData(&size, layers, n, arg, hdr);
+    WriteCookedTexture(path + ".out.texture", compress, size);
+}
+void Texture::GenORMTextureFile(const std::string& occlusion,
+                                const std::string& roughness,
+                                const std::string& metalness,
+                                const std::string& save_path,
+                                const TextureCookArg& arg) {
+    TextureCookArg orm_arg = arg;
+    orm_arg.usage = TextureUsage::MASK;
+    const std::string* paths[3] = {&occlusion, &roughness, &metalness};
+    const float defaults[3] = {1.0f, 1.0f, 0.0f};
+    ImageF sources[3];
+    GLsizei width = 0, height = 0;
+    for (int c = 0; c < 3; c++) {
+        if (paths[c]->empty())
+            continue;
+        int w, h, n;
+        Byte* image = (Byte*)stbi_load(paths[c]->c_str(), &w, &h, &n, 1);
+        if (image == nullptr) {
+            throw std::runtime_error("STB_IMAGE:无法加载图像:" + *paths[c]);
+        }
+        sources[c] = ImageFromBytes(image, w, h, 1, false);
+        stbi_image_free(image);
+        // 取各通道中最小的尺寸, 其余只需缩小
+        width = width == 0 ? w : std::min(width, w);
+        height = height == 0 ? h : std::min(height, h);
+    }
+    if (width == 0) {
+        throw std::runtime_error("ORM纹理至少需要一张图像");
+    }
+    for (ImageF& src : sources) {
+        if (!src.pixels.empty() && (src.width != width || src.height != height))
+            src = DownsampleImage(src, width, height, MipFilter::BOX);
+    }
+    ImageF packed{width, height, {}};
+    packed.pixels.resize(static_cast<size_t>(width) * height * 4);
+    int64_t count = static_cast<int64_t>(width) * height;
+#pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < count; i++) {
+        float* p = &packed.pixels[i * 4];
+        for (int c = 0; c < 3; c++)
+            p[c] = sources[c].pixels.empty() ? defaults[c]
+                                             : sources[c].pixels[i * 4];
+        p[3] = 1.0f;
+    }
+    for (ImageF& src : sources)
+        src.pixels = std::vector<float>();
+    std::vector<std::vector<ImageF>> layers(1);
+    layers[0] = PrepareCookChain(std::move(packed), orm_arg, 3);
+    std::cout << "File:\t" << save_path << '\n';
+    size_t size;
+    Byte* compress = GenTextureData(&size, layers, 3, orm_arg);
+    WriteCookedTexture(save_path, compress, size);
+}
+void Texture::GenTextureArrayFile(const std::vector<std::string>& paths,
+                                  const std::string& save_path,
+                                  GLenum target,
+                                  const TextureCookArg& arg) {
+    if (paths.empty()) {
+        throw std::runtime_error("纹理数组没有图像");
+    }
+    // 所有切片转换为第一张图像的通道数与格式
+    int n = 0;
+    TextureHDRFormat hdr = TextureHDRFormat::NONE;
+    std::vector<std::vector<ImageF>> layers(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        TextureHDRFormat layer_hdr;
+        layers[i] = LoadCookSource(paths[i], arg, &n, &layer_hdr);
+        if (i == 0) {
+            hdr = layer_hdr;
+        } else if (layer_hdr != hdr) {
+            throw std::runtime_error("纹理数组不能混合HDR与LDR图像:" + paths[i]);
+        }
+    }
+    std::cout << "File:\t" << save_path << '\n';
+    size_t size;
+    Byte* compress = GenTextureData(&size, layers, n, arg, hdr, target);
+    WriteCookedTexture(save_path, compress, size);
+}
+void Texture::GenTextureFile(const std::string& path) {
+    GenTextureFile(path, TextureCookArg());
 }
 void Texture::GenTextureFile(const char* path) {
     GenTextureFile(std::string(path));
@@ -1,6 +1,8 @@
 #ifndef _BOUNDLESS_RESOURCE_HPP_FILE_
 #define _BOUNDLESS_RESOURCE_HPP_FILE_
 #include <initializer_list>
+#include <memory_resource>
+#include "bl_upload_ring.hpp"
 #include "boundless_base.hpp"
 namespace Boundless {
 ///////////////////////////////////////////////
@@ -42,7 +44,7 @@ const GLenum opengl_buffer_storage = GL_MAP_READ_BIT;
 class Mesh {
    private:
     GLuint vertex_array, vertex_buffer, index_buffer;
-    std::vector<GLuint> buffers;
+    std::pmr::vector<GLuint> buffers;
     GLenum primitive_type;
     IndexStatus index_status;
     GLuint restart_index;
@@ -66,7 +68,10 @@ class Mesh {
         GLenum index_type;
         GLsizei mesh_count;
     } Mesh();                                  // 不做任何事
-    Mesh(IndexStatus indexst, size_t bufcnt);  // 按index状态和buffer数初始化
+    // 按index状态和buffer数初始化, resource为buffers使用的内存资源
+    Mesh(IndexStatus indexst,
+         size_t bufcnt,
+         std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     Mesh(Mesh&&) noexcept = default;
     Mesh(const Mesh&) = delete;
     Mesh& operator=(Mesh&&) noexcept = default;
@@ -78,29 +83,35 @@ class Mesh {
     void InitMesh(const MeshInitArg& args,
                   std::initializer_list<MeshInit> list);
     // 获取数据方法
-    const std::vector<GLuint>& getBuffer();
-    void setPrimitiveType(GLenum type);
-    void setRestartIndex(GLuint index);
-    GLenum getIndexType();
-    GLenum getPrimitiveType();
-    IndexStatus getIndexStatus();
-    GLuint getCount();
-    GLuint getRestartIndex();
-    GLuint getVAO();
-    GLuint getVBO();
-    GLuint getIBO();
+    inline const std::pmr::vector<GLuint>& getBuffer() { return buffers; }
+    inline void setPrimitiveType(GLenum type) { primitive_type = type; }
+    inline void setRestartIndex(GLuint index) { restart_index = index; }
+    inline GLenum getIndexType() { return index_type; }
+    inline GLenum getPrimitiveType() { return primitive_type; }
+    inline IndexStatus getIndexStatus() { return index_status; }
+    inline GLuint getCount() { return mesh_count; }
+    inline GLuint getRestartIndex() { return restart_index; }
+    inline GLuint getVAO() { return vertex_array; }
+    inline GLuint getVBO() { return vertex_buffer; }
+    inline GLuint getIBO() { return index_buffer; }
+    // 释放GL对象(之后可以再次Load~()), 用于显存驻留管理
+    void Release();
+    // 各缓冲区占用的显存字节数
+    size_t GetMemorySize() const;
     // Load~()方法 从文件加载Mesh(仅加载数据)
-    static void LoadMesh(const Byte* data, Mesh& mesh);
+    static void LoadMesh(const Byte* data, Mesh& mesh);  // MESH_HEADER或MESH_CODEC_HEADER
+    // 从未压缩的MeshFile数据加载, 用于工作线程解码后在渲染线程上传
+    static void LoadMeshData(const Byte* mesh_data, Mesh& mesh);
     static void LoadMesh(std::ifstream& in, Mesh& mesh);  // 读取下一个Mesh
     static void LoadMesh(const std::string& path, Mesh& mesh);
     static void LoadMesh(const char* path, Mesh& mesh);
     static void LoadMeshMultple(const std::string& path,
                                 std::vector<Mesh>& meshs);
     static void LoadMeshMultple(const char* path, std::vector<Mesh>& meshs);
-    // Pack~()方法 将Mesh打包为文件
+    // Pack~()方法 将Mesh打包为文件, 返回的数据使用MemoryTracker::Free释放
     static Byte* PackMesh(size_t* ret_length, const Mesh& mesh);
     static void PackMesh(const std::string& path, const Mesh& mesh);
-    // Gen~()方法 从外部文件格式打包为文件
+    // Gen~()方法 从外部文件格式打包为文件, 返回的数据使用MemoryTracker::Free释放
     static void GenMeshFile(const aiMesh* ptr, const std::string& save_path);
     static Byte* GenMeshFile(const aiMesh* ptr,
                              const std::string& name,
@@ -116,7 +127,54 @@ class Mesh {
 // Texture相关
 //
 
+// S3TC(EXT_texture_compression_s3tc / EXT_texture_sRGB)不在核心规范中, glad未生成
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
 constexpr size_t TextureInternalFormatSize(GLenum type);
+// 以format/type读写时单个像素的字节数(不支持打包类型), 未知格式返回0
+size_t TexturePixelSize(GLenum format, GLenum type);
+// 不可变纹理存储占用的字节数(depth为数组层数或3D纹理深度), 未知格式返回0
+size_t TextureStorageSize(GLenum internal_format,
+                          GLsizei levels,
+                          GLsizei width,
+                          GLsizei height,
+                          GLsizei depth,
+                          bool array);
+// 块压缩格式单个4x4块的字节数, 非块压缩格式返回0
+constexpr size_t TextureCompressedBlockSize(GLenum internal_format) {
+    switch (internal_format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+            return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_SIGNED_RG_RGTC2:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+        case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+            return 16;
+        default:
+            return 0;
+    }
+}
 constexpr size_t TypeSize(GLenum type);
 struct TextureMipData {
     // 纹理该Mipmap层级的长宽高
@@ -146,6 +204,80 @@ struct TextureFileN {
     TextureMipData mip[];
 };
 const size_t TEXTURE_HEADER = 0xF24241339FFF0002;
+// 读取纹理文件并准备上传: 文件头(TextureFileN及mip表)解压到内存, 像素数据直接
+// 解压到DefaultUploadRing(), 放不下时退回客户端内存.
+// Begin()与End()之间以Pixels(i)作为glTextureSubImage*的数据参数, 由GPU异步拷贝.
+// 只能在渲染线程使用
+class TextureStaging {
+    std::vector<Byte> head_data;
+    size_t head_size;
+    UploadAllocation pbo;
+    Byte* data;  // 像素数据大于上传缓冲区时使用的客户端内存
+    bool bound;
+
+   public:
+    // required_target不为GL_NONE时, 文件的target不符则抛出std::runtime_error
+    TextureStaging(const std::string& path, GLenum required_target = GL_NONE);
+    TextureStaging(const TextureStaging&) = delete;
+    TextureStaging& operator=(const TextureStaging&) = delete;
+    ~TextureStaging();
+
+    const TextureFileN& File() const {
+        return *(const TextureFileN*)head_data.data();
+    }
+    // 第level层mip的像素数据: 上传缓冲区内的偏移或客户端内存地址
+    const void* Pixels(GLsizei level) const;
+    // 绑定上传缓冲区, 解包对齐设为1(RGB8等格式的行不按4字节对齐)
+    void Begin();
+    // 解绑并在上传缓冲区上插入栅栏, 恢复解包对齐
+    void End();
+};
+struct ImageF;  // bl_image.hpp
+// mipmap生成滤波器
+enum struct MipFilter : int {
+    BOX = 0,    // 盒式滤波(按覆盖面积加权)
+    KAISER = 1  // Kaiser窗sinc, 更锐利
+};
+// 块压缩格式
+enum struct TextureCompression : int {
+    NONE = 0,  // 不压缩
+    BC1 = 1,   // RGB, 4bpp
+    BC3 = 2,   // RGBA, 8bpp
+    BC4 = 3,   // R, 4bpp
+    BC5 = 4,   // RG, 8bpp (法线贴图)
+    BC7 = 5,   // RGBA高质量, 8bpp
+    AUTO = 6   // 按通道数选择: 1->BC4, 2->BC5, 3->BC1, 4->BC3
+};
+// GenTextureFile()的烘焙参数
+// HDR纹理的打包格式
+enum struct TextureHDRFormat : int {
+    NONE = 0,        // 8位格式
+    RGB9E5 = 1,      // GL_RGB9_E5, 共享指数, 4字节, 无alpha
+    R11G11B10F = 2,  // GL_R11F_G11F_B10F, 无符号小浮点, 4字节, 无alpha
+    HALF = 3         // GL_R16F~GL_RGBA16F, 每通道2字节
+};
+// 纹理用途, 决定颜色空间, 尺寸上限与预处理
+enum struct TextureUsage : int {
+    COLOR = 0,   // 颜色贴图
+    NORMAL = 1,  // 法线贴图: 线性, 每层mip重新归一化
+    MASK = 2,    // 遮蔽/粗糙度/金属度等线性数据
+    UI = 3       // 界面图像
+};
+// 各用途的最大边长(按TextureUsage索引), 0表示不限; TextureCookArg::max_size为-1时使用
+const GLsizei texture_usage_max_size[4] = {2048, 2048, 1024, 0};
+struct TextureCookArg {
+    MipFilter mip_filter = MipFilter::BOX;
+    TextureCompression compression = TextureCompression::NONE;
+    GLsizei mip_levels = 0;  // 生成的mipmap层数, 0表示完整链
+    // RGB(A)颜色/界面图像视为sRGB: 在线性空间滤波, 使用SRGB内部格式
+    bool srgb = true;
+    TextureUsage usage = TextureUsage::COLOR;
+    // 最大边长, 超过时以Kaiser滤波等比例缩小; 0表示不限,
+    // -1表示取该用途在texture_usage_max_size中的上限
+    GLsizei max_size = 0;
+    // HDR源图像(stbi_is_hdr, 如.hdr)的打包格式, 为NONE时使用HALF; 不支持块压缩
+    TextureHDRFormat hdr_format = TextureHDRFormat::RGB9E5;
+};
 const GLsizei default_texture_samples = 4;
 const GLboolean default_texture_fixedsamplelocation = GL_FALSE;
 class Texture {
@@ -154,10 +286,19 @@ class Texture {
     GLenum target;
     GLsizei width, height, depth;
 
+    friend class Impostor;
+    friend class TextureStreamer;
+    friend class BCnComputeEncoder;
+
    public:
     // 构造函数，不做任何事，使用LoadTexture()函数加载
     Texture();
     ~Texture();
+    inline GLuint GetID() { return texture_id; }
+    // 释放GL纹理对象(之后可以再次LoadTexture()), 用于显存驻留管理
+    void Release();
+    // 所有mipmap层级占用的显存字节数
+    size_t GetMemorySize() const;
 
     static void LoadTexture(
         const std::string& path,
@@ -176,6 +317,7 @@ class Texture {
                             GLsizei level,  // 打包的纹理mipmap层级数
                             GLenum format,  // 输出的纹元格式
                             GLenum type);   // 纹元数据类型
+    // 返回的数据使用MemoryTracker::Free释放
     static Byte* PackTexture(size_t* ret_length,
                              Texture& tex,
                              GLsizei level,
@@ -186,6 +328,34 @@ class Texture {
                             GLsizei level,
                             GLenum format,
                             GLenum type);
+    // 由线性RGBA mipmap链生成压缩后的纹理文件数据(含文件头代码), layers[切片][层级]
+    // 各切片尺寸与层数必须相同, 同一层级的所有切片连续存放
+    // hdr不为NONE时以该HDR格式输出, 忽略arg中的srgb与compression
+    // target为GL_NONE时按切片数选择GL_TEXTURE_2D或GL_TEXTURE_2D_ARRAY,
+    // 也可以是GL_TEXTURE_CUBE_MAP(6个切片)或GL_TEXTURE_CUBE_MAP_ARRAY(6的倍数)
+    // 返回的数据使用MemoryTracker::Free释放
+    static Byte* GenTextureData(size_t* ret_length,
+                                const std::vector<std::vector<ImageF>>& layers,
+                                int channels,
+                                const TextureCookArg& arg,
+                                TextureHDRFormat hdr = TextureHDRFormat::NONE,
+                                GLenum target = GL_NONE);
+    // 由多张尺寸相同的图像组装纹理数组/立方体贴图, 输出到save_path
+    // 立方体贴图的面按+X, -X, +Y, -Y, +Z, -Z的顺序给出, 立方体贴图数组依次排列
+    static void GenTextureArrayFile(const std::vector<std::string>& paths,
+                                    const std::string& save_path,
+                                    GLenum target,
+                                    const TextureCookArg& arg = {});
+    // 把单独的遮蔽/粗糙度/金属度灰度图打包为一张RGB纹理(R=O, G=R, B=M)
+    // 路径为空的通道取默认值(O=1, R=1, M=0); 尺寸不同时缩小到各图中最小的宽和高
+    // 按MASK用途处理(线性颜色空间; max_size为-1时使用MASK的尺寸上限)
+    static void GenORMTextureFile(const std::string& occlusion,
+                                  const std::string& roughness,
+                                  const std::string& metalness,
+                                  const std::string& save_path,
+                                  const TextureCookArg& arg = {});
+    static void GenTextureFile(const std::string& path,
+                               const TextureCookArg& arg);
     static void GenTextureFile(const std::string& path);
     static void GenTextureFile(const char* path);
 };
@@ -0,0 +1,113 @@
+#include "bl_texture_array.hpp"
+
+namespace Boundless {
+MaterialTextureArrays::MaterialTextureArrays(uint32 initial_layers)
+    : initial_capacity(std::max<uint32>(initial_layers, 1)) {
+    GLint layers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &layers);
+    max_layers = static_cast<uint32>(std::max(layers, 1));
+}
+MaterialTextureArrays::~MaterialTextureArrays() {
+    for (TextureArray& arr : arrays)
+        MemoryTracker::DeleteTextures(1, &arr.texture_id);
+}
+bool MaterialTextureArrays::Find(const std::string& path,
+                                 MaterialTextureRef* ref) const {
+    auto it = loaded.find(path);
+    if (it == loaded.end())
+        return false;
+    *ref = it->second;
+    return true;
+}
+uint32 MaterialTextureArrays::FindArray(const TextureFileN& tf) {
+    for (uint32 i = 0; i < arrays.size(); i++) {
+        const TextureArray& arr = arrays[i];
+        if (arr.internal_format == tf.internal_format &&
+            arr.format == tf.format && arr.type == tf.type &&
+            arr.width == tf.mip[0].width && arr.height == tf.mip[0].height &&
+            arr.levels == tf.mipLevels &&
+            arr.enable_swizzle == tf.enable_swizzle &&
+            (tf.enable_swizzle == GL_FALSE ||
+             std::equal(arr.swizzle, arr.swizzle + 4, tf.swizzle)) &&
+            arr.count < max_layers) {
+            return i;
+        }
+    }
+    TextureArray arr;
+    arr.texture_id = 0;
+    arr.internal_format = tf.internal_format;
+    arr.format = tf.format;
+    arr.type = tf.type;
+    arr.width = tf.mip[0].width;
+    arr.height = tf.mip[0].height;
+    arr.levels = tf.mipLevels;
+    arr.enable_swizzle = tf.enable_swizzle;
+    std::copy(tf.swizzle, tf.swizzle + 4, arr.swizzle);
+    arr.count = 0;
+    arr.capacity = 0;
+    arrays.push_back(arr);
+    return static_cast<uint32>(arrays.size() - 1);
+}
+void MaterialTextureArrays::Grow(TextureArray& arr) {
+    uint32 capacity = arr.capacity == 0
+                          ? std::min(initial_capacity, max_layers)
+                          : std::min(arr.capacity * 2, max_layers);
+    GLuint id;
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &id);
+    MemoryTracker::TextureStorage3D(MemoryTag::Texture, id, arr.levels,
+                                    arr.internal_format, arr.width, arr.height,
+                                    capacity);
+    glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    if (arr.enable_swizzle == GL_TRUE) {
+        glTextureParameteriv(id, GL_TEXTURE_SWIZZLE_RGBA, (GLint*)arr.swizzle);
+    }
+    if (arr.count > 0) {
+        // 逐层级搬移已有的层, 不经过CPU
+        for (GLsizei i = 0; i < arr.levels; i++) {
+            glCopyImageSubData(arr.texture_id, GL_TEXTURE_2D_ARRAY, i, 0, 0, 0,
+                               id, GL_TEXTURE_2D_ARRAY, i, 0, 0, 0,
+                               std::max(1, arr.width >> i),
+                               std::max(1, arr.height >> i), arr.count);
+        }
+    }
+    if (arr.texture_id != 0) {
+        MemoryTracker::DeleteTextures(1, &arr.texture_id);
+    }
+    arr.texture_id = id;
+    arr.capacity = capacity;
+}
+MaterialTextureRef MaterialTextureArrays::Add(const std::string& path) {
+    auto it = loaded.find(path);
+    if (it != loaded.end()) {
+        return it->second;
+    }
+    TextureStaging staging(path, GL_TEXTURE_2D);
+    const TextureFileN& tf = staging.File();
+    uint32 index = FindArray(tf);
+    TextureArray& arr = arrays[index];
+    if (arr.count == arr.capacity) {
+        Grow(arr);
+    }
+    uint32 layer = arr.count++;
+    const bool compressed = TextureCompressedBlockSize(tf.internal_format) > 0;
+    staging.Begin();
+    for (GLsizei i = 0; i < tf.mipLevels; i++) {
+        if (compressed) {
+            glCompressedTextureSubImage3D(
+                arr.texture_id, i, 0, 0, layer, tf.mip[i].width,
+                tf.mip[i].height, 1, tf.internal_format,
+                static_cast<GLsizei>(tf.mip[i].range.length),
+                staging.Pixels(i));
+        } else {
+            glTextureSubImage3D(arr.texture_id, i, 0, 0, layer,
+                                tf.mip[i].width, tf.mip[i].height, 1,
+                                tf.format, tf.type, staging.Pixels(i));
+        }
+    }
+    staging.End();
+    MaterialTextureRef ref{index, layer};
+    loaded.emplace(path, ref);
+    return ref;
+}
+}  // namespace Boundless
@@ -0,0 +1,55 @@
+#ifndef _BOUNDLESS_TEXTURE_ARRAY_HPP_FILE_
+#define _BOUNDLESS_TEXTURE_ARRAY_HPP_FILE_
+#include "bl_resource.hpp"
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 材质纹理数组
+//
+// 把格式相同(内部格式, 尺寸, mip层数, 乱序)的GL_TEXTURE_2D纹理文件装入同一个
+// GL_TEXTURE_2D_ARRAY, 绘制时向着色器传入层号, 不必为每个材质重新绑定纹理.
+// 数组容量不足时以两倍容量重新分配, glCopyImageSubData搬移已有的层;
+// 达到GL_MAX_ARRAY_TEXTURE_LAYERS后为同一格式另建数组.
+// 像素数据经DefaultUploadRing()上传, 只能在渲染线程使用.
+//
+struct MaterialTextureRef {
+    uint32 array;  // 数组序号, 用于GetTexture()/Bind()
+    uint32 layer;  // 数组内的层号
+};
+
+class MaterialTextureArrays {
+    struct TextureArray {
+        GLuint texture_id;
+        GLenum internal_format, format, type;
+        GLsizei width, height, levels;
+        GLboolean enable_swizzle;
+        GLenum swizzle[4];
+        uint32 count, capacity;
+    };
+    std::vector<TextureArray> arrays;
+    std::unordered_map<std::string, MaterialTextureRef> loaded;
+    uint32 initial_capacity;
+    uint32 max_layers;
+
+    uint32 FindArray(const TextureFileN& tf);
+    void Grow(TextureArray& arr);
+
+   public:
+    MaterialTextureArrays(uint32 initial_layers = 8);
+    MaterialTextureArrays(const MaterialTextureArrays&) = delete;
+    MaterialTextureArrays& operator=(const MaterialTextureArrays&) = delete;
+    ~MaterialTextureArrays();
+
+    // 加载纹理文件到格式匹配的数组中, 同一路径只加载一次
+    MaterialTextureRef Add(const std::string& path);
+    // 查找已加载的纹理, 不存在时返回false
+    bool Find(const std::string& path, MaterialTextureRef* ref) const;
+    GLuint GetTexture(uint32 array) const { return arrays[array].texture_id; }
+    void Bind(uint32 array, GLuint unit) const {
+        glBindTextureUnit(unit, arrays[array].texture_id);
+    }
+    uint32 GetArrayCount() const { return static_cast<uint32>(arrays.size()); }
+    uint32 GetLayerCount(uint32 array) const { return arrays[array].count; }
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_TEXTURE_ARRAY_HPP_FILE_
@@ -0,0 +1,301 @@
+#include "bl_texture_stream.hpp"
+
+namespace Boundless {
+StreamedTexture::StreamedTexture(const std::string& file_path)
+    : path(file_path),
+      data(nullptr),
+      loading(false),
+      failed(false),
+      closing(false),
+      failures(0),
+      retry_frame(0),
+      internal_format(GL_NONE),
+      format(GL_NONE),
+      type(GL_NONE),
+      allocated_base(0),
+      resident_base(0),
+      demand(0.0f),
+      wanted(0),
+      low_demand_frames(0),
+      satisfied_frames(0) {}
+StreamedTexture::~StreamedTexture() {
+    MemoryTracker::Free(data);
+}
+
+TextureStreamer::TextureStreamer(const TextureStreamSettings& arg)
+    : pending_loads(0), resident_bytes(0), frame(0), settings(arg) {}
+TextureStreamer::~TextureStreamer() {
+    // 等待后台加载任务结束, 它们持有StreamedTexture指针
+    while (pending_loads.load() > 0) {
+        std::this_thread::yield();
+    }
+    std::pair<StreamedTexture*, Byte*> item;
+    while (loaded_queue.try_pop(item)) {
+        MemoryTracker::Free(item.second);
+    }
+}
+StreamedTexture* TextureStreamer::Open(const std::string& path) {
+    textures.push_back(std::make_unique<StreamedTexture>(path));
+    StreamedTexture* st = textures.back().get();
+    RequestLoad(st);
+    return st;
+}
+void TextureStreamer::Close(StreamedTexture* st) {
+    auto it = std::find_if(
+        textures.begin(), textures.end(),
+        [st](const std::unique_ptr<StreamedTexture>& p) { return p.get() == st; });
+    if (it == textures.end())
+        return;
+    if (st->IsReady()) {
+        GLsizei levels = static_cast<GLsizei>(st->mips.size());
+        for (GLsizei i = st->allocated_base; i < levels; i++)
+            resident_bytes -= LevelBytes(st, i);
+    }
+    st->texture.Release();
+    MemoryTracker::Free(st->data);
+    st->data = nullptr;
+    if (st->loading) {
+        // 后台任务仍持有指针, 数据到达后再销毁
+        st->closing = true;
+        closing.push_back(std::move(*it));
+    }
+    textures.erase(it);
+}
+void TextureStreamer::RequestLoad(StreamedTexture* st) {
+    st->loading = true;
+    pending_loads++;
+    DefaultThreadPool().submit([this, st]() {
+        Byte* result = nullptr;
+        try {
+            std::ifstream fin(st->path, std::ios::in | std::ios::binary);
+            if (fin.is_open()) {
+                fin.seekg(0, std::ios::end);
+                size_t length = static_cast<size_t>(fin.tellg());
+                fin.seekg(0, std::ios::beg);
+                Byte* file = (Byte*)MemoryTracker::Allocate(
+                    length, MemoryTag::Streaming);
+                if (file && length > sizeof(uint64)) {
+                    fin.read((char*)file, length);
+                    if (*(uint64*)file == TEXTURE_HEADER) {
+                        try {
+                            result = UncompressData(file + sizeof(uint64),
+                                                    &length);
+                        } catch (...) {
+                            result = nullptr;
+                        }
+                    }
+                }
+                MemoryTracker::Free(file);
+            }
+        } catch (...) {
+            result = nullptr;
+        }
+        loaded_queue.push({st, result});
+        pending_loads--;
+    });
+}
+size_t TextureStreamer::LevelBytes(const StreamedTexture* st,
+                                   GLsizei level) const {
+    return st->mips[level].range.length;
+}
+void TextureStreamer::LoadFailed(StreamedTexture* st, const char* reason) {
+    st->failures++;
+    if (st->failures > settings.max_retries) {
+        st->failed = true;
+        WARNING("TextureStreamer", reason, st->path, ", 放弃加载");
+        return;
+    }
+    // 退避: retry_frames, 2*retry_frames, 4*retry_frames...
+    st->retry_frame =
+        frame + (static_cast<uint64>(settings.retry_frames) << (st->failures - 1));
+    WARNING("TextureStreamer", reason, st->path);
+}
+void TextureStreamer::InitStorage(StreamedTexture* st) {
+    const TextureFileN& tf = *(TextureFileN*)st->data;
+    if (tf.target != GL_TEXTURE_2D || tf.mipLevels < 1) {
+        WARNING("TextureStreamer", "只支持流式加载GL_TEXTURE_2D:", st->path);
+        MemoryTracker::Free(st->data);
+        st->data = nullptr;
+        st->failed = true;  // 重新读取也不会成功
+        return;
+    }
+    st->internal_format = tf.internal_format;
+    st->format = tf.format;
+    st->type = tf.type;
+    st->mips.assign(tf.mip, tf.mip + tf.mipLevels);
+    GLsizei levels = tf.mipLevels;
+    Texture& tex = st->texture;
+    glCreateTextures(GL_TEXTURE_2D, 1, &tex.texture_id);
+    tex.target = GL_TEXTURE_2D;
+    tex.width = st->mips[0].width;
+    tex.height = st->mips[0].height;
+    tex.depth = 0;
+    MemoryTracker::TextureStorage2D(MemoryTag::Texture, tex.texture_id, levels,
+                                    st->internal_format, tex.width, tex.height);
+    if (tf.enable_swizzle == GL_TRUE) {
+        glTextureParameteriv(tex.texture_id, GL_TEXTURE_SWIZZLE_RGBA,
+                             (GLint*)tf.swizzle);
+    }
+    glTextureParameteri(tex.texture_id, GL_TEXTURE_MIN_FILTER,
+                        GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(tex.texture_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    for (GLsizei i = 0; i < levels; i++)
+        resident_bytes += LevelBytes(st, i);
+    st->allocated_base = 0;
+    st->resident_base = levels;
+    // 尾部小mip同步上传, 保证纹理立即可用
+    for (GLsizei i = levels - 1; i >= 0; i--) {
+        if (i < levels - 1 && std::max(st->mips[i].width, st->mips[i].height) >
+                                  settings.resident_size)
+            break;
+        UploadLevel(st, i);
+    }
+    st->wanted = st->resident_base;
+}
+size_t TextureStreamer::UploadLevel(StreamedTexture* st, GLsizei level) {
+    const TextureMipData& mip = st->mips[level];
+    const Byte* src = st->data + mip.range.start;
+    GLuint id = st->texture.texture_id;
+    GLint gl_level = level - st->allocated_base;
+    if (TextureCompressedBlockSize(st->internal_format) > 0) {
+        glCompressedTextureSubImage2D(id, gl_level, 0, 0, mip.width, mip.height,
+                                      st->internal_format,
+                                      static_cast<GLsizei>(mip.range.length),
+                                      src);
+    } else {
+        glTextureSubImage2D(id, gl_level, 0, 0, mip.width, mip.height,
+                            st->format, st->type, src);
+    }
+    st->resident_base = level;
+    glTextureParameteri(id, GL_TEXTURE_BASE_LEVEL, gl_level);
+    return mip.range.length;
+}
+void TextureStreamer::Reallocate(StreamedTexture* st, GLsizei new_base) {
+    Texture& tex = st->texture;
+    GLsizei levels = static_cast<GLsizei>(st->mips.size());
+    GLuint old_id = tex.texture_id, new_id;
+    glCreateTextures(GL_TEXTURE_2D, 1, &new_id);
+    MemoryTracker::TextureStorage2D(MemoryTag::Texture, new_id,
+                                    levels - new_base, st->internal_format,
+                                    st->mips[new_base].width,
+                                    st->mips[new_base].height);
+    // 保留使用者设置的采样参数
+    const GLenum params[4] = {GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER,
+                              GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T};
+    for (GLenum p : params) {
+        GLint v;
+        glGetTextureParameteriv(old_id, p, &v);
+        glTextureParameteri(new_id, p, v);
+    }
+    GLint swizzle[4];
+    glGetTextureParameteriv(old_id, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    glTextureParameteriv(new_id, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    GLsizei first = std::max(st->resident_base, new_base);
+    for (GLsizei i = first; i < levels; i++) {
+        glCopyImageSubData(old_id, GL_TEXTURE_2D, i - st->allocated_base, 0, 0,
+                           0, new_id, GL_TEXTURE_2D, i - new_base, 0, 0, 0,
+                           st->mips[i].width, st->mips[i].height, 1);
+    }
+    MemoryTracker::DeleteTextures(1, &old_id);
+    for (GLsizei i = st->allocated_base; i < new_base; i++)
+        resident_bytes -= LevelBytes(st, i);
+    for (GLsizei i = new_base; i < st->allocated_base; i++)
+        resident_bytes += LevelBytes(st, i);
+    tex.texture_id = new_id;
+    tex.width = st->mips[new_base].width;
+    tex.height = st->mips[new_base].height;
+    st->allocated_base = new_base;
+    st->resident_base = first;
+    glTextureParameteri(new_id, GL_TEXTURE_BASE_LEVEL, first - new_base);
+}
+void TextureStreamer::Update() {
+    frame++;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    std::pair<StreamedTexture*, Byte*> item;
+    while (loaded_queue.try_pop(item)) {
+        StreamedTexture* st = item.first;
+        st->loading = false;
+        if (st->closing) {
+            MemoryTracker::Free(item.second);
+            std::erase_if(closing, [st](const std::unique_ptr<StreamedTexture>& p) {
+                return p.get() == st;
+            });
+            continue;
+        }
+        if (!item.second) {
+            LoadFailed(st, "纹理加载失败:");
+            continue;
+        }
+        st->failures = 0;
+        MemoryTracker::Free(st->data);
+        st->data = item.second;
+        if (!st->IsReady())
+            InitStorage(st);
+    }
+    size_t budget = settings.upload_budget;
+    bool uploaded = false;
+    for (std::unique_ptr<StreamedTexture>& ptr : textures) {
+        StreamedTexture* st = ptr.get();
+        float demand = st->demand;
+        st->demand = 0.0f;
+        if (!st->IsReady()) {
+            if (!st->data && CanRequest(st))
+                RequestLoad(st);
+            continue;
+        }
+        GLsizei levels = static_cast<GLsizei>(st->mips.size());
+        // 需求层级: 纹理边长与屏幕像素之比的log2, 无请求时只需最粗层级
+        GLsizei want = levels - 1;
+        if (demand > 0.0f) {
+            float ratio =
+                std::max(st->mips[0].width, st->mips[0].height) / demand;
+            want = ratio <= 1.0f ? 0
+                                 : std::min<GLsizei>(
+                                       static_cast<GLsizei>(std::log2(ratio)),
+                                       levels - 1);
+        }
+        st->wanted = want;
+        if (want < st->resident_base) {
+            st->low_demand_frames = 0;
+            st->satisfied_frames = 0;
+            if (!st->data) {
+                if (CanRequest(st))
+                    RequestLoad(st);
+                continue;
+            }
+            if (want < st->allocated_base)
+                Reallocate(st, 0);
+            // 由粗到细逐层上传, 预算用尽后留到下一帧
+            while (st->resident_base > want) {
+                size_t bytes = LevelBytes(st, st->resident_base - 1);
+                if (uploaded && bytes > budget)
+                    break;
+                UploadLevel(st, st->resident_base - 1);
+                budget -= std::min(bytes, budget);
+                uploaded = true;
+            }
+            continue;
+        }
+        st->satisfied_frames++;
+        st->low_demand_frames =
+            want > st->resident_base ? st->low_demand_frames + 1 : 0;
+        if (st->low_demand_frames >= settings.evict_frames) {
+            // 尾部小mip不逐出
+            GLsizei tail = levels - 1;
+            while (tail > 0 && std::max(st->mips[tail - 1].width,
+                                        st->mips[tail - 1].height) <=
+                                   settings.resident_size)
+                tail--;
+            GLsizei keep = std::min(want, tail);
+            if (keep > st->allocated_base)
+                Reallocate(st, keep);
+            st->low_demand_frames = 0;
+        }
+        if (st->data && st->satisfied_frames >= settings.release_frames) {
+            MemoryTracker::Free(st->data);
+            st->data = nullptr;
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+}  // namespace Boundless
@@ -0,0 +1,106 @@
+#ifndef _BOUNDLESS_TEXTURE_STREAM_HPP_FILE_
+#define _BOUNDLESS_TEXTURE_STREAM_HPP_FILE_
+#include <atomic>
+#include <memory>
+#include "bl_resource.hpp"
+#include "bl_thread.hpp"
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 纹理流式加载
+//
+// 文件在后台线程读取并解压, 到达后在渲染线程分配完整的mip存储,
+// 先同步上传小于resident_size的尾部mip, 更精细的层级按屏幕空间需求逐帧上传.
+// GL_TEXTURE_BASE_LEVEL始终限制在已上传的最精细层级.
+// 需求长期低于已驻留层级时, 以更小的存储重新分配纹理(glCopyImageSubData保留
+// 已有层级), 释放顶层mip的显存; 需求回升时重新读取文件.
+// 读取失败后按retry_frames翻倍退避重试, 连续失败max_retries次(或格式不支持)后
+// 进入失败状态, 不再请求; 已上传的层级仍可使用.
+// 目前只支持GL_TEXTURE_2D
+//
+struct TextureStreamSettings {
+    size_t upload_budget = 16ULL << 20;  // 每帧上传的最大字节数(至少上传一层)
+    GLsizei resident_size = 64;  // 边长不超过该值的mip总是常驻
+    uint32 evict_frames = 180;   // 需求持续低于驻留层级多少帧后逐出顶层mip
+    uint32 release_frames = 300;  // 需求全部满足多少帧后释放解压数据
+    uint32 retry_frames = 30;  // 首次重试的等待帧数, 之后每次失败翻倍
+    uint32 max_retries = 4;    // 连续失败超过该次数后放弃加载
+};
+
+class StreamedTexture {
+    friend class TextureStreamer;
+
+    std::string path;
+    Texture texture;
+    Byte* data;  // 解压后的纹理文件, nullptr表示不在内存中
+    bool loading;
+    bool failed;       // 放弃加载, 不再发出请求
+    bool closing;      // 已关闭, 等待后台加载返回后销毁
+    uint32 failures;   // 连续失败次数
+    uint64 retry_frame;  // 早于该帧不重试
+    GLenum internal_format, format, type;
+    std::vector<TextureMipData> mips;  // 完整mip表, 数据到达前为空
+    GLsizei allocated_base;  // GL存储第0层对应的文件层级
+    GLsizei resident_base;   // 已上传的最精细层级
+    float demand;            // 本帧请求的最大屏幕尺寸(像素)
+    GLsizei wanted;          // 上一帧计算出的需求层级
+    uint64 low_demand_frames, satisfied_frames;
+
+   public:
+    StreamedTexture(const std::string& file_path);
+    StreamedTexture(const StreamedTexture&) = delete;
+    StreamedTexture& operator=(const StreamedTexture&) = delete;
+    ~StreamedTexture();
+
+    // 纹理在屏幕上覆盖的像素边长, 同一帧内多次请求取最大值
+    void Request(float screen_pixels) { demand = std::max(demand, screen_pixels); }
+    // 包围球投影后的像素直径, projection_scale = 视口高度 / (2*tan(fov_y/2))
+    static float ProjectedSize(float radius,
+                               float distance,
+                               float projection_scale) {
+        return 2.0f * radius * projection_scale / std::max(distance, 1e-4f);
+    }
+    bool IsReady() const { return !mips.empty(); }
+    bool IsFailed() const { return failed; }
+    Texture& GetTexture() { return texture; }
+    GLsizei GetLevelCount() const { return static_cast<GLsizei>(mips.size()); }
+    GLsizei GetResidentLevel() const { return resident_base; }
+    GLsizei GetWantedLevel() const { return wanted; }
+};
+
+class TextureStreamer {
+    std::vector<std::unique_ptr<StreamedTexture>> textures;
+    threadsafe_queue<std::pair<StreamedTexture*, Byte*>> loaded_queue;
+    std::vector<std::unique_ptr<StreamedTexture>> closing;  // 等待后台加载返回
+    std::atomic<uint32> pending_loads;
+    size_t resident_bytes;
+    uint64 frame;
+
+    void RequestLoad(StreamedTexture* st);
+    bool CanRequest(const StreamedTexture* st) const {
+        return !st->loading && !st->failed && frame >= st->retry_frame;
+    }
+    void LoadFailed(StreamedTexture* st, const char* reason);
+    void InitStorage(StreamedTexture* st);
+    void Reallocate(StreamedTexture* st, GLsizei new_base);
+    size_t UploadLevel(StreamedTexture* st, GLsizei level);
+    size_t LevelBytes(const StreamedTexture* st, GLsizei level) const;
+
+   public:
+    TextureStreamSettings settings;
+
+    TextureStreamer(const TextureStreamSettings& arg = {});
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+    ~TextureStreamer();
+
+    // 打开纹理文件并开始后台加载, 返回的对象由TextureStreamer持有
+    StreamedTexture* Open(const std::string& path);
+    // 删除纹理的GL存储并从驻留统计中扣除, st在此之后失效
+    void Close(StreamedTexture* st);
+    // 每帧在渲染线程调用: 处理到达的数据, 按需求上传/逐出mip
+    void Update();
+    size_t GetResidentBytes() const { return resident_bytes; }
+};
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_TEXTURE_STREAM_HPP_FILE_
@@ -10,24 +10,28 @@
 #include <stdexcept>
 #include <thread>
 #include <future>
+#include <memory>
+#include <ostream>
+#include <vector>
 
 namespace Boundless {
 class timer {
    private:
-    using namespace std::chrono;
-    time_point<high_resolution_clock> start, end;
-    duration<uint64_t, std::nano> delta;
+    std::chrono::time_point<std::chrono::high_resolution_clock> start_point,
+        end_point;
+    std::chrono::duration<uint64_t, std::nano> delta;
 
    public:
     timer() {}
     ~timer() {}
-    void begin() { start = high_resolution_clock::now(); }
+    void begin() { start_point = std::chrono::high_resolution_clock::now(); }
     void end() {
-        end = high_resolution_clock::now();
-        dalta = end - start;
+        end_point = std::chrono::high_resolution_clock::now();
+        delta = end_point - start_point;
     }
+    uint64_t nanoseconds() const { return delta.count(); }
     friend std::ostream& operator<<(std::ostream& s, timer& c) {
-        s << c.delta;
+        s << c.delta.count() << "ns";
         return s;
     }
 };
@@ -112,6 +116,8 @@ class thread_pool {
     }
     ~thread_pool() {
         shut_down = true;
+        // 唤醒阻塞在wait_and_pop中的工作线程
+        work_queue.muti_push([] {}, static_cast<unsigned int>(threads.size()));
         for (std::thread& th : threads) {
             if (th.joinable()) {
                 th.join();
@@ -120,6 +126,7 @@ class thread_pool {
     }
     void shutdown() {
         shut_down = true;
+        work_queue.muti_push([] {}, static_cast<unsigned int>(threads.size()));
         for (std::thread& th : threads) {
             if (th.joinable()) {
                 th.join();
@@ -145,10 +152,15 @@ class thread_pool {
         auto task_ptr = std::make_shared<std::packaged_task<decltype(f(args...))()>>(func);
         std::function<void()> warpper_func = [task_ptr]()
         { (*task_ptr)(); };
-        work_queue.muti_push(warpper_func);
+        work_queue.muti_push(warpper_func, 1);
         return task_ptr->get_future();
     }
 };
 
+// 引擎共享的后台线程池(资源加载, 解码等), 首次调用时创建
+inline thread_pool& DefaultThreadPool() {
+    static thread_pool pool;
+    return pool;
+}
 }  // namespace Boundless
 #endif  //!_BL_THREAD_HPP_FILE_
\ No newline at end of file
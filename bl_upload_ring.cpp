@@ -0,0 +1,84 @@
+#include "bl_upload_ring.hpp"
+
+namespace Boundless {
+UploadRing::UploadRing(size_t size)
+    : capacity(size), write_pos(0), fenced_pos(0), retired_pos(0) {
+    const GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &buffer);
+    MemoryTracker::BufferStorage(MemoryTag::Render, buffer, capacity, nullptr,
+                                 flags);
+    mapped = (Byte*)glMapNamedBufferRange(buffer, 0, capacity, flags);
+    if (mapped == nullptr) {
+        MemoryTracker::DeleteBuffers(1, &buffer);
+        throw std::runtime_error("无法映射上传缓冲区");
+    }
+}
+UploadRing::~UploadRing() {
+    for (std::pair<GLsync, uint64>& f : fences)
+        glDeleteSync(f.first);
+    glUnmapNamedBuffer(buffer);
+    MemoryTracker::DeleteBuffers(1, &buffer);
+}
+void UploadRing::WaitOldest() {
+    GLsync sync = fences.front().first;
+    // 首次等待时刷新命令队列, 保证栅栏能够到达GPU
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true) {
+        GLenum res = glClientWaitSync(sync, flags, 1000000);  // 1ms
+        if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED)
+            break;
+        if (res == GL_WAIT_FAILED) {
+            WARNING("UploadRing", "glClientWaitSync失败");
+            break;
+        }
+        flags = 0;
+    }
+    retired_pos = fences.front().second;
+    glDeleteSync(sync);
+    fences.pop_front();
+}
+void UploadRing::Retire() {
+    while (!fences.empty()) {
+        GLenum res = glClientWaitSync(fences.front().first, 0, 0);
+        if (res != GL_ALREADY_SIGNALED && res != GL_CONDITION_SATISFIED)
+            break;
+        retired_pos = fences.front().second;
+        glDeleteSync(fences.front().first);
+        fences.pop_front();
+    }
+    if (fences.empty() && fenced_pos == write_pos)
+        retired_pos = write_pos;
+}
+void UploadRing::Fence() {
+    if (fenced_pos == write_pos)
+        return;
+    fences.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), write_pos});
+    fenced_pos = write_pos;
+}
+UploadAllocation UploadRing::Allocate(size_t size, size_t alignment) {
+    if (size > capacity) {
+        return {nullptr, 0};
+    }
+    Retire();
+    uint64 start = (write_pos + alignment - 1) / alignment * alignment;
+    // 不跨越缓冲区末尾, 剩余部分跳过
+    if (start % capacity + size > capacity)
+        start = (start / capacity + 1) * capacity;
+    while (start + size - retired_pos > capacity) {
+        if (fences.empty()) {
+            if (fenced_pos == write_pos) {
+                // 已全部回收, 跳过的末尾部分也不再占用
+                retired_pos = start;
+                break;
+            }
+            // 需要的空间还在当前批次中: 先提交它
+            Fence();
+        }
+        WaitOldest();
+    }
+    write_pos = start + size;
+    size_t offset = static_cast<size_t>(start % capacity);
+    return {mapped + offset, offset};
+}
+}  // namespace Boundless
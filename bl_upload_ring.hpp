@@ -0,0 +1,60 @@
+#ifndef _BOUNDLESS_UPLOAD_RING_HPP_FILE_
+#define _BOUNDLESS_UPLOAD_RING_HPP_FILE_
+#include <deque>
+#include "boundless_base.hpp"
+namespace Boundless {
+///////////////////////////////////////////////
+// 像素上传环形缓冲区
+//
+// 持久映射(GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT)的GL_PIXEL_UNPACK_BUFFER.
+// 调用者把解压/解码结果直接写入Allocate()返回的指针, 再以偏移量作为
+// glTextureSubImage*的数据参数, 驱动不必在调用中同步拷贝客户端内存.
+// 每批上传后调用Fence()插入栅栏, 栅栏通过后其之前分配的空间才会被复用;
+// 空间不足时等待最早的栅栏. 只能在渲染线程使用.
+//
+const size_t default_upload_ring_size = 64ULL << 20;
+
+struct UploadAllocation {
+    Byte* pointer;  // 映射的地址, nullptr表示请求大于整个缓冲区
+    size_t offset;  // 缓冲区内偏移, 绑定后作为像素数据"指针"使用
+};
+
+class UploadRing {
+    GLuint buffer;
+    Byte* mapped;
+    size_t capacity;
+    // 以单调增长的虚拟位置记录: 虚拟位置 % capacity 为缓冲区内偏移
+    uint64 write_pos;    // 下一次分配的起点
+    uint64 fenced_pos;   // 最近一个栅栏覆盖到的位置
+    uint64 retired_pos;  // 此前的空间GPU已使用完毕
+    std::deque<std::pair<GLsync, uint64>> fences;
+
+    void WaitOldest();
+
+   public:
+    UploadRing(size_t size = default_upload_ring_size);
+    UploadRing(const UploadRing&) = delete;
+    UploadRing& operator=(const UploadRing&) = delete;
+    ~UploadRing();
+
+    // 分配size字节(起点按alignment对齐), 必要时等待GPU释放空间
+    UploadAllocation Allocate(size_t size, size_t alignment = 16);
+    // 为之前的分配插入栅栏, 在发出使用这些数据的GL命令后调用
+    void Fence();
+    // 回收已经通过的栅栏, 不等待
+    void Retire();
+    // 绑定/解绑到GL_PIXEL_UNPACK_BUFFER
+    void Bind() const { glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer); }
+    static void Unbind() { glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); }
+    GLuint GetBuffer() const { return buffer; }
+    size_t GetCapacity() const { return capacity; }
+    // 仍被GPU占用或尚未提交的字节数
+    size_t GetInFlight() const { return static_cast<size_t>(write_pos - retired_pos); }
+};
+// 纹理加载共享的上传缓冲区, 首次调用时创建(需要GL上下文)
+inline UploadRing& DefaultUploadRing() {
+    static UploadRing ring;
+    return ring;
+}
+}  // namespace Boundless
+#endif  //!_BOUNDLESS_UPLOAD_RING_HPP_FILE_
@@ -2,10 +2,27 @@
 #define _BOUNDLESS_FULL_FILES_
 
 #include "boundless_base.hpp"
+#include "bl_atlas.hpp"
+#include "bl_bcn.hpp"
+#include "bl_bcn_compute.hpp"
+#include "bl_bvh.hpp"
 #include "bl_data_struct.hpp"
+#include "bl_image.hpp"
+#include "bl_impostor.hpp"
 #include "bl_initialization.hpp"
 #include "bl_log.hpp"
+#include "bl_memory.hpp"
+#include "bl_memory_tracker.hpp"
+#include "bl_mesh_codec.hpp"
 #include "bl_mesh_maker.hpp"
+#include "bl_mesh_stream.hpp"
+#include "bl_page.hpp"
+#include "bl_pointcloud.hpp"
+#include "bl_readback.hpp"
 #include "bl_render.hpp"
+#include "bl_residency.hpp"
 #include "bl_resource.hpp"
+#include "bl_texture_array.hpp"
+#include "bl_texture_stream.hpp"
+#include "bl_upload_ring.hpp"
 #endif //!_BOUNDLESS_FULL_FILES_
\ No newline at end of file
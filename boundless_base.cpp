@@ -4,7 +4,8 @@ namespace Boundless {
 Byte* CompressData(const Byte* data, size_t* length, size_t space) {
     // 计算压缩容量
     size_t dlen = zlib::compressBound(*length) + sizeof(uint64) * 2;
-    Byte* compress_data = (Byte*)malloc(space + dlen);
+    Byte* compress_data =
+        (Byte*)MemoryTracker::Allocate(space + dlen, MemoryTag::Compression);
     if (compress_data == nullptr) {
         throw std::bad_alloc();
     }
@@ -17,7 +18,7 @@ Byte* CompressData(const Byte* data, size_t* length, size_t space) {
         zlib::compress2(data_ptr, (zlib::uLong*)(data_ptr - sizeof(uint64)),
                         data, *length, compress_level);
     if (res != Z_OK) {
-        free(compress_data);
+        MemoryTracker::Free(compress_data);
         throw zlib::ZlibException(res);
     }
     *length = sizeof(uint64) * 2 + space +
@@ -26,7 +27,8 @@ Byte* CompressData(const Byte* data, size_t* length, size_t space) {
 }
 Byte* UncompressData(const Byte* data, size_t* ret_length) {
     Byte* uncompress_data =
-        (Byte*)malloc(*(uint64*)data);  // 按压缩前长度分配空间
+        (Byte*)MemoryTracker::Allocate(*(uint64*)data,  // 按压缩前长度分配空间
+                                       MemoryTag::Compression);
     if (uncompress_data == nullptr)
         {throw std::bad_alloc();}
     *ret_length = *(uint64*)data;
@@ -34,9 +36,58 @@ Byte* UncompressData(const Byte* data, size_t* ret_length) {
                                 data + sizeof(uint64) * 2,
                                 (zlib::uLong*)(data + sizeof(uint64)));
     if (res != Z_OK) {
-        free(uncompress_data);
+        MemoryTracker::Free(uncompress_data);
         throw zlib::ZlibException(res);
     }
     return uncompress_data;
 }
+InflateStream::InflateStream(const Byte* data)
+    : input(data + sizeof(uint64) * 2),
+      input_left(*(uint64*)(data + sizeof(uint64))),
+      total(*(uint64*)data),
+      consumed(0) {
+    stream.zalloc = nullptr;
+    stream.zfree = nullptr;
+    stream.opaque = nullptr;
+    stream.next_in = nullptr;
+    stream.avail_in = 0;
+    int res = zlib::inflateInit_(&stream, ZLIB_VERSION,
+                                 static_cast<int>(sizeof(zlib::z_stream)));
+    if (res != Z_OK) {
+        throw zlib::ZlibException(res);
+    }
+}
+InflateStream::~InflateStream() {
+    zlib::inflateEnd(&stream);
+}
+void InflateStream::Read(Byte* dst, size_t length) {
+    if (length > total - consumed) {
+        throw zlib::ZlibException(Z_BUF_ERROR);
+    }
+    const size_t max_chunk = 1ULL << 30;  // avail_in/avail_out为32位
+    while (length > 0) {
+        if (stream.avail_in == 0 && input_left > 0) {
+            size_t n = std::min(input_left, max_chunk);
+            stream.next_in = const_cast<Byte*>(input);
+            stream.avail_in = static_cast<zlib::uInt>(n);
+            input += n;
+            input_left -= n;
+        }
+        size_t n = std::min(length, max_chunk);
+        stream.next_out = dst;
+        stream.avail_out = static_cast<zlib::uInt>(n);
+        int res = zlib::inflate(&stream, Z_NO_FLUSH);
+        size_t written = n - stream.avail_out;
+        if (res != Z_OK && res != Z_STREAM_END) {
+            throw zlib::ZlibException(res);
+        }
+        if (written == 0 &&
+            (res == Z_STREAM_END || (input_left == 0 && stream.avail_in == 0))) {
+            throw zlib::ZlibException(Z_DATA_ERROR);  // 数据提前结束
+        }
+        dst += written;
+        length -= written;
+        consumed += written;
+    }
+}
 }  // namespace Boundless
@@ -6,6 +6,7 @@
 
 #include "bl_data_struct.hpp"
 #include "bl_log.hpp"
+#include "bl_memory_tracker.hpp"
 
 #include <algorithm>
 #include <cmath>
@@ -79,9 +80,27 @@ typedef std::uint64_t uint64;
 //
 const int32 compress_level = 7;
 /* 数据结构:|压缩前长度8Byte|压缩后长度8Byte|压缩数据| */
+// 两个函数返回的数据都使用MemoryTracker::Free释放
 // 压缩数据,data为压缩前数据指针,length为数据长度,结束后变为压缩后长度,space在开头预留space字节的空间
 Byte* CompressData(const Byte* data, size_t* length, size_t space = 0ULL);
 // 解压缩数据,data为压缩后数据指针,ret_length返回数据长度
 Byte* UncompressData(const Byte* data, size_t* ret_length);
+// 分段解压CompressData()的结果, 每次Read()把接下来的length字节直接写入dst
+// 用于解压到映射的缓冲区等调用者给出的位置, 避免中间拷贝
+class InflateStream {
+    zlib::z_stream stream;
+    const Byte* input;
+    size_t input_left;
+    size_t total, consumed;
+
+   public:
+    InflateStream(const Byte* data);
+    InflateStream(const InflateStream&) = delete;
+    InflateStream& operator=(const InflateStream&) = delete;
+    ~InflateStream();
+    size_t GetLength() const { return total; }  // 压缩前总长度
+    size_t GetRemaining() const { return total - consumed; }
+    void Read(Byte* dst, size_t length);
+};
 }  // namespace Boundless
 #endif  //!_BOUNDLESS_HPP_FILE_
\ No newline at end of file
@@ -46,11 +46,11 @@ int main()
 	ADSBase::Init();
 	ADSBase::UpdateUniformBuffer();
 	Renderer rend;
-	Transform* node = rend.AddObject<ADSRender>(Vector3d(0.0,1.0,1.0),Vector3d(1.0,1.0,1.0),Quaterniond::Identity(), &adsd);
-	ADSRender* ro = dynamic_cast<ADSRender*>(node->render_obj);
+	ADSRender* ro;
+	TransformHandle node = rend.AddObject<ADSRender>(Vector3d(0.0,1.0,1.0),Vector3d(1.0,1.0,1.0),Quaterniond::Identity(), &ro, &adsd);
 	Mesh& mesh = ro->mesh;
 	Mesh::MakeSphere(mesh,1.0f,32,32,VertexData::POSITION);
-	ro->base_transform->roenble = true;
+	rend.GetTransform(node)->roenble = true;
 	
 	while (!glfwWindowShouldClose(Init::windowinfo.window_ptr))
 	{
@@ -0,0 +1,136 @@
+#version 450 core
+// 每个线程编码一个4x4块, 写入暂存纹理中对应的一个整数纹元
+// BC1: rg32ui (64位) BC3/BC5: rgba32ui (128位), 均按小端序排列
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(location = 0) uniform int Mode;         // 0:BC1 1:BC3 2:BC5
+layout(location = 1) uniform int Level;        // 源纹理的mipmap层级
+layout(location = 2) uniform bool EncodeSRGB;  // 编码前转换到sRGB空间
+
+layout(binding = 0) uniform sampler2D Source;
+layout(binding = 0, rg32ui) uniform writeonly uimage2D Blocks64;
+layout(binding = 1, rgba32ui) uniform writeonly uimage2D Blocks128;
+
+vec3 LinearToSRGB(vec3 c) {
+    return mix(c * 12.92, 1.055 * pow(c, vec3(1.0 / 2.4)) - 0.055,
+               greaterThan(c, vec3(0.0031308)));
+}
+uint PackRGB565(vec3 c) {
+    uvec3 q = uvec3(round(clamp(c, 0.0, 1.0) * vec3(31.0, 63.0, 31.0)));
+    return (q.r << 11) | (q.g << 5) | q.b;
+}
+vec3 UnpackRGB565(uint c) {
+    return vec3((c >> 11) & 31u, (c >> 5) & 63u, c & 31u) /
+           vec3(31.0, 63.0, 31.0);
+}
+
+// 颜色块: 包围盒对角线为端点(按协方差符号选择对角线), 向内收缩1/16
+uvec2 EncodeColorBlock(vec3 block[16]) {
+    vec3 lo = block[0], hi = block[0], center = vec3(0.0);
+    for (int i = 0; i < 16; i++) {
+        lo = min(lo, block[i]);
+        hi = max(hi, block[i]);
+        center += block[i];
+    }
+    center /= 16.0;
+    vec3 extent = hi - lo;
+    int axis = extent.r >= extent.g ? (extent.r >= extent.b ? 0 : 2)
+                                    : (extent.g >= extent.b ? 1 : 2);
+    vec3 cov = vec3(0.0);
+    for (int i = 0; i < 16; i++) {
+        vec3 d = block[i] - center;
+        cov += d * d[axis];
+    }
+    vec3 inset = extent / 16.0;
+    vec3 e0 = hi - inset, e1 = lo + inset;
+    for (int c = 0; c < 3; c++) {
+        if (cov[c] < 0.0) {
+            float t = e0[c];
+            e0[c] = e1[c];
+            e1[c] = t;
+        }
+    }
+    uint c0 = PackRGB565(e0), c1 = PackRGB565(e1);
+    if (c0 == c1)
+        return uvec2(c0 | (c1 << 16), 0u);
+    if (c0 < c1) {  // c0 > c1 时为4色模式
+        uint t = c0;
+        c0 = c1;
+        c1 = t;
+    }
+    e0 = UnpackRGB565(c0);
+    e1 = UnpackRGB565(c1);
+    vec3 dir = e1 - e0;
+    float scale = 3.0 / dot(dir, dir);
+    // 沿端点方向的位置(0,1/3,2/3,1)到索引的映射
+    const uint remap[4] = uint[4](0u, 2u, 3u, 1u);
+    uint indices = 0u;
+    for (int i = 0; i < 16; i++) {
+        float t = clamp(dot(block[i] - e0, dir) * scale, 0.0, 3.0);
+        indices |= remap[uint(round(t))] << (2 * i);
+    }
+    return uvec2(c0 | (c1 << 16), indices);
+}
+
+// 单通道块(BC3的alpha, BC4/BC5): 8值插值模式, 端点取最小/最大值
+uvec2 EncodeChannelBlock(float block[16]) {
+    float lo = block[0], hi = block[0];
+    for (int i = 1; i < 16; i++) {
+        lo = min(lo, block[i]);
+        hi = max(hi, block[i]);
+    }
+    uint a0 = uint(round(clamp(hi, 0.0, 1.0) * 255.0));
+    uint a1 = uint(round(clamp(lo, 0.0, 1.0) * 255.0));
+    uvec2 res = uvec2(a0 | (a1 << 8), 0u);
+    if (a0 == a1)
+        return res;
+    float scale = 7.0 / (float(a0) - float(a1));
+    // 16个3位索引从第16位开始, 跨越两个32位字
+    for (int i = 0; i < 16; i++) {
+        float t = (float(a0) - block[i] * 255.0) * scale;
+        uint s = uint(round(clamp(t, 0.0, 7.0)));
+        uint code = s == 0u ? 0u : (s == 7u ? 1u : s + 1u);
+        int bit = 16 + 3 * i;
+        if (bit < 32) {
+            res.x |= code << bit;
+            if (bit > 29)
+                res.y |= code >> (32 - bit);
+        } else {
+            res.y |= code << (bit - 32);
+        }
+    }
+    return res;
+}
+
+void main() {
+    ivec2 block_pos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = textureSize(Source, Level);
+    if (any(greaterThanEqual(block_pos * 4, size)))
+        return;
+    // 边缘不足4像素时重复边缘像素
+    vec4 texels[16];
+    for (int i = 0; i < 16; i++) {
+        ivec2 p = clamp(block_pos * 4 + ivec2(i & 3, i >> 2), ivec2(0),
+                        size - 1);
+        texels[i] = texelFetch(Source, p, Level);
+        if (EncodeSRGB)
+            texels[i].rgb = LinearToSRGB(texels[i].rgb);
+    }
+    vec3 color[16];
+    float channel0[16], channel1[16];
+    for (int i = 0; i < 16; i++) {
+        color[i] = texels[i].rgb;
+        channel0[i] = Mode == 1 ? texels[i].a : texels[i].r;
+        channel1[i] = texels[i].g;
+    }
+    if (Mode == 0) {
+        imageStore(Blocks64, block_pos, uvec4(EncodeColorBlock(color), 0u, 0u));
+    } else if (Mode == 1) {
+        imageStore(Blocks128, block_pos,
+                   uvec4(EncodeChannelBlock(channel0), EncodeColorBlock(color)));
+    } else {
+        imageStore(Blocks128, block_pos,
+                   uvec4(EncodeChannelBlock(channel0),
+                         EncodeChannelBlock(channel1)));
+    }
+}
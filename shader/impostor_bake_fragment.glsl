@@ -0,0 +1,13 @@
+#version 450 core
+layout(location = 2) uniform vec4 Color;
+
+in vec3 Normal;
+
+layout(location = 0) out vec4 Albedo;
+layout(location = 1) out vec4 NormalDepth;
+
+void main() {
+    Albedo = vec4(Color.rgb, 1.0);
+    // 法向量映射到[0,1], 深度为正交投影下的线性深度
+    NormalDepth = vec4(normalize(Normal) * 0.5 + 0.5, gl_FragCoord.z);
+}
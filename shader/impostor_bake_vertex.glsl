@@ -0,0 +1,13 @@
+#version 450 core
+layout(location = 0) uniform mat4 MVPMatrix;
+layout(location = 1) uniform mat4 NormalMatrix;
+
+layout(location = 4) in vec3 VertexPosition;
+layout(location = 5) in vec3 VertexNormal;
+
+out vec3 Normal;
+
+void main() {
+    Normal = normalize(mat3(NormalMatrix) * VertexNormal);
+    gl_Position = MVPMatrix * vec4(VertexPosition, 1.0);
+}
@@ -0,0 +1,17 @@
+#version 450 core
+layout(location = 4) uniform vec3 LightDirection;
+layout(binding = 0) uniform sampler2D Albedo;
+layout(binding = 1) uniform sampler2D NormalDepth;
+
+in vec2 TexCoord;
+
+out vec4 FragColor;
+
+void main() {
+    vec4 albedo = texture(Albedo, TexCoord);
+    if (albedo.a < 0.5)
+        discard;
+    vec3 normal = normalize(texture(NormalDepth, TexCoord).xyz * 2.0 - 1.0);
+    float light = 0.3 + 0.7 * max(dot(normal, -LightDirection), 0.0);
+    FragColor = vec4(albedo.rgb * light, 1.0);
+}
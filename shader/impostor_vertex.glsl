@@ -0,0 +1,40 @@
+#version 450 core
+layout(location = 0) uniform mat4 VPMatrix;
+layout(location = 1) uniform vec3 CameraPosition;
+layout(location = 2) uniform int Frames;
+layout(location = 3) uniform float Radius;
+
+layout(location = 0) in vec4 Instance;  // xyz: 世界空间中心, w: 缩放
+
+out vec2 TexCoord;
+
+vec3 OctahedronDecode(vec2 uv) {
+    vec3 n = vec3(uv.x, 1.0 - abs(uv.x) - abs(uv.y), uv.y);
+    if (n.y < 0.0) {
+        n.xz = (1.0 - abs(n.zx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0,
+                                        n.z >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+void main() {
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    vec3 dir = normalize(CameraPosition - Instance.xyz);
+    // 选择与视线方向最接近的烘焙视角
+    vec3 d = dir / (abs(dir.x) + abs(dir.y) + abs(dir.z));
+    vec2 oct = d.xz;
+    if (d.y < 0.0) {
+        oct = (1.0 - abs(d.zx)) * vec2(d.x >= 0.0 ? 1.0 : -1.0,
+                                       d.z >= 0.0 ? 1.0 : -1.0);
+    }
+    vec2 cell = clamp(floor((oct * 0.5 + 0.5) * Frames), vec2(0.0),
+                      vec2(Frames - 1));
+    // 使用与烘焙时相同的相机基向量展开四边形
+    vec3 fdir = OctahedronDecode((cell + 0.5) / Frames * 2.0 - 1.0);
+    vec3 up = abs(fdir.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    vec3 s = normalize(cross(-fdir, up));
+    vec3 u = cross(s, -fdir);
+    vec3 world = Instance.xyz + (s * corner.x + u * corner.y) * Radius * Instance.w;
+    TexCoord = (cell + corner * 0.5 + 0.5) / Frames;
+    gl_Position = VPMatrix * vec4(world, 1.0);
+}
@@ -0,0 +1,8 @@
+#version 450 core
+in vec4 Color;
+
+out vec4 FragColor;
+
+void main() {
+    FragColor = Color;
+}
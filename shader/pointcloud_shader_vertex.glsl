@@ -0,0 +1,14 @@
+#version 450 core
+layout(location = 0) uniform mat4 MVPMatrix;
+layout(location = 1) uniform float PointSize;
+
+layout(location = 0) in vec3 VertexPosition;
+layout(location = 1) in vec4 VertexColor;
+
+out vec4 Color;
+
+void main() {
+    Color = VertexColor;
+    gl_PointSize = PointSize;
+    gl_Position = MVPMatrix * vec4(VertexPosition, 1.0);
+}